@@ -13,6 +13,6 @@ import RxCocoa
 /// For handling Customers list related business.
 class CustomersViewModel: CommonDataTableViewModel<Customer> {
     override func loadData() -> Single<QueryResult<Customer>> {
-        return self.dataService.loadCustomers(page: page.value, pageSize: pageSize.value)
+        return self.dataService.loadCustomers(page: page.value, pageSize: pageSize.value, after: after)
     }
 }
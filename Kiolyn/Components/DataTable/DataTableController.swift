@@ -158,6 +158,11 @@ class DataTableController<R: QueryResult<T>, T: Mappable & Equatable>: UIViewCon
             .map { $0.summary.rowCount }
             .drive(table.pagination.total)
             .disposed(by: disposeBag)
+        viewModel.data
+            .asDriver()
+            .map { $0.next }
+            .drive(table.pagination.next)
+            .disposed(by: disposeBag)
         // Page and PageSize changed
         table.pagination.selectedPage
             .asObservable()
@@ -25,15 +25,24 @@ class DataTableViewModel<R: QueryResult<T>, T: Mappable>: BaseViewModel {
     let selectedRow = BehaviorRelay<T?>(value: nil)
     /// The status of loading
     let viewStatus = BehaviorRelay<ViewStatus>(value: .none)
+    /// Continuation keys given with the loaded pages, by the number of the page they lead to.
+    fileprivate var pageKeys: [UInt: String] = [:]
+    
+    /// Continuation key to load the current page from, `nil` to load it by page number.
+    var after: String? {
+        return page.value > 1 ? pageKeys[page.value] : nil
+    }
+    
     /// Create with service provider
     ///
     /// - Parameter provider: Service provider.
     override init() {
         super.init()
 
-        // Reset page to 1 on page size changed
+        // Reset page to 1 on page size changed, the keys are for the previous size
         pageSize
             .asObservable()
+            .do(onNext: { _ in self.pageKeys = [:] })
             .map { _ -> UInt in 1 }
             .bind(to: page)
             .disposed(by: disposeBag)
@@ -42,12 +51,13 @@ class DataTableViewModel<R: QueryResult<T>, T: Mappable>: BaseViewModel {
             .filter { self.viewStatus.value.isNotLoading }
             .filter {
                 // Reset the page before reloading
+                self.pageKeys = [:]
                 if self.page.value > 1 {
                     self.page.accept(1)
                 }
                 return true
             }
-            .flatMap { _ in self.loadData() } // TODO: fix loading 2 times
+            .flatMap { _ in self.loadPage() } // TODO: fix loading 2 times
             .bind(to: data)
             .disposed(by: disposeBag)
         
@@ -61,12 +71,24 @@ class DataTableViewModel<R: QueryResult<T>, T: Mappable>: BaseViewModel {
             pageSize.asObservable().distinctUntilChanged().mapToVoid(),
             page.asObservable().distinctUntilChanged().mapToVoid())
             .filter { self.viewStatus.value.isNotLoading }
-            .flatMap { _ in self.loadData() }
+            .flatMap { _ in self.loadPage() }
             .bind(to: data)
             .disposed(by: disposeBag)
     }
+    
+    /// Load the current page and keep the key of the following one.
+    ///
+    /// - Returns: `QueryResult<T>`.
+    fileprivate func loadPage() -> Single<R> {
+        let page = self.page.value
+        return loadData()
+            .observeOn(MainScheduler.instance)
+            .do(onSuccess: { result in
+                self.pageKeys[page + 1] = result.next
+            })
+    }
 
-    /// Main function for loading data.
+    /// Main function for loading data, loading the current page from `after` when there is one.
     ///
     /// - Returns: `QueryResult<T>`.
     func loadData() -> Single<R> {
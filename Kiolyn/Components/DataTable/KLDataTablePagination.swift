@@ -22,6 +22,8 @@ class KLDataTablePagination : KLView {
     var selectedPageSize = BehaviorRelay<UInt>(value: 10)
     var selectedPage = BehaviorRelay<UInt>(value: 1)
     var total = BehaviorRelay<Int>(value: 0)
+    /// Continuation key given with the selected page, `nil` on the last page.
+    var next = BehaviorRelay<String?>(value: nil)
     
     fileprivate let totalLabel = UILabel()
     
@@ -140,9 +142,8 @@ class KLDataTablePagination : KLView {
             })
             .disposed(by: disposeBag)
         
-        total
-            .asObservable()
-            .map { total -> [KLDataTablePaginationPage] in
+        Observable.combineLatest(total.asObservable(), next.asObservable())
+            .map { total, next -> [KLDataTablePaginationPage] in
                 var pages = [KLDataTablePaginationPage]()
                 let pageSize = Double(self.selectedPageSize.value)
                 let currentPage: Int = Int(self.selectedPage.value)
@@ -168,7 +169,9 @@ class KLDataTablePagination : KLView {
                     }
                     i += 1
                 }
-                pages.append(KLDataTablePaginationPage("next", min(numPages, currentPage + 1), currentPage < numPages))
+                // Rows added since the count are reached through the key
+                let hasNext = currentPage < numPages || next != nil
+                pages.append(KLDataTablePaginationPage("next", currentPage + (hasNext ? 1 : 0), hasNext))
                 pages.append(KLDataTablePaginationPage("last", numPages, currentPage != numPages, currentPage == numPages))
                 return pages
             }
@@ -72,6 +72,8 @@ class LoginViewModel: ViewModel {
     }
     /// Last updated
     var lastUpdated: Driver<String>!
+    /// Progress of the database views warm-up, 1 when all views are indexed.
+    let warmUpProgress = BehaviorRelay<Double>(value: 1)
     
     /// Create with service provider
     ///
@@ -85,10 +87,19 @@ class LoginViewModel: ViewModel {
             .subscribe()
             .disposed(by: disposeBag)
         
-        lastUpdated = UserDefaults.standard.rx
-            .observe(Date.self, UserDefaults.lastUpdated._key)
-            .map { "Last Updated: \($0?.toString("MMM d HH:mm") ?? "")" }
-            .asDriver(onErrorJustReturn: "")
+        lastUpdated = Driver
+            .combineLatest(
+                UserDefaults.standard.rx
+                    .observe(Date.self, UserDefaults.lastUpdated._key)
+                    .asDriver(onErrorJustReturn: nil),
+                warmUpProgress.asDriver().distinctUntilChanged())
+            { (lastUpdated, progress) -> String in
+                let text = "Last Updated: \(lastUpdated?.toString("MMM d HH:mm") ?? "")"
+                return progress < 1 ? "\(text) - Indexing \(Int(progress * 100))%" : text
+        }
+        
+        // Build the views indexes in background, signing in does not wait for them
+        warmUpViews()
         
         
         // MARK: - Remote Sync
@@ -118,6 +129,12 @@ class LoginViewModel: ViewModel {
                             Defaults[UserDefaults.lastUpdated] = Date()
                             // Update state after a successful syncing
                             _ = self.update(state: self.storeID.value).subscribe()
+                            // Index the synced documents
+                            self.warmUpViews()
+                            // ... and keep the synced menu in memory
+                            let db = SP.database
+                            let storeID = self.storeID.value
+                            db.async { _ = db.load(menu: storeID) }
                         }
                 }
             })
@@ -225,6 +242,17 @@ class LoginViewModel: ViewModel {
         }
     }
     
+    /// Warm up the database views, reporting the progress to `warmUpProgress`.
+    private func warmUpViews() {
+        _ = SP.database.warmUpViews()
+            .subscribe(
+                onNext: { progress in self.warmUpProgress.accept(progress) },
+                onError: { error in
+                    w("[LOGIN] Could not warm up views: \(error)")
+                    self.warmUpProgress.accept(1)
+            })
+    }
+    
     /// Update when in sub mode.
     ///
     /// - Parameter storeID: the returned Main storeID
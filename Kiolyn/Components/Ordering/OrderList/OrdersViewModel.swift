@@ -65,6 +65,6 @@ class OrdersViewModel: CommonDataTableViewModel<Order> {
     }
     
     override func loadData() -> Single<QueryResult<Order>> {
-        return dataService.load(orders: selectedStatuses.value, page: page.value, pageSize: pageSize.value)
+        return dataService.load(orders: selectedStatuses.value, page: page.value, pageSize: pageSize.value, after: after)
     }
 }
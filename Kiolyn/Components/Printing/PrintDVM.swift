@@ -40,8 +40,13 @@ class PrintDVM<PJ: PrintingJob, DR>: DialogViewModel<DR> {
             .subscribe(onNext: { self.print(job: $0) })
             .disposed(by: disposeBag)
 
-        // Assume everything got printed
+        // Assume everything got printed, stop sending what is still in progress
         skip
+            .do(onNext: { _ in
+                self.jobs.value
+                    .filter { $0.status.value.isLoading && !$0.isSpooled }
+                    .forEach { SP.printingService.cancelPrinting(on: $0.printer) }
+            })
             .map { self.skipPrintingResult }
             .bind(to: closeDialog)
             .disposed(by: disposeBag)
@@ -60,15 +65,24 @@ class PrintDVM<PJ: PrintingJob, DR>: DialogViewModel<DR> {
     /// - Parameter job: The job to print.
     func print(job: PJ) {
         let status = job.status
-        // Make sure it won't print twice
-        guard status.value.isNotLoading, !isClosed else {
+        // Make sure it won't print twice, nor again while spooled
+        guard status.value.isNotLoading, !job.isSpooled, !isClosed else {
             return
         }
         // Mark as loading
         status.accept(.loading)
         jobsChanged.onNext(())
+        // Report how much of the job has reached the printer
+        let progress = SP.printingService.printingProgress
+            .filter { $0.printerID == job.printer.id && $0.progress < 1 }
+            .subscribe(onNext: { update in
+                guard !self.isClosed, status.value.isLoading else { return }
+                status.accept(.progress(p: update.progress))
+                self.jobsChanged.onNext(())
+            })
         DispatchQueue.global(qos: .background).async {
             _ = self.doPrint(job)
+                .do(onDispose: { progress.dispose() })
                 .subscribe(onSuccess: { _ in
                     // Make sure it won't processed anything after printing
                     guard !self.isClosed else { return }
@@ -77,7 +91,11 @@ class PrintDVM<PJ: PrintingJob, DR>: DialogViewModel<DR> {
                 }, onError: { error in
                     // Make sure it won't processed anything after printing
                     guard !self.isClosed else { return }
-                    if let error = error as? PrintError {
+                    if case PrintError.spooled? = error as? PrintError {
+                        // Printed by the spool, retrying would print it twice
+                        job.isSpooled = true
+                        status.accept(.message(m: error.localizedDescription))
+                    } else if let error = error as? PrintError {
                         e("PRINTING ERROR: \(error.localizedDescription) (Printer: \(job.printer)")
                         status.accept(.error(reason: error.localizedDescription))
                     }
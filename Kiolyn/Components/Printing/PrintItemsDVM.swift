@@ -78,7 +78,7 @@ class PrintItemsDVM: PrintDVM<ItemsPrintingJob, PrintItemsDR> {
         guard let order = order else { return nil }
 
         let printedItems = jobs.value.flatMap({ job -> [OrderItem] in
-            guard job.status.value.isOK, let items = job.items else {
+            guard job.status.value.isOK || job.isSpooled, let items = job.items else {
                 return []
             }
             return items.flatMap { $0 }
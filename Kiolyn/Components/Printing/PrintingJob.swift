@@ -16,6 +16,8 @@ class PrintingJob: NSObject {
     let printer: Printer
     /// The status of this printing job.
     let status = BehaviorRelay<ViewStatus>(value: .none)
+    /// `true` if the job is kept in spool for the printer to be back, it must not be sent again.
+    var isSpooled = false
     
     init(_ printer: Printer) {
         self.printer = printer
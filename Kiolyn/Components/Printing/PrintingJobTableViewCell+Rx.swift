@@ -27,6 +27,8 @@ fileprivate extension ViewStatus {
     var message: String {
         switch self {
         case .loading: return "Printing ..."
+        case let .progress(p): return "Printing ... \(Int(p * 100))%"
+        case let .message(m): return m
         case .error(_): return "Printing has failed - Click to retry."
         case .ok: return "Printed successfully - Click to print again."
         default:
@@ -135,7 +135,9 @@ class CloseBatchDVM: DialogViewModel<()> {
                 }
             }
             // Save settling trans + settled trans(es) + Orders/Bills
-            try db.save(all: savingObjects)
+            let batch = WriteBatch()
+            batch.save(all: savingObjects)
+            _ = try self.dataService.commit(batch)
             // Print it
             if let printer = self.defaultPrinter {
                 DispatchQueue.global(qos: .background).async {
@@ -133,18 +133,7 @@ class TransactionsViewModel: CommonDataTableViewModel<Transaction> {
     }
     
     override func loadData() -> Single<QueryResult<Transaction>> {
-        // Make sure shift is good
-        guard let shift = self.dataService.activeShift.value?.id else {
-            return Single.just(QueryResult<Transaction>())
-        }
-        let storeID = store.id
-        let paymentType = selectedPaymentType.value
-        let page = self.page.value
-        let pageSize = self.pageSize.value
-        let db = SP.database
-        return db.async {
-            db.load(unsettledTransactions: storeID, shift: shift, for: paymentType, page: page, pageSize: pageSize)
-        }
+        return dataService.load(unsettledTransactions: selectedPaymentType.value, page: page.value, pageSize: pageSize.value, after: after)
     }
     
     /// Adjust tip for a transaction.
@@ -66,6 +66,10 @@ enum Configuration: String {
     static var testPrinting: Bool { return false }
     #endif
 
+    /// `true` to print templates as native printer text on printers with built-in fonts (detected from
+    /// their model), bitmaps are then used for logos only.
+    static var textModePrinting: Bool { return true }
+
     static var standalone: Bool { return false }
     static var initialMain: (URL, String)? {
 //        #if DEBUG
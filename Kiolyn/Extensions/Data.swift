@@ -0,0 +1,44 @@
+//
+//  Data.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 9/7/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+import Compression
+
+extension Data {
+    
+    /// Compress with raw deflate (zlib).
+    ///
+    /// - Returns: The compressed data, `nil` if it does not get smaller.
+    func deflated() -> Data? {
+        let capacity = count
+        guard capacity > 0 else { return nil }
+        var output = Data(count: capacity)
+        let size = output.withUnsafeMutableBytes { (destination: UnsafeMutablePointer<UInt8>) in
+            withUnsafeBytes { (source: UnsafePointer<UInt8>) in
+                compression_encode_buffer(destination, capacity, source, count, nil, COMPRESSION_ZLIB)
+            }
+        }
+        guard size > 0 else { return nil }
+        output.count = size
+        return output
+    }
+    
+    /// Decompress raw deflate (zlib) data.
+    ///
+    /// - Parameter count: The decompressed size.
+    /// - Returns: The decompressed data, `nil` if it is not of the given size.
+    func inflated(count: Int) -> Data? {
+        var output = Data(count: count)
+        let size = output.withUnsafeMutableBytes { (destination: UnsafeMutablePointer<UInt8>) in
+            withUnsafeBytes { (source: UnsafePointer<UInt8>) in
+                compression_decode_buffer(destination, count, source, self.count, nil, COMPRESSION_ZLIB)
+            }
+        }
+        return size == count ? output : nil
+    }
+}
@@ -30,6 +30,9 @@ class BaseModel: NSObject, Mappable {
     class var documentIDPrefix: String { return "" }
     /// Classes that support `loadAll` method, must override this to provide the mapping for all query.
     class var allMapBlock: CBLMapBlock? { return nil }
+    /// `true` for models decoded/copied field by field with `decode(_:)`/`copy(from:)` instead of
+    /// ObjectMapper, the class and all its super classes must override both.
+    class var isTyped: Bool { return false }
 
     /// Document id, normally of the form `type`_`id`.
     var documentID = ""
@@ -65,7 +68,7 @@ class BaseModel: NSObject, Mappable {
         return "\(documentID)/\(id)/\(name)"
     }
     
-    init(id: String) {
+    required init(id: String) {
         self.id = id
         self.type = BaseModel.documentType
     }
@@ -90,6 +93,38 @@ class BaseModel: NSObject, Mappable {
         updatedAt <- map["updated_at"]
         updatedBy <- map["updated_by"]
     }
+    
+    /// Read the fields from stored properties, must mirror `mapping(map:)`.
+    ///
+    /// - Parameter p: The stored properties.
+    func decode(_ p: [String: Any]) {
+        p.read("_id", &documentID)
+        p.read("_rev", &revision)
+        p.read("type", &type)
+        p.read("channels", &channels)
+        p.read("id", &id)
+        p.read("name", &name)
+        p.read("storeid", &storeID)
+        p.read("merchantid", &merchantID)
+        p.read("updated_at", &updatedAt)
+        p.read("updated_by", &updatedBy)
+    }
+    
+    /// Deep copy the fields of another model of the same class.
+    ///
+    /// - Parameter model: The model to copy from.
+    func copy(from model: BaseModel) {
+        documentID = model.documentID
+        revision = model.revision
+        type = model.type
+        channels = model.channels
+        id = model.id
+        name = model.name
+        storeID = model.storeID
+        merchantID = model.merchantID
+        updatedAt = model.updatedAt
+        updatedBy = model.updatedBy
+    }
 }
 
 extension BaseModel {
@@ -99,6 +134,9 @@ extension BaseModel {
     /// - Parameter keys: the list of keys to be removed
     /// - Returns: the new object without given keys
     func clone<T: BaseModel>(without keys: [String] = []) -> T {
+        if keys.isEmpty, let model = duplicate() as? T {
+            return model
+        }
         var properties = toJSON()
         for key in keys {
             properties.removeValue(forKey: key)
@@ -127,4 +165,19 @@ class GridItemModel: BaseModel {
         row <- map["row"]
         color <- map["color"]
     }
+    
+    override func decode(_ p: [String: Any]) {
+        super.decode(p)
+        p.read("col", &col)
+        p.read("row", &row)
+        p.read("color", &color)
+    }
+    
+    override func copy(from model: BaseModel) {
+        super.copy(from: model)
+        guard let model = model as? GridItemModel else { return }
+        col = model.col
+        row = model.row
+        color = model.color
+    }
 }
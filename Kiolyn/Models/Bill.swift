@@ -11,6 +11,8 @@ import ObjectMapper
 
 /// Each Order might contain one or more Bill, each Bill has its own Transaction object if it is paid. Bill can be in statuses of NEW, PAIDED, VOIDED.
 class Bill: BaseModel, OrderItemsContainer {
+    /// Decoded/copied field by field.
+    override class var isTyped: Bool { return true }
     /// True if this is bill is currently voided.
     var voided = false
     /// A `Bill` may be paid/voided more than one time, this object is meant to hold ALL the transactions that were voided after used for paying this `Bill`.
@@ -97,6 +99,68 @@ class Bill: BaseModel, OrderItemsContainer {
         total <- map["total"]
         tip <- map["tip"]
     }
+    
+    override func decode(_ p: [String: Any]) {
+        super.decode(p)
+        p.read("voided", &voided)
+        p.read("voided_transactions", &voidedTransactions)
+        p.read("settled", &settled)
+        p.read("parent_bill", &parentBill)
+        p.read("parent_total", &parentTotal)
+        p.read("printed", &printed)
+        p.read("paid", &paid)
+        p.read("paid_by", &paidBy)
+        p.read("paid_at", &paidAt)
+        p.read("payment_type", &paymentType)
+        p.read("transaction", &transaction)
+        p.read("items", &items)
+        p.read("service_fee_amount", &total)
+        p.read("tax", &tax)
+        p.read("discount", &discount)
+        p.read("service_fee", &serviceFee)
+        p.read("service_fee_tax", &serviceFeeTax)
+        p.read("quantity", &quantity)
+        p.read("subtotal", &subtotal)
+        p.read("tax_amount", &taxAmount)
+        p.read("service_fee_amount", &discountAmount)
+        p.read("service_fee_amount", &serviceFeeAmount)
+        p.read("service_fee_tax_amount", &serviceFeeTaxAmount)
+        p.read("custom_service_fee_amount", &customServiceFeeAmount)
+        p.read("custom_service_fee_percent", &customServiceFeePercent)
+        p.read("total", &total)
+        p.read("tip", &tip)
+    }
+    
+    override func copy(from model: BaseModel) {
+        super.copy(from: model)
+        guard let model = model as? Bill else { return }
+        voided = model.voided
+        voidedTransactions = model.voidedTransactions
+        settled = model.settled
+        parentBill = model.parentBill
+        parentTotal = model.parentTotal
+        printed = model.printed
+        paid = model.paid
+        paidBy = model.paidBy
+        paidAt = model.paidAt
+        paymentType = model.paymentType
+        transaction = model.transaction
+        items = model.items.map { $0.duplicate() }
+        total = model.total
+        tax = model.tax.duplicate()
+        discount = model.discount.duplicate()
+        serviceFee = model.serviceFee
+        serviceFeeTax = model.serviceFeeTax
+        quantity = model.quantity
+        subtotal = model.subtotal
+        taxAmount = model.taxAmount
+        discountAmount = model.discountAmount
+        serviceFeeAmount = model.serviceFeeAmount
+        serviceFeeTaxAmount = model.serviceFeeTaxAmount
+        customServiceFeeAmount = model.customServiceFeeAmount
+        customServiceFeePercent = model.customServiceFeePercent
+        tip = model.tip
+    }
 }
 
 // MARK: - Creation related
@@ -106,8 +170,8 @@ extension Bill {
     /// - Parameter order: The `Order` to create bill for.
     convenience init(order: Order) {
         self.init()
-        tax = Tax(JSON: order.tax.toJSON())!
-        discount = Discount(JSON: order.discount.toJSON())!
+        tax = order.tax.duplicate()
+        discount = order.discount.duplicate()
         serviceFee = order.serviceFee
         serviceFeeTax = order.serviceFeeTax
         customServiceFeeAmount = order.customServiceFeeAmount
@@ -176,7 +240,7 @@ extension Bill {
     ///   - amount: The amount to split.
     ///   - id: The new bill id.
     func split(amount: Double, with newid: String = BaseModel.newID) -> Bill {
-        let newBill = Bill(JSON: toJSON())!
+        let newBill = duplicate()
         newBill.id = newid
         newBill.parentBill = isSplitted ? parentBill : id
         newBill.parentTotal = isSplitted ? parentTotal : total
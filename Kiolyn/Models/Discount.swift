@@ -11,6 +11,8 @@ import ObjectMapper
 
 /// Discount detail information.
 class Discount: BaseModel {
+    /// Decoded/copied field by field.
+    override class var isTyped: Bool { return true }
     /// Discount value in percentage
     var percent: Double = 0
     /// Percent might be adjusted during ordering, so this value must be used for calculation and not the `percent`.
@@ -30,6 +32,21 @@ class Discount: BaseModel {
         adjustedReason <- map["adjusted_reason"]
     }
     
+    override func decode(_ p: [String: Any]) {
+        super.decode(p)
+        p.read("percent", &percent)
+        p.read("adjusted_percent", &adjustedPercent)
+        p.read("adjusted_reason", &adjustedReason)
+    }
+    
+    override func copy(from model: BaseModel) {
+        super.copy(from: model)
+        guard let model = model as? Discount else { return }
+        percent = model.percent
+        adjustedPercent = model.adjustedPercent
+        adjustedReason = model.adjustedReason
+    }
+    
     static let noDiscountID = "no"
     
     /// No Discount discount object.
@@ -11,6 +11,8 @@ import ObjectMapper
 
 /// Contain information about `Item`'s image.
 class Image: BaseModel {
+    /// Decoded/copied field by field.
+    override class var isTyped: Bool { return true }
     /// Return MIME type of this image.
     var mime = ""
     /// Return MIME type of this image.
@@ -24,4 +26,19 @@ class Image: BaseModel {
         size <- map["size"]
         file <- map["file"]
     }
+    
+    override func decode(_ p: [String: Any]) {
+        super.decode(p)
+        p.read("mime", &mime)
+        p.read("size", &size)
+        p.read("file", &file)
+    }
+    
+    override func copy(from model: BaseModel) {
+        super.copy(from: model)
+        guard let model = model as? Image else { return }
+        mime = model.mime
+        size = model.size
+        file = model.file
+    }
 }
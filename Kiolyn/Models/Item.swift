@@ -15,6 +15,8 @@ class Item: GridItemModel {
     override class var documentType: String { return "item" }
     /// The prefix to be used for calculating the document id.
     override class var documentIDPrefix: String { return "it" }
+    /// Decoded/copied field by field.
+    override class var isTyped: Bool { return true }
     
     /// The category that this item belongs to.
     var category = ""
@@ -52,9 +54,36 @@ class Item: GridItemModel {
         isOpenItem <- map["isopenitem"]
         image <- map["image"]
     }
+    
+    override func decode(_ p: [String: Any]) {
+        super.decode(p)
+        p.read("name2", &name2)
+        p.read("category", &category)
+        p.read("name2_lang", &name2Language)
+        p.read("price", &price)
+        p.read("printers", &printers)
+        p.read("modifiers", &modifiers)
+        p.read("isopenitem", &isOpenItem)
+        p.read("image", &image)
+    }
+    
+    override func copy(from model: BaseModel) {
+        super.copy(from: model)
+        guard let model = model as? Item else { return }
+        name2 = model.name2
+        category = model.category
+        name2Language = model.name2Language
+        price = model.price
+        printers = model.printers.map { $0.duplicate() }
+        modifiers = model.modifiers.map { $0.duplicate() }
+        isOpenItem = model.isOpenItem
+        image = model.image?.duplicate()
+    }
 }
 
 class ModifierRef: BaseModel {
+    /// Decoded/copied field by field.
+    override class var isTyped: Bool { return true }
     /// The modifier is required or not
     var required = false
     /// The modifier is sameline or not
@@ -65,4 +94,17 @@ class ModifierRef: BaseModel {
         required <- map["required"]
         sameline <- map["sameline"]
     }
+    
+    override func decode(_ p: [String: Any]) {
+        super.decode(p)
+        p.read("required", &required)
+        p.read("sameline", &sameline)
+    }
+    
+    override func copy(from model: BaseModel) {
+        super.copy(from: model)
+        guard let model = model as? ModifierRef else { return }
+        required = model.required
+        sameline = model.sameline
+    }
 }
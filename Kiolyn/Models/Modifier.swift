@@ -15,6 +15,8 @@ class Modifier: BaseModel {
     override class var documentType: String { return "modifier" }
     /// The prefix to be used for calculating the document id.
     override class var documentIDPrefix: String { return "mod" }
+    /// Decoded/copied field by field.
+    override class var isTyped: Bool { return true }
     /// Return ALL modifier that
     /// 1. Has id
     /// 2. Has merchant id
@@ -64,6 +66,27 @@ class Modifier: BaseModel {
         options <- map["options"]
         custom <- map["custom"]
     }
+    
+    override func decode(_ p: [String: Any]) {
+        super.decode(p)
+        p.read("global", &global)
+        p.read("required", &required)
+        p.read("sameline", &sameline)
+        p.read("multiple", &multiple)
+        p.read("options", &options)
+        p.read("custom", &custom)
+    }
+    
+    override func copy(from model: BaseModel) {
+        super.copy(from: model)
+        guard let model = model as? Modifier else { return }
+        global = model.global
+        required = model.required
+        sameline = model.sameline
+        multiple = model.multiple
+        options = model.options.map { $0.duplicate() }
+        custom = model.custom
+    }
 }
 
 extension Modifier {
@@ -82,6 +105,8 @@ extension Modifier {
 
 /// Sync session object, stored inside local Store document after calling to API server for authentication.
 class Option: GridItemModel {
+    /// Decoded/copied field by field.
+    override class var isTyped: Bool { return true }
     /// The price of this option.
     var price: Double = 0
     
@@ -101,4 +126,15 @@ class Option: GridItemModel {
         super.mapping(map: map)
         price <- map["price"]
     }
+    
+    override func decode(_ p: [String: Any]) {
+        super.decode(p)
+        p.read("price", &price)
+    }
+    
+    override func copy(from model: BaseModel) {
+        super.copy(from: model)
+        guard let model = model as? Option else { return }
+        price = model.price
+    }
 }
@@ -42,6 +42,8 @@ class Order: BaseModel, OrderItemsContainer {
     override class var documentType: String { return "order" }
     /// The prefix to be used for calculating the document id.
     override class var documentIDPrefix: String { return "ord" }    
+    /// Decoded/copied field by field.
+    override class var isTyped: Bool { return true }
     // MARK: ORDER NO/TYPE
     /// Order Number which is sequentially increased and unique inside one shift.
     var orderNo: UInt = 0
@@ -181,6 +183,97 @@ class Order: BaseModel, OrderItemsContainer {
         items <- map["items"]
         bills <- map["bills"]
     }
+    
+    override func decode(_ p: [String: Any]) {
+        super.decode(p)
+        p.read("order_no", &orderNo)
+        p.read("order_type", &orderType)
+        p.read("area", &area)
+        p.read("area_name", &areaName)
+        p.read("table", &table)
+        p.read("table_name", &tableName)
+        p.read("persons", &persons)
+        p.read("shift", &shift)
+        p.read("shift_id", &shiftID)
+        p.read("service_fee", &serviceFee)
+        p.read("service_fee_reason", &serviceFeeReason)
+        p.read("service_fee_tax", &serviceFeeTax)
+        p.read("custom_service_fee_amount", &customServiceFeeAmount)
+        p.read("custom_service_fee_percent", &customServiceFeePercent)
+        p.read("tax", &tax)
+        p.read("tax_removed_by", &taxRemovedBy)
+        p.read("discount", &discount)
+        p.read("customer", &customer)
+        p.read("customer_name", &customerName)
+        p.read("customer_phone", &customerPhone)
+        p.read("customer_address", &customerAddress)
+        p.read("customer_email", &customerEmail)
+        p.read("delivery", &isDelivery)
+        p.read("driver", &driver)
+        p.read("driver_name", &driverName)
+        p.read("delivered", &delivered)
+        p.read("created_by", &createdBy)
+        p.read("created_by_name", &createdByName)
+        p.read("closed_by", &closedBy)
+        p.read("closed_at", &closedAt)
+        p.read("status", &orderStatus)
+        p.read("tip", &tip)
+        p.read("subtotal", &subtotal)
+        p.read("quantity", &quantity)
+        p.read("tax_amount", &taxAmount)
+        p.read("discount_amount", &discountAmount)
+        p.read("service_fee_amount", &serviceFeeAmount)
+        p.read("service_fee_tax_amount", &serviceFeeTaxAmount)
+        p.read("total", &total)
+        p.read("items", &items)
+        p.read("bills", &bills)
+    }
+    
+    override func copy(from model: BaseModel) {
+        super.copy(from: model)
+        guard let model = model as? Order else { return }
+        orderNo = model.orderNo
+        orderType = model.orderType
+        area = model.area
+        areaName = model.areaName
+        table = model.table
+        tableName = model.tableName
+        persons = model.persons
+        shift = model.shift
+        shiftID = model.shiftID
+        serviceFee = model.serviceFee
+        serviceFeeReason = model.serviceFeeReason
+        serviceFeeTax = model.serviceFeeTax
+        customServiceFeeAmount = model.customServiceFeeAmount
+        customServiceFeePercent = model.customServiceFeePercent
+        tax = model.tax.duplicate()
+        taxRemovedBy = model.taxRemovedBy
+        discount = model.discount.duplicate()
+        customer = model.customer
+        customerName = model.customerName
+        customerPhone = model.customerPhone
+        customerAddress = model.customerAddress
+        customerEmail = model.customerEmail
+        isDelivery = model.isDelivery
+        driver = model.driver
+        driverName = model.driverName
+        delivered = model.delivered
+        createdBy = model.createdBy
+        createdByName = model.createdByName
+        closedBy = model.closedBy
+        closedAt = model.closedAt
+        orderStatus = model.orderStatus
+        tip = model.tip
+        subtotal = model.subtotal
+        quantity = model.quantity
+        taxAmount = model.taxAmount
+        discountAmount = model.discountAmount
+        serviceFeeAmount = model.serviceFeeAmount
+        serviceFeeTaxAmount = model.serviceFeeTaxAmount
+        total = model.total
+        items = model.items.map { $0.duplicate() }
+        bills = model.bills.map { $0.duplicate() }
+    }
 }
 
 /// MARK: Status related
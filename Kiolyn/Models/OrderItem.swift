@@ -31,6 +31,8 @@ enum OrderItemStatus: String {
 
 /// Represent an `Item` inside an `Order`.
 class OrderItem: BaseModel {
+    /// Decoded/copied field by field.
+    override class var isTyped: Bool { return true }
     /// The Category (id) that this Order Item is created from.
     var categoryID = ""
     /// The Item (id) that this Order Item is created from.
@@ -105,6 +107,57 @@ class OrderItem: BaseModel {
         subtotal <- map["subtotal"]
     }
     
+    override func decode(_ p: [String: Any]) {
+        super.decode(p)
+        p.read("categoryid", &categoryID)
+        p.read("itemid", &itemID)
+        p.read("name2", &name2)
+        p.read("name2_lang", &name2Language)
+        p.read("price", &price)
+        p.read("color", &color)
+        p.read("open_item", &isOpenItem)
+        p.read("printers", &printers)
+        p.read("image", &image)
+        p.read("togo", &togo)
+        p.read("hold", &hold)
+        p.read("count", &count)
+        p.read("note", &note)
+        p.read("price_note", &priceNote)
+        p.read("modifiers", &modifiers)
+        p.read("billed_count", &billedCount)
+        p.read("paid_count", &paidCount)
+        p.read("void_reason", &voidReason)
+        p.read("status", &status)
+        p.read("isupdated", &isUpdated)
+        p.read("subtotal", &subtotal)
+    }
+    
+    override func copy(from model: BaseModel) {
+        super.copy(from: model)
+        guard let model = model as? OrderItem else { return }
+        categoryID = model.categoryID
+        itemID = model.itemID
+        name2 = model.name2
+        name2Language = model.name2Language
+        price = model.price
+        color = model.color
+        isOpenItem = model.isOpenItem
+        printers = model.printers.map { $0.duplicate() }
+        image = model.image?.duplicate()
+        togo = model.togo
+        hold = model.hold
+        count = model.count
+        note = model.note
+        priceNote = model.priceNote
+        modifiers = model.modifiers.map { $0.duplicate() }
+        billedCount = model.billedCount
+        paidCount = model.paidCount
+        voidReason = model.voidReason
+        status = model.status
+        isUpdated = model.isUpdated
+        subtotal = model.subtotal
+    }
+    
     /// Create from an Item, this should be called when an `Item` is selected from the Ordering screen.
     ///
     /// - Parameter item: The `Item` to add to `Order`.
@@ -199,7 +252,13 @@ extension OrderItem {
 extension OrderItem {
     /// Clone for billing.
     var billItem: OrderItem {
-        return self.clone(without: ["status", "billed_count", "paid_count", "hold", "togo"])
+        let item = duplicate()
+        item.status = .new
+        item.billedCount = 0
+        item.paidCount = 0
+        item.hold = false
+        item.togo = false
+        return item
     }
 }
 
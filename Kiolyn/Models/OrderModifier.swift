@@ -11,6 +11,8 @@ import ObjectMapper
 
 /// Hold the modifer/options in an Order Item of either Order or Bill.
 class OrderModifier: BaseModel {
+    /// Decoded/copied field by field.
+    override class var isTyped: Bool { return true }
     
     /// True if this is created from a global `Modifier`.
     var global = false
@@ -45,4 +47,21 @@ class OrderModifier: BaseModel {
         custom <- map["custom"]
         options <- map["options"]
     }
+    
+    override func decode(_ p: [String: Any]) {
+        super.decode(p)
+        p.read("global", &global)
+        p.read("sameline", &isSameline)
+        p.read("custom", &custom)
+        p.read("options", &options)
+    }
+    
+    override func copy(from model: BaseModel) {
+        super.copy(from: model)
+        guard let model = model as? OrderModifier else { return }
+        global = model.global
+        isSameline = model.isSameline
+        custom = model.custom
+        options = model.options.map { $0.duplicate() }
+    }
 }
@@ -17,6 +17,10 @@ class PrintingSettings: BaseModel {
         super.init(id: "")
     }
     
+    required init(id: String) {
+        super.init(id: id)
+    }
+    
     required convenience init?(map: Map) {
         self.init()
     }
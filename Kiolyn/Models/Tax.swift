@@ -11,6 +11,8 @@ import ObjectMapper
 
 /// Tax detail information.
 class Tax: BaseModel {
+    /// Decoded/copied field by field.
+    override class var isTyped: Bool { return true }
     /// Tax value in percentage.
     var percent: Double = 0
     /// True if this tax is a default one.
@@ -22,6 +24,19 @@ class Tax: BaseModel {
         isDefault <- map["default"]
     }
     
+    override func decode(_ p: [String: Any]) {
+        super.decode(p)
+        p.read("percent", &percent)
+        p.read("default", &isDefault)
+    }
+    
+    override func copy(from model: BaseModel) {
+        super.copy(from: model)
+        guard let model = model as? Tax else { return }
+        percent = model.percent
+        isDefault = model.isDefault
+    }
+    
     static let noTaxID = "no"
     /// No Tax tax object.
     static var noTax: Tax {
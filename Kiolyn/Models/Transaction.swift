@@ -91,6 +91,8 @@ class Transaction: BaseModel {
     override class var documentType: String { return "transaction" }
     /// The prefix to be used for calculating the document id.
     override class var documentIDPrefix: String { return "trs" }
+    /// Decoded/copied field by field.
+    override class var isTyped: Bool { return true }
     
     // MARK: - Type and Status
     /// Transaction type
@@ -237,6 +239,117 @@ class Transaction: BaseModel {
         settlingTrans <- map["settling_trans"]
         settledTrans <- map["settled_transactions"]
     }
+    
+    override func decode(_ p: [String: Any]) {
+        super.decode(p)
+        p.read("trans_type", &transType)
+        p.read("status", &transStatus)
+        p.read("area", &area)
+        p.read("area_name", &areaName)
+        p.read("table", &table)
+        p.read("table_name", &tableName)
+        p.read("payment_device", &paymentDevice)
+        p.read("payment_device_name", &paymentDeviceName)
+        p.read("custom_trans_type", &customTransType)
+        p.read("custom_trans_type_name", &customTransTypeName)
+        p.read("sub_payment_type", &subPaymentType)
+        p.read("sub_payment_type_name", &subPaymentTypeName)
+        p.read("order", &order)
+        p.read("bill", &bill)
+        p.read("created_by", &createdBy)
+        p.read("shift", &shift)
+        p.read("shift_index", &shiftIndex)
+        p.read("trans_num", &transNum)
+        p.read("order_no", &orderNum)
+        p.read("credit_amount", &creditAmount)
+        p.read("voided_by", &voidedBy)
+        p.read("voided_at", &voidedAt)
+        p.read("void_reason", &voidedReason)
+        p.read("tip_amount", &tipAmount)
+        p.read("adjusted_by", &adjustedBy)
+        p.read("adjusted_at", &adjustedAt)
+        p.read("avs_response", &avsResponse)
+        p.read("bogus_account_num", &cardNum)
+        p.read("card_type", &cardType)
+        p.read("cv_response", &cvResponse)
+        p.read("host_code", &hostCode)
+        p.read("host_response", &hostResponse)
+        p.read("message", &message)
+        p.read("approved_amount", &approvedAmount)
+        p.read("ref_num", &refNum)
+        p.read("remaining_balance", &remainingBalance)
+        p.read("extra_balance", &extraBalance)
+        p.read("requested_amount", &requestedAmount)
+        p.read("result_code", &resultCode)
+        p.read("result_txt", &resultTxt)
+        p.read("timestamp", &timestamp)
+        p.read("ext_data", &extData)
+        p.read("raw_response", &rawResponse)
+        p.read("auth_code", &authCode)
+        p.read("batch_num", &batchNum)
+        p.read("total_count", &totalCount)
+        p.read("total_amount", &totalAmount)
+        p.read("settled_by", &settledBy)
+        p.read("settled_at", &settledAt)
+        p.read("settling_trans", &settlingTrans)
+        p.read("settled_transactions", &settledTrans)
+    }
+    
+    override func copy(from model: BaseModel) {
+        super.copy(from: model)
+        guard let model = model as? Transaction else { return }
+        transType = model.transType
+        transStatus = model.transStatus
+        area = model.area
+        areaName = model.areaName
+        table = model.table
+        tableName = model.tableName
+        paymentDevice = model.paymentDevice
+        paymentDeviceName = model.paymentDeviceName
+        customTransType = model.customTransType
+        customTransTypeName = model.customTransTypeName
+        subPaymentType = model.subPaymentType
+        subPaymentTypeName = model.subPaymentTypeName
+        order = model.order
+        bill = model.bill
+        createdBy = model.createdBy
+        shift = model.shift
+        shiftIndex = model.shiftIndex
+        transNum = model.transNum
+        orderNum = model.orderNum
+        creditAmount = model.creditAmount
+        voidedBy = model.voidedBy
+        voidedAt = model.voidedAt
+        voidedReason = model.voidedReason
+        tipAmount = model.tipAmount
+        adjustedBy = model.adjustedBy
+        adjustedAt = model.adjustedAt
+        avsResponse = model.avsResponse
+        cardNum = model.cardNum
+        cardType = model.cardType
+        cvResponse = model.cvResponse
+        hostCode = model.hostCode
+        hostResponse = model.hostResponse
+        message = model.message
+        approvedAmount = model.approvedAmount
+        refNum = model.refNum
+        remainingBalance = model.remainingBalance
+        extraBalance = model.extraBalance
+        requestedAmount = model.requestedAmount
+        resultCode = model.resultCode
+        resultTxt = model.resultTxt
+        timestamp = model.timestamp
+        extData = model.extData
+        rawResponse = model.rawResponse
+        authCode = model.authCode
+        batchNum = model.batchNum
+        totalCount = model.totalCount
+        totalAmount = model.totalAmount
+        settledBy = model.settledBy
+        settledAt = model.settledAt
+        settlingTrans = model.settlingTrans
+        settledTrans = model.settledTrans
+    }
 }
 
 extension Transaction {
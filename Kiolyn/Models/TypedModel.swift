@@ -0,0 +1,75 @@
+//
+//  TypedModel.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 9/2/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+import ObjectMapper
+
+// MARK: - Typed decoding/copying
+extension BaseModel {
+    /// Create a model from stored properties. Typed models (see `isTyped`) are decoded field by
+    /// field, the others go through ObjectMapper.
+    ///
+    /// - Parameter properties: The stored properties.
+    /// - Returns: The model.
+    class func decoded(_ properties: [String: Any]) -> Self {
+        guard isTyped else {
+            return self.init(JSON: properties)!
+        }
+        // A new id only when there is none to read, it is costly to compute
+        let model = self.init(id: properties["id"] is String ? "" : BaseModel.newID)
+        model.decode(properties)
+        return model
+    }
+
+    /// Deep copy this model. Typed models are copied field by field, the others through their JSON.
+    ///
+    /// - Returns: The copy.
+    func duplicate() -> Self {
+        guard type(of: self).isTyped else {
+            return type(of: self).init(JSON: toJSON())!
+        }
+        let model = type(of: self).init(id: "")
+        model.copy(from: self)
+        return model
+    }
+}
+
+// MARK: - Typed reads, mirroring ObjectMapper's `<-`: fields are left untouched when the value is missing or of another type.
+extension Dictionary where Key == String {
+    func read<T>(_ key: String, _ field: inout T) {
+        if let value = self[key] as? T { field = value }
+    }
+
+    func read(_ key: String, _ field: inout Int) {
+        if let value = self[key] as? NSNumber { field = value.intValue }
+    }
+
+    func read(_ key: String, _ field: inout UInt) {
+        if let value = self[key] as? NSNumber { field = value.uintValue }
+    }
+
+    func read(_ key: String, _ field: inout UInt64) {
+        if let value = self[key] as? NSNumber { field = value.uint64Value }
+    }
+
+    func read<E: RawRepresentable>(_ key: String, _ field: inout E) where E.RawValue == String {
+        if let raw = self[key] as? String, let value = E(rawValue: raw) { field = value }
+    }
+
+    func read<M: BaseModel>(_ key: String, _ field: inout M) {
+        if let properties = self[key] as? [String: Any] { field = M.decoded(properties) }
+    }
+
+    func read<M: BaseModel>(_ key: String, _ field: inout M?) {
+        if let properties = self[key] as? [String: Any] { field = M.decoded(properties) }
+    }
+
+    func read<M: BaseModel>(_ key: String, _ field: inout [M]) {
+        if let list = self[key] as? [[String: Any]] { field = list.map { M.decoded($0) } }
+    }
+}
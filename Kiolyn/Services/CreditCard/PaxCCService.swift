@@ -253,11 +253,15 @@ class PaxCCService: CCService {
         }
     }
     
-    /// Scan the device for it's IP address.
+    /// Scan the device for it's IP address, known address from background sweeps is used
+    /// unless it is the one which could not be reached.
     ///
     /// - Parameter device: the device to be scan for
     /// - Returns: the Single of the mac address
     private func scan(for device: CCDevice) -> Single<String> {
+        if let ip = SP.addressResolver.ip(of: device.macAddress), ip != device.ipAddress {
+            return Single.just(ip)
+        }
         return Single.create { single in
             self.queue.async {
                 // No need to run on different dispatch queue,
@@ -266,6 +270,7 @@ class PaxCCService: CCService {
                     guard let ip = ip, ip.isNotEmpty else {
                         return single(.error(CCError.deviceNotFound))
                     }
+                    SP.addressResolver.record(device.macAddress, ip: ip)
                     single(.success(ip))
                 }
             }
@@ -32,14 +32,15 @@ extension DataService {
     /// - Parameters:
     ///   - page: the page to load for.
     ///   - pageSize: the page count to load for.
+    ///   - next: the continuation key of the previous page, `nil` to load by page number.
     /// - Returns: Single of the loading result.
-    func loadCustomers(page: UInt, pageSize: UInt) -> Single<QueryResult<Customer>> {
+    func loadCustomers(page: UInt, pageSize: UInt, after next: String? = nil) -> Single<QueryResult<Customer>> {
         if self.isMain {
             return self.db.async {
-                return self.db.load(customers: self.store.id, page: page, pageSize: pageSize)
+                return self.db.load(customers: self.store.id, page: page, pageSize: pageSize, after: next)
             }
         } else {
-            return restClient.loadCustomers(page: page, pageSize: pageSize)
+            return restClient.loadCustomers(page: page, pageSize: pageSize, after: next)
         }
     }
 }
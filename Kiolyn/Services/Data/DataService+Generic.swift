@@ -81,7 +81,9 @@ extension DataService {
         }
         if isMain {
             return db.async {
-                try self.db.save(all: objs)
+                let batch = WriteBatch()
+                batch.save(all: objs)
+                _ = try self.commit(batch)
                 return objs
             }
         } else {
@@ -90,6 +92,21 @@ extension DataService {
         }
     }
     
+    /// Commit a write batch to the local database (main station), informing of the changed orders
+    /// once the batch is committed.
+    ///
+    /// - Parameter batch: the batch to commit.
+    /// - Returns: the written documents and their new revisions.
+    /// - Throws: the error of the first failing operation, nothing is written then.
+    func commit(_ batch: WriteBatch) throws -> [WriteResult] {
+        let results = try db.commit(batch)
+        let orderIDs = batch.ids(of: Order.self)
+        if orderIDs.isNotEmpty {
+            localOrderChanged.on(.next(orderIDs))
+        }
+        return results
+    }
+    
     /// Delete a single object
     ///
     /// - Parameter obj: the obj to save.
@@ -46,7 +46,7 @@ extension DataService {
                 guard let lockedOrders = try self.lock(orders: orders.map { order in order.id }, forStation: stationID) else {
                     throw LockingOrderError.alreadyLocked
                 }
-                return lockedOrders.map { properties in Order(JSON: properties)! }
+                return lockedOrders.map { properties in Order.decoded(properties) }
             }
         } else {
             return restClient.lock(orders: orders.map { $0.id })
@@ -60,19 +60,23 @@ extension DataService {
     ///     - stationID: the station that is requesting for locking.
     /// - Returns: the list of locked orders.
     func lock(orders: [String], forStation stationID: String) throws -> [[String: Any]]? {
+        return try lease(orders: orders, forStation: stationID)?.orders
+    }
+    
+    /// Lease the given Orders to given StationID.
+    ///
+    /// - Parameters:
+    ///     - orders: the orders' ids to be locked.
+    ///     - stationID: the station that is requesting for locking.
+    /// - Returns: the list of locked orders and their fencing tokens.
+    func lease(orders: [String], forStation stationID: String) throws -> (orders: [[String: Any]], tokens: [String: UInt64])? {
         // Ensure good inputs
         guard orders.isNotEmpty, stationID.isNotEmpty else {
             return nil
         }
-        var lockedOrders = self.lockedOrders.value
         // First of all, make sure ALL requested orders are not being locked
         // by other station
-        let isLocked = orders.any { orderID in
-            lockedOrders.contains { (key, value) -> Bool in
-                key == orderID && value != stationID
-            }
-        }
-        guard !isLocked else { return nil }
+        guard !orderLocks.isLocked(orders, byOtherThan: stationID) else { return nil }
         
         let newOrders = self.db.loadProperties(multi: orders, for: Order.self)
             .filter { order in order != nil }
@@ -81,13 +85,50 @@ extension DataService {
             i("[DS] Could not fully load all orders for locking")
             return nil
         }
-        // Add to locked order list
-        for id in orders {
-            lockedOrders[id] = stationID
+        guard let tokens = orderLocks.acquire(orders, for: stationID) else {
+            return nil
+        }
+        return (newOrders, tokens)
+    }
+    
+    /// Lock, save then unlock orders for a station in one go, for Subs to modify an order in one
+    /// round trip. Must be called from the database queue.
+    ///
+    /// - Parameters:
+    ///     - lock: the ids of the orders to lock.
+    ///     - save: the properties of the orders to save, saved together or not at all.
+    ///     - tokens: the fencing tokens of the saved orders leased before.
+    ///     - unlock: `true` to unlock all the orders of the station at the end.
+    ///     - stationID: the station that is requesting.
+    /// - Returns: the locked orders with their fencing tokens and the new revisions of the saved ones, `nil` if an order is locked by another station or its lease was lost.
+    /// - Throws: the error of the failing save, nothing is saved then.
+    func commit(orderTransaction lock: [String], save: [[String: Any]], tokens: [String: UInt64], unlock: Bool, forStation stationID: String) throws -> (orders: [[String: Any]], tokens: [String: UInt64], revisions: [String])? {
+        var leased: (orders: [[String: Any]], tokens: [String: UInt64]) = ([], [:])
+        if lock.isNotEmpty {
+            guard let orders = try self.lease(orders: lock, forStation: stationID) else {
+                return nil
+            }
+            leased = orders
+        }
+        let savedOrders = save.compactMap { properties in properties["id"] as? String }
+        guard orderLocks.renew(savedOrders, tokens: leased.tokens.merging(tokens) { leasedToken, _ in leasedToken }, for: stationID) else {
+            return nil
+        }
+        defer {
+            if unlock {
+                self.unlock(allOrders: stationID)
+            }
+        }
+        guard save.isNotEmpty else {
+            return (leased.orders, leased.tokens, [])
+        }
+        let batch = WriteBatch()
+        for properties in save {
+            batch.save(properties: properties)
         }
-        self.lockedOrders.accept(lockedOrders)
-        // Return the orders with force optional
-        return newOrders
+        let revisions = try db.commit(batch).map { result in result.revision }
+        remoteOrderChanged.on(.next(savedOrders))
+        return (leased.orders, leased.tokens, revisions)
     }
     
     /// Unlock all orders
@@ -110,7 +151,6 @@ extension DataService {
     /// - Parameter stationID: the station's id to be unlocking for.
     /// - Returns: Single of the unlocking result
     func unlock(allOrders stationID: String) {
-        let lockedOrders = self.lockedOrders.value.filter { (_, lockingStationID) in stationID != lockingStationID }
-        self.lockedOrders.accept(lockedOrders)
+        orderLocks.release(allOf: stationID)
     }
 }
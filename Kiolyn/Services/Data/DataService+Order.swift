@@ -14,20 +14,32 @@ extension DataService {
     
     /// Save an Order
     ///
-    /// - Parameter order: the Order to save.
+    /// - Parameters:
+    ///   - order: the Order to save.
+    ///   - unlockingAll: `true` to also unlock all the orders of this station, in the same round trip to Main.
     /// - Returns: Single of the result.
-    func save(order: Order) -> Single<Order?> {
+    func save(order: Order, unlockingAll: Bool = false) -> Single<Order?> {
         order.updatedAt = BaseModel.timestamp
         order.updatedBy = id?.employee.id ?? ""
 
         if self.isMain {
             return self.db.async {
+                let stationID = self.id?.station.id ?? ""
+                defer {
+                    if unlockingAll {
+                        self.unlock(allOrders: stationID)
+                    }
+                }
+                // Renew the lease of the order while it is edited here
+                guard self.orderLocks.extend([order.id], for: stationID) else {
+                    throw LockingOrderError.alreadyLocked
+                }
                 try self.db.save(order)
                 SP.dataService.localOrderChanged.on(.next([order.id]))
                 return order
             }
         } else {
-            return restClient.save(order: order)
+            return restClient.save(order: order, unlockingAll: unlockingAll)
                 .map { revision in
                     guard let rev = revision, rev.isNotEmpty else {
                         return nil
@@ -66,11 +78,10 @@ extension DataService {
     func merge(order: Order, from orders: [Order]) -> Single<Order?> {
         if self.isMain {
             return self.db.async {
-                try self.db.runBatch {
-                    try self.db.save(order)
-                    try self.db.delete(multi: orders)
-                    SP.dataService.localOrderChanged.on(.next([order.id] + orders.map { $0.id }))
-                }
+                let batch = WriteBatch()
+                batch.save(order)
+                batch.delete(multi: orders)
+                _ = try self.commit(batch)
                 return order
             }
         } else {
@@ -123,17 +134,18 @@ extension DataService {
     ///   - statuses: the filter statuses.
     ///   - page: the page to load for.
     ///   - pageSize: the page size to load for.
+    ///   - next: the continuation key of the previous page, `nil` to load by page number.
     /// - Returns: Single of the loading result.
-    func load(orders statuses: [OrderStatus], page: UInt, pageSize: UInt) -> Single<QueryResult<Order>> {
+    func load(orders statuses: [OrderStatus], page: UInt, pageSize: UInt, after next: String? = nil) -> Single<QueryResult<Order>> {
         guard  let shiftID = activeShift.value?.id else {
             return Single.just(QueryResult())
         }
         if self.isMain {
             return self.db.async {
-                self.db.load(orders: self.store.id, forShift: shiftID, matchingStatuses: statuses, page: page, pageSize: pageSize)
+                self.db.load(orders: self.store.id, forShift: shiftID, matchingStatuses: statuses, page: page, pageSize: pageSize, after: next)
             }
         } else {
-            return restClient.load(orders: shiftID, statuses: statuses, page: page, pageSize: pageSize)
+            return restClient.load(orders: shiftID, statuses: statuses, page: page, pageSize: pageSize, after: next)
         }
     }
 }
@@ -10,6 +10,27 @@ import Foundation
 import RxSwift
 
 extension DataService {
+    /// Load the unsettled transactions of the active shift, with support for pagination.
+    ///
+    /// - Parameters:
+    ///   - paymentType: the payment type to filter for, empty for all.
+    ///   - page: the page to load for.
+    ///   - pageSize: the page size to load for.
+    ///   - next: the continuation key of the previous page, `nil` to load by page number.
+    /// - Returns: Single of the loading result.
+    func load(unsettledTransactions paymentType: String, page: UInt, pageSize: UInt, after next: String? = nil) -> Single<QueryResult<Transaction>> {
+        guard let shiftID = activeShift.value?.id else {
+            return Single.just(QueryResult())
+        }
+        if self.isMain {
+            return self.db.async {
+                self.db.load(unsettledTransactions: self.store.id, shift: shiftID, for: paymentType, page: page, pageSize: pageSize, after: next)
+            }
+        } else {
+            return restClient.load(unsettledTransactions: shiftID, for: paymentType, page: page, pageSize: pageSize, after: next)
+        }
+    }
+    
     /// Load current Store's active shift
     ///
     /// - Returns: `Single` of the active shift.
@@ -140,6 +161,7 @@ extension DataService {
             if orders.isEmpty {
                 // Save the models in one single shot
                 try self.db.save(all: updatedModels)
+                self.archiveClosedShifts(storeID)
                 // Clear the current shift
                 self.activeShift.accept(nil)
                 return nil
@@ -164,12 +186,27 @@ extension DataService {
                 updatedModels.append(contentsOf: orders as [BaseModel])
                 // Save the models in one single shot
                 try self.db.save(all: updatedModels)
+                self.archiveClosedShifts(storeID)
                 // Update new shift
                 self.activeShift.accept(newShift)
                 return newShift
             }
         }
     }
+    
+    /// Archive the closed orders/transactions, closing the shift must not fail because of it.
+    ///
+    /// - Parameter storeID: The store to archive for.
+    fileprivate func archiveClosedShifts(_ storeID: String) {
+        do {
+            let count = try self.db.archive(closedShifts: storeID)
+            if count > 0 {
+                i("[Shift] Archived \(count) closed orders/transactions")
+            }
+        } catch {
+            w("[Shift] Could not archive closed shifts: \(error)")
+        }
+    }
 }
 
 /// The counter of shift.
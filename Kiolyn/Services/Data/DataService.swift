@@ -31,6 +31,24 @@ class DataService {
     /// Contain the list of orders locked by remote station
     let lockedOrders = BehaviorRelay<LockedOrders>(value: [:])
     
+    /// The order leases given by Main, `lockedOrders` follows them.
+    lazy var orderLocks: OrderLockManager = {
+        let orderLocks = OrderLockManager()
+        self.lockedOrders.accept(orderLocks.lockedOrders)
+        orderLocks.changed
+            .subscribe(onNext: { delta in
+                self.lockedOrders.accept(delta.apply(to: self.lockedOrders.value))
+            })
+            .disposed(by: self.disposeBag)
+        orderLocks.snapshot
+            .filter { lockedOrders in lockedOrders != self.lockedOrders.value }
+            .subscribe(onNext: { lockedOrders in
+                self.lockedOrders.accept(lockedOrders)
+            })
+            .disposed(by: self.disposeBag)
+        return orderLocks
+    }()
+    
     /// Publish to this to raise remote order changed.
     let remoteOrderChanged = PublishSubject<[String]>()
     let localOrderChanged = PublishSubject<[String]>()
@@ -76,6 +94,10 @@ class DataService {
     /// - Returns: `Single` of the loading result.
     func load(items categoryID: String) -> Single<[Item]> {
         if self.isMain {
+            // Menu in memory, no need to wait for the database
+            if let menu = self.db.cached(menu: self.store.id) {
+                return Single.just(menu.properties(items: categoryID).map { properties in Item.decoded(properties) })
+            }
             return self.db.async {
                 self.db.load(items: self.store.id, forCategory: categoryID)
             }
@@ -90,6 +112,9 @@ class DataService {
     /// - Returns: `Single` of the modifiers.
     func load(modifiers itemID: String) -> Single<[Modifier]> {
         if self.isMain {
+            if let modifiers = self.db.cached(menu: self.store.id)?.load(modifiers: itemID) {
+                return Single.just(modifiers)
+            }
             return self.db.async {
                 self.db.load(modifiers: itemID)
             }
@@ -104,6 +129,9 @@ class DataService {
     /// - Returns: `Single` of the modifiers.
     func loadGlobalModifiers() -> Single<[Modifier]> {
         if self.isMain {
+            if let menu = self.db.cached(menu: self.store.id) {
+                return Single.just(menu.globalModifiers.map { properties in Modifier.decoded(properties) })
+            }
             return self.db.async {
                 self.db.load(globalModifiers: self.store.id)
             }
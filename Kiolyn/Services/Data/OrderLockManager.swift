@@ -0,0 +1,340 @@
+//
+//  OrderLockManager.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 9/9/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+import RxSwift
+import SwiftyUserDefaults
+
+extension DefaultsKeys {
+    static let orderLocks = DefaultsKey<[String: Any]?>("orderLocks")
+}
+
+/// The lease of an order by a station.
+struct OrderLease {
+    let orderID: String
+    let stationID: String
+    /// The fencing token, greater than the one of any lease given before.
+    let token: UInt64
+    let expiresAt: Date
+}
+
+/// The orders locked and unlocked by a change of the leases.
+struct OrderLockDelta {
+    /// The locking station by order.
+    var locked: LockedOrders = [:]
+    var unlocked: [String] = []
+
+    var isEmpty: Bool {
+        return locked.isEmpty && unlocked.isEmpty
+    }
+
+    /// JSON properties of the delta.
+    var properties: [String: Any] {
+        return ["locked": locked, "unlocked": unlocked]
+    }
+
+    /// Add a later delta.
+    ///
+    /// - Parameter delta: The delta following this one.
+    mutating func merge(_ delta: OrderLockDelta) {
+        for orderID in delta.unlocked {
+            locked[orderID] = nil
+        }
+        unlocked = unlocked.filter { orderID in delta.locked[orderID] == nil } + delta.unlocked.filter { !unlocked.contains($0) }
+        for (orderID, stationID) in delta.locked {
+            locked[orderID] = stationID
+        }
+    }
+
+    /// Apply to locked orders.
+    ///
+    /// - Parameter lockedOrders: The locked orders before this delta.
+    /// - Returns: The locked orders after this delta.
+    func apply(to lockedOrders: LockedOrders) -> LockedOrders {
+        var lockedOrders = lockedOrders
+        for orderID in unlocked {
+            lockedOrders[orderID] = nil
+        }
+        for (orderID, stationID) in locked {
+            lockedOrders[orderID] = stationID
+        }
+        return lockedOrders
+    }
+}
+
+/// Order locks of Main, in memory as leases per order. A lease expires if not renewed by its
+/// station locking or saving the order again, a crashed Sub does not keep its orders locked. The
+/// station editing an order locks it again from time to time for its lease to outlive long edits.
+/// Each lease has a fencing token: a save carrying the token of an expired then taken lease is
+/// refused, so is a save without token of an order leased or released not long ago. Leases are
+/// checkpointed to the user defaults from time to time only, for a restarted Main to keep them.
+class OrderLockManager {
+    /// Leases last this long unless renewed.
+    static let ttl: TimeInterval = 10 * 60
+    /// Expired leases are dropped and dirty leases checkpointed this often.
+    static let sweepInterval: RxTimeInterval = 15
+    /// All the locked orders are published this often, for the followers of the changes to resync.
+    static let snapshotInterval: RxTimeInterval = 60
+
+    let disposeBag = DisposeBag()
+
+    /// Emit the changes of the leases, in the order they were made.
+    let changed = PublishSubject<OrderLockDelta>()
+    /// Emit all the locked orders from time to time, after the changes made before.
+    let snapshot = PublishSubject<LockedOrders>()
+
+    fileprivate let lock = NSLock()
+    fileprivate var leases: [String: OrderLease] = [:]
+    /// The time the lease of an order ended, for the orders released or expired within the ttl.
+    fileprivate var ended: [String: Date] = [:]
+    fileprivate var lastToken: UInt64 = 0
+    /// `true` if the leases changed since the last checkpoint.
+    fileprivate var dirty = false
+    /// Changes are published from this queue, one at a time.
+    fileprivate let publishing = DispatchQueue(label: "com.willbe.kiolyn.order-locks", qos: .utility)
+
+    init() {
+        restore()
+        let scheduler = ConcurrentDispatchQueueScheduler(qos: .utility)
+        Observable<Int>.interval(OrderLockManager.sweepInterval, scheduler: scheduler)
+            .subscribe(onNext: { _ in
+                self.sweep()
+                self.checkpoint()
+            })
+            .disposed(by: disposeBag)
+        Observable<Int>.interval(OrderLockManager.snapshotInterval, scheduler: scheduler)
+            .subscribe(onNext: { _ in
+                self.publishSnapshot()
+            })
+            .disposed(by: disposeBag)
+    }
+
+    /// The locking station by order, for the leases not expired.
+    var lockedOrders: LockedOrders {
+        lock.lock()
+        defer { lock.unlock() }
+        return currentLockedOrders()
+    }
+
+    /// Lease orders to a station, all or none. Leases the station holds already are renewed.
+    ///
+    /// - Parameters:
+    ///   - orderIDs: The orders.
+    ///   - stationID: The station.
+    ///   - ttl: The lease duration.
+    /// - Returns: The fencing tokens by order, `nil` if an order is leased to another station.
+    func acquire(_ orderIDs: [String], for stationID: String, ttl: TimeInterval = OrderLockManager.ttl) -> [String: UInt64]? {
+        lock.lock()
+        let now = Date()
+        guard !isLeased(orderIDs, byOtherThan: stationID, at: now) else {
+            lock.unlock()
+            return nil
+        }
+        var tokens: [String: UInt64] = [:]
+        var delta = OrderLockDelta()
+        for orderID in orderIDs {
+            let held = leases[orderID].flatMap { lease in lease.stationID == stationID && lease.expiresAt > now ? lease : nil }
+            let token = held?.token ?? nextToken(at: now)
+            leases[orderID] = OrderLease(orderID: orderID, stationID: stationID, token: token, expiresAt: now.addingTimeInterval(ttl))
+            ended[orderID] = nil
+            tokens[orderID] = token
+            if held == nil {
+                delta.locked[orderID] = stationID
+            }
+        }
+        dirty = true
+        publish(delta)
+        lock.unlock()
+        return tokens
+    }
+
+    /// Check the leases of orders to save and renew them.
+    ///
+    /// - Parameters:
+    ///   - orderIDs: The orders to save.
+    ///   - tokens: The fencing tokens by order. Orders without token must not be leased, nor have been within the ttl.
+    ///   - stationID: The saving station.
+    /// - Returns: `true` if the station may save the orders.
+    func renew(_ orderIDs: [String], tokens: [String: UInt64], for stationID: String) -> Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        let now = Date()
+        for orderID in orderIDs {
+            guard let token = tokens[orderID] else {
+                // The station may have lost the lease, or never had it
+                guard leases[orderID] == nil, ended[orderID] == nil else {
+                    return false
+                }
+                continue
+            }
+            // The lease ended, or expired and was given again since
+            guard let lease = leases[orderID], lease.token == token, lease.stationID == stationID else {
+                return false
+            }
+        }
+        for orderID in orderIDs {
+            guard let lease = leases[orderID] else { continue }
+            leases[orderID] = OrderLease(orderID: orderID, stationID: stationID, token: lease.token, expiresAt: now.addingTimeInterval(OrderLockManager.ttl))
+            dirty = true
+        }
+        return true
+    }
+
+    /// Renew the leases a station holds on orders it saves without fencing token, Main saving its own orders.
+    ///
+    /// - Parameters:
+    ///   - orderIDs: The orders.
+    ///   - stationID: The station.
+    /// - Returns: `false` if an order is leased to another station.
+    func extend(_ orderIDs: [String], for stationID: String) -> Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        let now = Date()
+        guard !isLeased(orderIDs, byOtherThan: stationID, at: now) else {
+            return false
+        }
+        for orderID in orderIDs {
+            guard let lease = leases[orderID], lease.stationID == stationID, lease.expiresAt > now else { continue }
+            leases[orderID] = OrderLease(orderID: orderID, stationID: stationID, token: lease.token, expiresAt: now.addingTimeInterval(OrderLockManager.ttl))
+            dirty = true
+        }
+        return true
+    }
+
+    /// Check if any of the orders is leased to another station.
+    ///
+    /// - Parameters:
+    ///   - orderIDs: The orders.
+    ///   - stationID: The station.
+    /// - Returns: `true` if an order is leased to another station.
+    func isLocked(_ orderIDs: [String], byOtherThan stationID: String) -> Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        return isLeased(orderIDs, byOtherThan: stationID, at: Date())
+    }
+
+    /// Release all the leases of a station.
+    ///
+    /// - Parameter stationID: The station.
+    func release(allOf stationID: String) {
+        lock.lock()
+        let now = Date()
+        let released = leases.values.filter { $0.stationID == stationID }.map { $0.orderID }
+        for orderID in released {
+            leases[orderID] = nil
+            ended[orderID] = now
+        }
+        if released.isNotEmpty {
+            dirty = true
+        }
+        publish(OrderLockDelta(locked: [:], unlocked: released))
+        lock.unlock()
+    }
+
+    // MARK: - Leases
+
+    /// Must be called with the lock held.
+    fileprivate func isLeased(_ orderIDs: [String], byOtherThan stationID: String, at now: Date) -> Bool {
+        return orderIDs.any { orderID in
+            guard let lease = leases[orderID] else { return false }
+            return lease.stationID != stationID && lease.expiresAt > now
+        }
+    }
+
+    /// A token greater than all given before, also after a restart not checkpointed. Must be called with the lock held.
+    fileprivate func nextToken(at now: Date) -> UInt64 {
+        lastToken = max(lastToken + 1, UInt64(now.timeIntervalSince1970 * 1000))
+        return lastToken
+    }
+
+    /// The locking station by order, for the leases not expired. Must be called with the lock held.
+    fileprivate func currentLockedOrders() -> LockedOrders {
+        let now = Date()
+        var lockedOrders: LockedOrders = [:]
+        for lease in leases.values where lease.expiresAt > now {
+            lockedOrders[lease.orderID] = lease.stationID
+        }
+        return lockedOrders
+    }
+
+    /// Drop the expired leases, and forget the leases ended for longer than the ttl.
+    fileprivate func sweep() {
+        lock.lock()
+        let now = Date()
+        let expired = leases.values.filter { $0.expiresAt <= now }.map { $0.orderID }
+        for orderID in expired {
+            leases[orderID] = nil
+            ended[orderID] = now
+        }
+        ended = ended.filter { _, endedAt in now.timeIntervalSince(endedAt) < OrderLockManager.ttl }
+        if expired.isNotEmpty {
+            dirty = true
+            d("[OrderLocks] Expired \(expired)")
+        }
+        publish(OrderLockDelta(locked: [:], unlocked: expired))
+        lock.unlock()
+    }
+
+    /// Publish a change of the leases. Must be called with the lock held, for the changes to be
+    /// published in the order they were made.
+    fileprivate func publish(_ delta: OrderLockDelta) {
+        guard !delta.isEmpty else { return }
+        publishing.async {
+            self.changed.onNext(delta)
+        }
+    }
+
+    /// Publish all the locked orders.
+    fileprivate func publishSnapshot() {
+        lock.lock()
+        let lockedOrders = currentLockedOrders()
+        publishing.async {
+            self.snapshot.onNext(lockedOrders)
+        }
+        lock.unlock()
+    }
+
+    // MARK: - Checkpoint
+
+    /// Save the leases if they changed.
+    fileprivate func checkpoint() {
+        lock.lock()
+        guard dirty else {
+            lock.unlock()
+            return
+        }
+        let checkpoint: [String: Any] = [
+            "token": NSNumber(value: lastToken),
+            "leases": leases.values.map { lease in
+                [lease.orderID, lease.stationID, NSNumber(value: lease.token), lease.expiresAt.timeIntervalSince1970]
+            }
+        ]
+        dirty = false
+        lock.unlock()
+        Defaults[.orderLocks] = checkpoint
+    }
+
+    /// Load the leases of the last checkpoint.
+    fileprivate func restore() {
+        guard let checkpoint = Defaults[.orderLocks] else { return }
+        let now = Date()
+        lastToken = (checkpoint["token"] as? NSNumber)?.uint64Value ?? 0
+        for lease in (checkpoint["leases"] as? [[Any]]) ?? [] {
+            guard lease.count == 4,
+                let orderID = lease[0] as? String,
+                let stationID = lease[1] as? String,
+                let token = (lease[2] as? NSNumber)?.uint64Value,
+                let expiresAt = (lease[3] as? NSNumber).map({ Date(timeIntervalSince1970: $0.doubleValue) }),
+                expiresAt > now else {
+                    continue
+            }
+            leases[orderID] = OrderLease(orderID: orderID, stationID: stationID, token: token, expiresAt: expiresAt)
+        }
+        d("[OrderLocks] Restored \(leases.count) leases")
+    }
+}
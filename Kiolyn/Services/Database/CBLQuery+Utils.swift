@@ -126,6 +126,6 @@ extension CBLDocument {
     ///
     /// - Returns: the model if success.
     func loadModel<T: BaseModel>() -> T? {
-        return T(JSON: properties ?? [:])
+        return T.decoded(properties ?? [:])
     }
 }
@@ -0,0 +1,111 @@
+//
+//  ChangeFeed.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 9/6/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+import RxSwift
+
+/// The documents changed since a database sequence, for Subs to catch up with Main. Deleted
+/// documents are not listed by sequence, the ones deleted since the feed was created are kept
+/// in memory instead.
+class ChangeFeed {
+
+    /// A changed document.
+    struct Change {
+        /// The sequence of the change.
+        let sequence: UInt64
+        let docID: String
+        /// The current properties, `nil` for deleted documents.
+        let properties: [String: Any]?
+    }
+
+    /// Most deletions kept, older ones are forgotten.
+    static let maxDeletions = 10000
+
+    let disposeBag = DisposeBag()
+
+    fileprivate let lock = NSLock()
+    /// Deletions are known from this sequence on.
+    fileprivate var startSequence: UInt64
+    /// Deleted documents with (an upper bound of) their sequence, oldest first.
+    fileprivate var deletions: [(UInt64, String)] = []
+    fileprivate let database: CBLDatabase
+
+    /// Create the feed.
+    ///
+    /// - Parameter database: The database to follow changes of.
+    init(database: CBLDatabase) {
+        self.database = database
+        self.startSequence = database.lastSequenceNumber
+        NotificationCenter.default.rx
+            .notification(.cblDatabaseChange, object: database)
+            .subscribe(onNext: { notification in
+                guard let changes = notification.userInfo?["changes"] as? [CBLDatabaseChange] else { return }
+                self.record(changes.map { $0.documentID })
+            })
+            .disposed(by: disposeBag)
+    }
+
+    /// The documents changed after a sequence, at their last change. Must be called from the database queue.
+    ///
+    /// - Parameters:
+    ///   - since: The sequence already caught up with.
+    ///   - prefix: The document id prefix of the documents to list.
+    /// - Returns: The changes ordered by sequence, `nil` if deletions since then are not known.
+    func changes(since: UInt64, prefix: String) -> [Change]? {
+        lock.lock()
+        let known = since >= startSequence
+        let deleted = deletions.filter { $0.0 > since && $0.1.hasPrefix(prefix) }
+        lock.unlock()
+        guard known else {
+            return nil
+        }
+        let last = database.lastSequenceNumber
+        var changes = deleted.map { Change(sequence: $0.0, docID: $0.1, properties: nil) }
+        guard since < last else {
+            return changes
+        }
+        let query = database.createAllDocumentsQuery()
+        query.allDocsMode = .bySequence
+        query.descending = true
+        query.prefetch = true
+        // A document is listed once, at its last sequence
+        query.limit = UInt(last - since)
+        do {
+            for r in try query.run() {
+                guard let row = r as? CBLQueryRow else { continue }
+                // Newest first, stop at what was already caught up with
+                guard row.sequenceNumber > since else { break }
+                guard let docID = row.documentID, docID.hasPrefix(prefix) else { continue }
+                changes.append(Change(sequence: row.sequenceNumber, docID: docID, properties: row.documentProperties))
+            }
+        } catch {
+            e("[ChangeFeed] Could not list changes: \(error)")
+            return nil
+        }
+        // Deleted then created again documents are listed by sequence
+        let listed = Set(changes.filter { $0.properties != nil }.map { $0.docID })
+        return changes
+            .filter { $0.properties != nil || !listed.contains($0.docID) }
+            .sorted { $0.sequence < $1.sequence }
+    }
+
+    /// Keep the deleted documents.
+    fileprivate func record(_ docIDs: [String]) {
+        let deleted = docIDs.filter { docID in database.existingDocument(withID: docID)?.isDeleted ?? true }
+        guard deleted.isNotEmpty else { return }
+        let sequence = database.lastSequenceNumber
+        lock.lock()
+        deletions.append(contentsOf: deleted.map { (sequence, $0) })
+        if deletions.count > ChangeFeed.maxDeletions {
+            let dropped = deletions.count - ChangeFeed.maxDeletions
+            startSequence = max(startSequence, deletions[dropped - 1].0)
+            deletions.removeFirst(dropped)
+        }
+        lock.unlock()
+    }
+}
@@ -0,0 +1,215 @@
+//
+//  CouchbaseDatabase+Archive.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 9/1/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+/// A report view row, of a live or archived document.
+typealias ArchiveViewRow = (key: [Any], value: Any?, properties: [String: Any])
+
+extension CouchbaseDatabase {
+    fileprivate static let pushCheckpointID = "push_checkpoint"
+
+    /// The last database sequence known to be pushed to the remote server.
+    var pushedSequence: UInt64 {
+        return (database.existingLocalDocument(withID: CouchbaseDatabase.pushCheckpointID)?["sequence"] as? NSNumber)?.uint64Value ?? 0
+    }
+
+    /// Remember that the documents up to the given sequence are pushed to the remote server.
+    ///
+    /// - Parameter sequence: The database sequence at the start of the completed push.
+    func markPushed(upTo sequence: UInt64) {
+        guard sequence > pushedSequence else { return }
+        do {
+            try database.putLocalDocument(["sequence": NSNumber(value: sequence)], withID: CouchbaseDatabase.pushCheckpointID)
+        } catch {
+            w("[Archive] Could not save push checkpoint: \(error)")
+        }
+    }
+
+    /// Move the closed orders and settled transactions of a store out of the live database into the
+    /// archive, then compact the database. Only documents older than the archive retention and
+    /// already pushed to the remote server are moved, they are purged (not deleted) so that the
+    /// removal does not replicate.
+    ///
+    /// - Parameter storeID: The store to archive for.
+    /// - Returns: Number of archived documents.
+    /// - Throws: error if the archive could not be written or the documents could not be purged.
+    func archive(closedShifts storeID: String) throws -> Int {
+        let start = Date()
+        let pushed = pushedSequence
+        guard pushed > 0 else { return 0 }
+        let cutoff = Date().addingTimeInterval(-Double(shiftArchive.retentionDays) * 24 * 60 * 60).toString("yyMMdd")
+        let archivable: [String: Set<String>] = [
+            Order.documentIDPrefix: [OrderStatus.checked.rawValue, OrderStatus.voided.rawValue],
+            Transaction.documentIDPrefix: [TransactionStatus.settled.rawValue, TransactionStatus.voidedSettled.rawValue]
+        ]
+
+        var byDay: [String: [(String, [String: Any])]] = [:]
+        for (prefix, statuses) in archivable {
+            // Document ids are prefix_yyMMdd..., list the days before the cutoff
+            let query = database.createAllDocumentsQuery()
+            query.startKey = "\(prefix)_"
+            query.endKey = "\(prefix)_\(cutoff)"
+            query.inclusiveEnd = false
+            query.prefetch = true
+            for r in try query.run() {
+                guard let row = r as? CBLQueryRow, row.sequenceNumber <= pushed,
+                    let docID = row.documentID,
+                    let properties = row.documentProperties,
+                    properties["deleted"] == nil,
+                    ((properties["storeid"] as? String) ?? (properties["merchantid"] as? String)) == storeID,
+                    let status = properties["status"] as? String, statuses.contains(status),
+                    let id = properties["id"] as? String, id.count > 6 else {
+                        continue
+                }
+                let day = String(id.prefix(6))
+                byDay[day, default: []].append((docID, properties.filter { !$0.key.hasPrefix("_") }))
+            }
+        }
+        guard !byDay.isEmpty else { return 0 }
+
+        // Written and synced before anything is purged
+        for (day, documents) in byDay {
+            try shiftArchive.append(documents, of: storeID, day: day)
+        }
+        let docIDs = byDay.values.flatMap { $0.map { $0.0 } }
+        let detached = try reportAggregates.detach(docIDs)
+        var failure: Error? = nil
+        _ = database.inTransaction {
+            do {
+                for docID in docIDs {
+                    try self.database.existingDocument(withID: docID)?.purgeDocument()
+                }
+                return true
+            } catch {
+                failure = error
+                return false
+            }
+        }
+        if let error = failure {
+            // Nothing purged, the documents contribute again as they did
+            reportAggregates.attach(detached)
+            throw DatabaseError.couldNotDeleteDocument(error: error)
+        }
+        try database.compact()
+        i("[Archive] Archived \(docIDs.count) documents of \(byDay.count) days in \(Int(Date().timeIntervalSince(start) * 1000))ms")
+        return docIDs.count
+    }
+
+    /// Scan the archived orders and transactions of a store.
+    ///
+    /// - Parameters:
+    ///   - storeID: The store.
+    ///   - fromDate: The first day.
+    ///   - toDate: The last day.
+    ///   - columns: The columns to read.
+    ///   - body: Called with each archived day.
+    func scan(archived storeID: String, fromDate: Date, toDate: Date, columns: [String], _ body: (ArchiveBatch) throws -> Void) rethrows {
+        try shiftArchive.scan(storeID, fromDate: fromDate, toDate: toDate, columns: columns, body)
+    }
+
+    // MARK: - Reading archived days
+
+    /// The rows of a report view for a store/day, the archived documents of the day mapped along
+    /// with the live ones queried, as the view would have them if nothing was purged.
+    ///
+    /// - Parameters:
+    ///   - view: The report view, its keys starting with [storeID, day].
+    ///   - storeID: The store.
+    ///   - day: The day.
+    ///   - prefix: The first elements of the keys of the rows.
+    /// - Returns: The rows ordered by key, `nil` if nothing of the day is archived, the view has them all then.
+    func rows(_ view: CBLView, archivedOf storeID: String, day: Date, prefix: [Any]) -> [ArchiveViewRow]? {
+        guard let map = view.mapBlock else { return nil }
+        var archived: [String: [String: Any]] = [:]
+        scan(archived: storeID, fromDate: day, toDate: day, columns: ["doc_id", "document"]) { batch in
+            for (docID, json) in zip(batch.strings("doc_id"), batch.strings("document")) {
+                archived[docID] = (try? JSONSerialization.jsonObject(with: Data(json.utf8))) as? [String: Any]
+            }
+        }
+        // Not purged, the live document is the latest
+        archived = archived.filter { docID, _ in database.existingDocument(withID: docID) == nil }
+        guard archived.isNotEmpty else { return nil }
+
+        var rows: [ArchiveViewRow] = []
+        let query = view.createQuery()
+        query.startKey = prefix
+        query.endKey = prefix + [[:]]
+        query.mapOnly = true
+        query.prefetch = true
+        do {
+            for r in try query.run() {
+                guard let row = r as? CBLQueryRow, let key = row.key as? [Any] else { continue }
+                rows.append((key: key, value: row.value, properties: row.documentProperties ?? [:]))
+            }
+        } catch {
+            e("[Archive] Could not run query \(view.name): \(error)")
+        }
+        for properties in archived.values {
+            map(properties) { key, value in
+                guard let key = key as? [Any], key.count >= prefix.count,
+                    CouchbaseDatabase.collate(Array(key.prefix(prefix.count)), prefix) == .orderedSame else { return }
+                rows.append((key: key, value: value, properties: properties))
+            }
+        }
+        return rows.sorted { CouchbaseDatabase.collate($0.key, $1.key) == .orderedAscending }
+    }
+
+    /// Reduce rows with the reduce block of their view, grouped on the first `level` key elements
+    /// the same way a view query with `groupLevel` would.
+    ///
+    /// - Parameters:
+    ///   - rows: The rows ordered by key.
+    ///   - view: The view of the rows.
+    ///   - level: The number of key elements to group on, 0 for a single summary row.
+    /// - Returns: The grouped rows.
+    func reduce(_ rows: [ArchiveViewRow], of view: CBLView, level: Int) -> [(key: [Any], value: [String: Any])] {
+        guard let reduce = view.reduceBlock else { return [] }
+        var groups: [(key: [Any], rows: [ArchiveViewRow])] = []
+        for row in rows {
+            let key = Array(row.key.prefix(level))
+            if let last = groups.last, CouchbaseDatabase.collate(last.key, key) == .orderedSame {
+                groups[groups.count - 1].rows.append(row)
+            } else {
+                groups.append((key: key, rows: [row]))
+            }
+        }
+        return groups.map { group in
+            let value = reduce(group.rows.map { $0.key }, group.rows.map { $0.value ?? NSNull() }, false)
+            return (key: group.key, value: (value as? [String: Any]) ?? [:])
+        }
+    }
+
+    /// A page of rows, the same way a view query with `limit` and `skip` would.
+    ///
+    /// - Parameters:
+    ///   - rows: The rows.
+    ///   - page: The page, from 1, 0 for the first one.
+    ///   - pageSize: The page size, 0 for all the rows.
+    /// - Returns: The rows of the page.
+    func page(_ rows: [ArchiveViewRow], page: UInt, pageSize: UInt) -> [ArchiveViewRow] {
+        let skipped = page > 0 ? rows.dropFirst(Int((page - 1) * pageSize)) : rows[...]
+        return pageSize > 0 ? Array(skipped.prefix(Int(pageSize))) : Array(skipped)
+    }
+
+    /// Collate keys the way views do for the strings and numbers they contain.
+    fileprivate static func collate(_ lhs: [Any], _ rhs: [Any]) -> ComparisonResult {
+        for (l, r) in zip(lhs, rhs) {
+            let result: ComparisonResult
+            if let l = l as? NSNumber, let r = r as? NSNumber {
+                result = l.compare(r)
+            } else {
+                result = "\(l)".compare("\(r)")
+            }
+            if result != .orderedSame {
+                return result
+            }
+        }
+        return lhs.count == rhs.count ? .orderedSame : (lhs.count < rhs.count ? .orderedAscending : .orderedDescending)
+    }
+}
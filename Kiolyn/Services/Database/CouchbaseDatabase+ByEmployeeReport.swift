@@ -28,7 +28,7 @@ extension CouchbaseDatabase {
     /// Generate the Shift/Server related orders view Map block.
     ///
     /// - Returns: The `CBLMapBlock`.
-    private func orderShiftServerMap(with keys: @escaping (String, String, Int, String) -> [Any] = { [$0, $1, $2, $3] }) -> CBLMapBlock {
+    func orderShiftServerMap(with keys: @escaping (String, String, Int, String) -> [Any] = { [$0, $1, $2, $3] }) -> CBLMapBlock {
         return { (doc, emit) in
             guard doc["deleted"] == nil,
                 let type = doc["type"] as? String, type == Order.documentType,
@@ -61,55 +61,6 @@ extension CouchbaseDatabase {
         }
     }
     
-    /// Group orders by store/shift/status
-    var orderByShiftServerView: CBLView {
-        // Get/Create view
-        let view = database.viewNamed("order_by_shift_server")
-        view.setMapBlock(
-            orderShiftServerMap(),
-            reduce: { (keys, values, rereduce) in
-                guard let values = values as? [[String: Any]] else {
-                    return [:]
-                }
-                let fields = [
-                    ("total", DSum),
-                    ("tip", DSum),
-                    ("tax", DSum),
-                    ("discount", DSum),
-                    ("service_fee", DSum),
-                    ("service_fee_tax", DSum),
-                    ("guests", ISum),
-                    ("opening", ISum),
-                    ("closing", ISum)
-                ]
-                var reduced = values.sum(fields: fields)
-                reduced["count"] = values.count
-                
-                let shifts = keys.map { key -> Int in
-                    guard let key = key as? [Any], let shift = key[2] as? Int else {
-                        return 0
-                    }
-                    return shift
-                }
-                reduced["shifts"] = shifts.unique().sorted()
-                
-                let servers = keys.map { key -> String in
-                    guard let key = key as? [Any], let server = key[3] as? String else {
-                        return ""
-                    }
-                    return server
-                }
-                reduced["servers"] = servers.unique()
-                
-                if let first = values.first {
-                    reduced["name"] = (first["name"] as? String) ?? ""
-                }
-                
-                return reduced
-        }, version: CouchbaseDatabase.VERSION)
-        return view
-    }
-    
     /// Group orders by store/shift/status
     var orderByServerShiftView: CBLView {
         // Get/Create view
@@ -141,25 +92,14 @@ extension CouchbaseDatabase {
             return ReportQueryResult()
         }
         
-        let query = orderByShiftServerView.createQuery()
-        
-        let fdate = fromDate.toString("yyMMdd")
-        //        let tdate = toDate.toString("yyMMdd")
-        if shift > 0 {
-            query.startKey = [storeID, fdate, shift]
-            query.endKey = [storeID, fdate, shift, [:]]
-        } else {
-            query.startKey = [storeID, fdate]
-            query.endKey = [storeID, fdate, [:], [:]]
-        }
+        // Single day report
+        let aggregated = reportAggregates.rows(.employee, of: storeID, fromDate: fromDate, toDate: fromDate, shift: shift)
         // Query the Summary
-        query.groupLevel = 0
-        guard let summaryDict = query.loadDict() else {
+        guard let summaryDict = ReportAggregates.reduce(aggregated, level: 0, servers: true).first?.value else {
             return ReportQueryResult()
         }
         // Run the grouped query
-        query.groupLevel = 4
-        let rows = query.loadMulti().map { (key, value) -> EmployeeTotalReportRow in
+        let rows = ReportAggregates.reduce(aggregated, level: 4).map { (key, value) -> EmployeeTotalReportRow in
             var nvalue = value
             nvalue["shift"] = key[2] as! Int
             return EmployeeTotalReportRow(JSON: nvalue)!
@@ -172,28 +112,17 @@ extension CouchbaseDatabase {
     func load(byEmployeeReport storeID: String, fromDate: Date, toDate: Date, groupedBy shift: Int) -> [GroupedByShiftQueryResult<EmployeeTotalReportRow>] {
         guard storeID.isNotEmpty else { return [] }
         
-        let query = orderByShiftServerView.createQuery()
-        
-        let fdate = fromDate.toString("yyMMdd")
-        //        let tdate = toDate.toString("yyMMdd")
-        if shift > 0 {
-            query.startKey = [storeID, fdate, shift]
-            query.endKey = [storeID, fdate, shift, [:]]
-        } else {
-            query.startKey = [storeID, fdate]
-            query.endKey = [storeID, fdate, [:], [:]]
-        }
+        // Single day report
+        let aggregated = reportAggregates.rows(.employee, of: storeID, fromDate: fromDate, toDate: fromDate, shift: shift)
         // Query the detail first
-        query.groupLevel = 4
-        let rows = query.loadMulti().map { (key, value) -> EmployeeTotalReportRow in
+        let rows = ReportAggregates.reduce(aggregated, level: 4).map { (key, value) -> EmployeeTotalReportRow in
             var nvalue = value
             nvalue["shift"] = key[2] as! Int
             nvalue["created_by"] = key[3] as! String
             return EmployeeTotalReportRow(JSON: nvalue)!
         }
         // ... then the summary for each shift
-        query.groupLevel = 3
-        return query.loadMulti()
+        return ReportAggregates.reduce(aggregated, level: 3, servers: true)
             .map { (key, value) -> GroupedByShiftQueryResult<EmployeeTotalReportRow> in
                 let kshift = key[2] as! Int
                 let shiftRows = rows.filter { $0.shift == kshift }
@@ -217,16 +146,29 @@ extension CouchbaseDatabase {
             query.startKey = [storeID, fdate, emp]
             query.endKey = [storeID, fdate, emp, [:]]
         }
-        // Query the Summary
-        guard let summaryDict = query.loadDict() else {
-            return QueryResult()
+        let summaryDict: [String: Any]
+        let orders: [Order]
+        let prefix: [Any] = shift > 0 ? [storeID, fdate, emp, shift] : [storeID, fdate, emp]
+        if let archived = rows(orderByServerShiftView, archivedOf: storeID, day: fromDate, prefix: prefix) {
+            // Archived day, the purged orders are read from the archive
+            guard let archivedSummary = reduce(archived, of: orderByServerShiftView, level: 0).first?.value else {
+                return QueryResult()
+            }
+            summaryDict = archivedSummary
+            orders = self.page(archived, page: page, pageSize: pageSize).map { row in Order.decoded(row.properties) }
+        } else {
+            // Query the Summary
+            guard let liveSummary = query.loadDict() else {
+                return QueryResult()
+            }
+            summaryDict = liveSummary
+            // Run the detail query
+            query.mapOnly = true
+            query.prefetch = true
+            if pageSize > 0 { query.limit = pageSize }
+            if page > 0 { query.skip = (page - 1) * pageSize }
+            orders = query.loadModels()
         }
-        // Run the detail query
-        query.mapOnly = true
-        query.prefetch = true
-        if pageSize > 0 { query.limit = pageSize }
-        if page > 0 { query.skip = (page - 1) * pageSize }
-        let orders: [Order] = query.loadModels()
         var summary = summaryDict
         summary["row_count"] = orders.count
         return QueryResult(rows: orders, summary: QuerySummary(JSON: summary)!)
@@ -244,13 +186,23 @@ extension CouchbaseDatabase {
             query.startKey = [storeID, fdate, employee]
             query.endKey = [storeID, fdate, employee, [:]]
         }
-        // Query the detail first
-        query.mapOnly = true
-        query.prefetch = true
-        let rows: [Order] = query.loadModels()
-        // ... then the summary for each shift
-        query.groupLevel = 4
-        return query.loadMulti()
+        let rows: [Order]
+        let grouped: [(key: [Any], value: [String: Any])]
+        let prefix: [Any] = shift > 0 ? [storeID, fdate, employee, shift] : [storeID, fdate, employee]
+        if let archived = self.rows(orderByServerShiftView, archivedOf: storeID, day: fromDate, prefix: prefix) {
+            // Archived day, the purged orders are read from the archive
+            rows = archived.map { row in Order.decoded(row.properties) }
+            grouped = reduce(archived, of: orderByServerShiftView, level: 4)
+        } else {
+            // Query the detail first
+            query.mapOnly = true
+            query.prefetch = true
+            rows = query.loadModels()
+            // ... then the summary for each shift
+            query.groupLevel = 4
+            grouped = query.loadMulti()
+        }
+        return grouped
             .map { (key, value) -> GroupedByShiftQueryResult<Order> in
                 let kshift = key[3] as! Int
                 let shiftRows = rows.filter { Int($0.shift) == kshift }
@@ -44,24 +44,10 @@ extension CouchbaseDatabase {
             return QuerySummary()
         }
         
-        let query = orderByShiftServerView.createQuery()
-        let fdate = fromDate.toString("yyMMdd")
-        let tdate = toDate.toString("yyMMdd")
-        if fdate == tdate && shift > 0 {
-            query.startKey = [storeID, fdate, shift]
-            query.endKey = [storeID, fdate, shift, [:]]
-        } else {
-            query.startKey = [storeID, fdate]
-            query.endKey = [storeID, tdate, [:], [:]]
-        }
-        
-        do {
-            if let summary = try query.run().nextRow()?.value as? [String:Any],
-                let querySummary = QuerySummary(JSON: summary) {
-                return querySummary
-            }
-        } catch {
-            e(error)
+        let aggregated = load(reportRows: .employee, of: storeID, fromDate: fromDate, toDate: toDate, shift: shift)
+        if let summary = ReportAggregates.reduce(aggregated, level: 0, servers: true).first?.value,
+            let querySummary = QuerySummary(JSON: summary) {
+            return querySummary
         }
         return QuerySummary()
     }
@@ -94,26 +94,14 @@ extension CouchbaseDatabase {
     func load(byPaymentTypeReport storeID: String, fromDate: Date, toDate: Date, shift: Int, includeCardType: Bool) -> ReportQueryResult<PaymentTypeTotalReportRow> {
         guard storeID.isNotEmpty else { return ReportQueryResult() }
         
-        let query = transactionByTypeView.createQuery()
-        
-        let fdate = fromDate.toString("yyMMdd")
-        let tdate = toDate.toString("yyMMdd")
-        if fdate == tdate && shift > 0 {
-            query.startKey = [storeID, fdate, shift]
-            query.endKey = [storeID, fdate, shift, [:]]
-        } else {
-            query.startKey = [storeID, fdate]
-            query.endKey = [storeID, tdate, [:], [:]]
-        }
+        let aggregated = load(reportRows: .paymentType, of: storeID, fromDate: fromDate, toDate: toDate, shift: shift)
         
         // Query the Summary
-        query.groupLevel = 0
-        guard let summaryDict = query.loadDict() else {
+        guard let summaryDict = ReportAggregates.reduce(aggregated, level: 0).first?.value else {
             return ReportQueryResult()
         }
         // Run the grouped query
-        query.groupLevel = includeCardType ? 5 : 4
-        let rows = query.loadMulti().map { (key, value) -> PaymentTypeTotalReportRow in
+        let rows = ReportAggregates.reduce(aggregated, level: includeCardType ? 5 : 4).map { (key, value) -> PaymentTypeTotalReportRow in
             var nvalue = value
             nvalue["shift"] = key[2] as! Int
             nvalue["trans_type"] = key[3] as! String
@@ -130,21 +118,10 @@ extension CouchbaseDatabase {
     func load(byPaymentTypeReport storeID: String, fromDate: Date, toDate: Date, groupedBy shift: Int) -> [GroupedByShiftQueryResult<PaymentTypeTotalReportRow>] {
         guard storeID.isNotEmpty else { return [] }
         
-        let query = transactionByTypeView.createQuery()
-        
-        let fdate = fromDate.toString("yyMMdd")
-        let tdate = toDate.toString("yyMMdd")
-        if fdate == tdate && shift > 0 {
-            query.startKey = [storeID, fdate, shift]
-            query.endKey = [storeID, fdate, shift, [:]]
-        } else {
-            query.startKey = [storeID, fdate]
-            query.endKey = [storeID, tdate, [:], [:]]
-        }
+        let aggregated = load(reportRows: .paymentType, of: storeID, fromDate: fromDate, toDate: toDate, shift: shift)
         
         // Query the detail first
-        query.groupLevel = 5
-        let rows = query.loadMulti().map { (key, value) -> PaymentTypeTotalReportRow in
+        let rows = ReportAggregates.reduce(aggregated, level: 5).map { (key, value) -> PaymentTypeTotalReportRow in
             var nvalue = value
             nvalue["shift"] = key[2] as! Int
             nvalue["trans_type"] = key[3] as! String
@@ -152,8 +129,7 @@ extension CouchbaseDatabase {
             return PaymentTypeTotalReportRow(JSON: nvalue)!
         }
         // ... then the summary for each shift
-        query.groupLevel = 3
-        return query.loadMulti().map { (key, value) -> GroupedByShiftQueryResult<PaymentTypeTotalReportRow> in
+        return ReportAggregates.reduce(aggregated, level: 3).map { (key, value) -> GroupedByShiftQueryResult<PaymentTypeTotalReportRow> in
             let kshift = key[2] as! Int
             let shiftRows = rows.filter { $0.shift == kshift }
             let summary = QuerySummary(JSON: value)!
@@ -164,25 +140,14 @@ extension CouchbaseDatabase {
     func load(byAreaReport storeID: String, fromDate: Date, toDate: Date, shift: Int) -> ReportQueryResult<AreaTotalReportRow> {
         guard storeID.isNotEmpty else { return ReportQueryResult() }
         
-        let query = orderByShiftAreaDriverView.createQuery()
+        let aggregated = load(reportRows: .area, of: storeID, fromDate: fromDate, toDate: toDate, shift: shift)
         
-        let fdate = fromDate.toString("yyMMdd")
-        let tdate = toDate.toString("yyMMdd")
-        if fdate == tdate && shift > 0 {
-            query.startKey = [storeID, fdate, shift]
-            query.endKey = [storeID, fdate, shift, [:], [:]]
-        } else {
-            query.startKey = [storeID, fdate]
-            query.endKey = [storeID, tdate, [:], [:], [:]]
-        }
         // Query the Summary
-        query.groupLevel = 0
-        guard let summaryDict = query.loadDict() else {
+        guard let summaryDict = ReportAggregates.reduce(aggregated, level: 0).first?.value else {
             return ReportQueryResult()
         }
         // Run the grouped query
-        query.groupLevel = 5
-        let rows = query.loadMulti().map { (key, value) -> AreaTotalReportRow in
+        let rows = ReportAggregates.reduce(aggregated, level: 5).map { (key, value) -> AreaTotalReportRow in
             var nvalue = value
             nvalue["shift"] = key[2] as! Int
             nvalue["area"] = key[3] as! String
@@ -197,20 +162,10 @@ extension CouchbaseDatabase {
     func load(byAreaReport storeID: String, fromDate: Date, toDate: Date, groupedBy shift: Int) -> [GroupedByShiftQueryResult<AreaTotalReportRow>] {
         guard storeID.isNotEmpty else { return [] }
         
-        let query = orderByShiftAreaDriverView.createQuery()
+        let aggregated = load(reportRows: .area, of: storeID, fromDate: fromDate, toDate: toDate, shift: shift)
         
-        let fdate = fromDate.toString("yyMMdd")
-        let tdate = toDate.toString("yyMMdd")
-        if fdate == tdate && shift > 0 {
-            query.startKey = [storeID, fdate, shift]
-            query.endKey = [storeID, fdate, shift, [:], [:]]
-        } else {
-            query.startKey = [storeID, fdate]
-            query.endKey = [storeID, tdate, [:], [:], [:]]
-        }
         // Query the detail first
-        query.groupLevel = 5
-        let rows = query.loadMulti().map { (key, value) -> AreaTotalReportRow in
+        let rows = ReportAggregates.reduce(aggregated, level: 5).map { (key, value) -> AreaTotalReportRow in
             var nvalue = value
             nvalue["shift"] = key[2] as! Int
             nvalue["area"] = key[3] as! String
@@ -218,8 +173,7 @@ extension CouchbaseDatabase {
             return AreaTotalReportRow(JSON: nvalue)!
         }
         // ... then the summary for each shift
-        query.groupLevel = 3
-        return query.loadMulti().map { (key, value) -> GroupedByShiftQueryResult<AreaTotalReportRow> in
+        return ReportAggregates.reduce(aggregated, level: 3).map { (key, value) -> GroupedByShiftQueryResult<AreaTotalReportRow> in
             let kshift = key[2] as! Int
             let shiftRows = rows.filter { $0.shift == kshift }
             let summary = QuerySummary(JSON: value)!
@@ -0,0 +1,76 @@
+//
+//  CouchbaseDatabase+Changes.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 9/6/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+// MARK: - Changes for Subs
+extension CouchbaseDatabase {
+    
+    var lastSequence: UInt64 {
+        return database.lastSequenceNumber
+    }
+    
+    func loadProperties(orderChanges storeID: String, forShift shiftID: String, since: UInt64, revisions: [String: String]) -> [String: Any] {
+        guard storeID.isNotEmpty, shiftID.isNotEmpty else {
+            return [:]
+        }
+        // Following changes from now on, before getting the last sequence
+        let feed = changeFeed
+        let last = database.lastSequenceNumber
+        guard since > 0, since <= last, let changes = feed.changes(since: since, prefix: "\(Order.documentIDPrefix)_") else {
+            // Changes are not known, start over with all the orders
+            let documents = openOrders.documents(storeID, forShift: shiftID)
+            return [
+                "last_seq": NSNumber(value: last),
+                "reset": true,
+                "changes": documents.map { (docID, properties) in ["id": docID, "doc": properties] }
+            ]
+        }
+        var result: [[String: Any]] = []
+        for change in changes {
+            guard let properties = change.properties,
+                OpenOrdersIndex.indexes(properties, of: storeID, forShift: shiftID) else {
+                    // Deleted, voided or moved out of the shift
+                    if revisions[change.docID] != nil {
+                        result.append(["id": change.docID, "deleted": true])
+                    }
+                    continue
+            }
+            let base = revisions[change.docID]
+            guard base == nil || base != properties["_rev"] as? String else {
+                // Already held
+                continue
+            }
+            result.append(delta(change.docID, properties, from: base))
+        }
+        return ["last_seq": NSNumber(value: last), "reset": false, "changes": result]
+    }
+    
+    /// The change of a document from a revision, as a patch when the revision body is still
+    /// stored and the patch is smaller than the document.
+    ///
+    /// - Parameters:
+    ///   - docID: The document.
+    ///   - properties: The current properties.
+    ///   - base: The revision to patch from.
+    /// - Returns: The change with `id` and either `doc` or `base` and `patch`.
+    fileprivate func delta(_ docID: String, _ properties: [String: Any], from base: String?) -> [String: Any] {
+        let full: [String: Any] = ["id": docID, "doc": properties]
+        guard let base = base,
+            let original = database.existingDocument(withID: docID)?.revision(withID: base)?.properties else {
+                return full
+        }
+        let patch = JSONPatch.diff(original, properties)
+        let patchSize = (try? JSONSerialization.data(withJSONObject: patch).count) ?? Int.max
+        let fullSize = (try? JSONSerialization.data(withJSONObject: properties).count) ?? 0
+        guard patchSize < fullSize else {
+            return full
+        }
+        return ["id": docID, "base": base, "patch": patch]
+    }
+}
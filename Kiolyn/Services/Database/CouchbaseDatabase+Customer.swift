@@ -19,15 +19,26 @@ extension CouchbaseDatabase {
         return view
     }
 
-    func load(customers storeID: String, page: UInt, pageSize: UInt) -> QueryResult<Customer> {
+    /// Load a page of the customers of a store.
+    ///
+    /// - Parameters:
+    ///   - storeID: The store to load for.
+    ///   - page: The page number, starting from 1.
+    ///   - pageSize: The page size, 0 for all.
+    ///   - next: The continuation key returned with the previous page.
+    /// - Returns: The customers, summary and continuation key of the next page.
+    func load(customers storeID: String, page: UInt, pageSize: UInt, after next: String?) -> QueryResult<Customer> {
         guard storeID.isNotEmpty else {
             return QueryResult<Customer>()            
         }
+        let signature = QueryPager.signature(Customer.self, [storeID])
         
         // Summary
-        let summaryQuery = allCustomersView.createQuery()
-        summaryQuery.keys = [storeID]
-        let count = summaryQuery.loadInt()
+        let count = pager.count(signature) {
+            let summaryQuery = allCustomersView.createQuery()
+            summaryQuery.keys = [storeID]
+            return summaryQuery.loadInt()
+        }
         let summary = QuerySummary(count: count)
         
         // Total count is 0, no need to query for detail
@@ -35,15 +46,16 @@ extension CouchbaseDatabase {
             return QueryResult<Customer>()
         }
 
-        // Rows detail / Ordered by order no
+        // Rows detail / Ordered by document id
         let query = allCustomersView.createQuery()
-        query.keys = [storeID]
+        query.startKey = storeID
+        query.endKey = storeID
         query.mapOnly = true
         query.prefetch = true
-        if pageSize > 0 { query.limit = pageSize }
-        if page > 0 { query.skip = (page - 1) * pageSize }
-        let rows: [Customer] = query.loadModels()
-        return QueryResult(rows: rows, summary: summary)
+        let (rows, following) = pager.page(signature, of: query, page: page, pageSize: pageSize, after: next)
+        let result = QueryResult(rows: rows.compactMap { row -> Customer? in row.loadModel() }, summary: summary)
+        result.next = following
+        return result
     }
 
     func load(customers storeID: String, query: (String, String, String, String), limit: UInt) -> [Customer] {
@@ -51,41 +63,41 @@ extension CouchbaseDatabase {
             .map { properties in Customer(JSON: properties)! }
     }
     
+    /// Search customers of a store using `CustomerSearchIndex`.
+    ///
+    /// - Parameters:
+    ///   - storeID: The store to search in.
+    ///   - query: The (name, phone, email, address) to search for.
+    ///   - limit: Maximum number of customers to return.
+    /// - Returns: The customers properties ordered by name.
     func loadProperties(customers storeID: String, query: (String, String, String, String), limit: UInt) -> [[String: Any]] {
         guard storeID.isNotEmpty, limit > 0 else {
             return []
         }
-        var (name, phone, email, address) = query
+        let (name, phone, email, address) = query
         guard name.isNotEmpty || phone.isNotEmpty || email.isNotEmpty || address.isNotEmpty else {
             return []
         }
+        return customerSearch.properties(customers: storeID, query: query, limit: limit)
+    }
+    
+    /// Load documents id and properties of all the customers of a store, for `CustomerSearchIndex`.
+    ///
+    /// - Parameter storeID: The store to load for.
+    /// - Returns: The documents id and properties.
+    func loadDocuments(indexedCustomers storeID: String) -> [(String, [String: Any])] {
         let query = allCustomersView.createQuery()
-        query.prefetch = true
         query.mapOnly = true
+        query.prefetch = true
         query.keys = [storeID]
-        query.limit = limit
-        // It is too complicate thus we use post filter instead
-        name = name.lowercased()
-        phone = phone.lowercased()
-        email = email.lowercased()
-        address = address.lowercased()
-        query.postFilter = NSPredicate(block: { (r, _) -> Bool in
-            guard let row = r as? CBLQueryRow, let properties = row.documentProperties else { return false }
-            
-            if name.isNotEmpty {
-                guard let v = properties["name"] as? String, v.lowercased().hasPrefix(name) else { return false }
+        do {
+            return try query.run().compactMap { r -> (String, [String: Any])? in
+                guard let row = r as? CBLQueryRow, let docID = row.documentID, let properties = row.loadProperties() else { return nil }
+                return (docID, properties)
             }
-            if phone.isNotEmpty {
-                guard let v = properties["mobilephone"] as? String, v.lowercased().hasPrefix(phone) else { return false }
-            }
-            if email.isNotEmpty {
-                guard let v = properties["email"] as? String, v.lowercased().hasPrefix(email) else { return false }
-            }
-            if address.isNotEmpty {
-                guard let v = properties["address"] as? String, v.lowercased().hasPrefix(address) else { return false }
-            }
-            return true
-        })
-        return query.loadPropertiesList()
+        } catch {
+            e("Could not run query \(query.view?.name ?? ""): \(error)")
+            return []
+        }
     }
 }
@@ -26,6 +26,15 @@ extension CouchbaseDatabase {
     }
 
     func save(properties: [String: Any]) throws -> String {
+        return try save(document: try documentID(of: properties), properties: properties)
+    }
+    
+    /// Validate properties to be saved and get their document id.
+    ///
+    /// - Parameter properties: The properties to save.
+    /// - Returns: The document id.
+    /// - Throws: `DatabaseError.missingMeta` if the properties are not valid.
+    private func documentID(of properties: [String: Any]) throws -> String {
         guard let id = properties["id"]  as? String, id.isNotEmpty else {
             throw DatabaseError.missingMeta(field: "id")
         }
@@ -41,20 +50,25 @@ extension CouchbaseDatabase {
                 throw DatabaseError.missingMeta(field: "channels")
             }
         }
-        return try save(document: "\(prefix)_\(id)", properties: properties)
+        return "\(prefix)_\(id)"
     }
     
     func save(properties: [[String: Any]]) throws -> [String] {
-        var revisions: [String] = []
-        try runBatch {
-            revisions = try properties.map { p in
-                try self.save(properties: p)
-            }
-        }
-        return revisions
+        let batch = WriteBatch()
+        properties.forEach { batch.save(properties: $0) }
+        return try commit(batch).map { $0.revision }
     }
     
     func save(_ obj: BaseModel) throws {
+        _ = try save(model: obj)
+    }
+    
+    /// Save a model.
+    ///
+    /// - Parameter obj: The model to save.
+    /// - Returns: The document id and its new revision.
+    /// - Throws: `DatabaseError` if the model is not valid or could not be saved.
+    private func save(model obj: BaseModel) throws -> WriteResult {
         let objType = type(of: obj)
         d("Saving \(objType) \(obj)/\(obj.revision)")
         guard obj.id.isNotEmpty else {
@@ -71,7 +85,8 @@ extension CouchbaseDatabase {
                 throw DatabaseError.missingMeta(field: "channels")
             }
         }
-        _ = try save(document: "\(objType.documentIDPrefix)_\(obj.id)", properties: obj.toJSON())
+        let docID = "\(objType.documentIDPrefix)_\(obj.id)"
+        return (docID, try save(document: docID, properties: obj.toJSON()))
     }
     
     private func save(document docID: String, properties: [String: Any]) throws -> String {
@@ -96,11 +111,9 @@ extension CouchbaseDatabase {
     }
 
     func save(all objs: [BaseModel]) throws {
-        try runBatch {
-            for obj in objs {
-                try self.save(obj)
-            }
-        }
+        let batch = WriteBatch()
+        batch.save(all: objs)
+        _ = try commit(batch)
     }
 
     func load<T: BaseModel>(_ id: String) -> T? {
@@ -110,7 +123,7 @@ extension CouchbaseDatabase {
         }
         // Get the doc and create the model accordingly
         if let doc = load(document: "\(T.documentIDPrefix)_\(id)"), let properties = doc.properties {
-            return T(JSON: properties)
+            return T.decoded(properties)
         }
         return nil
     }
@@ -137,19 +150,29 @@ extension CouchbaseDatabase {
     
     func load<T:BaseModel>(all storeID: String, byName name: String) -> [T] {
         return loadProperties(all: storeID, for: T.self, byName: name)
-            .map { properties in T(JSON: properties) }
-            .filter { model in model != nil }
-            .map { model -> T in model! }
+            .map { properties in T.decoded(properties) }
     }
     
-    func loadProperties(all storeID: String, for type: BaseModel.Type, byName name: String) -> [[String: Any]] {
-        guard let map = type.allMapBlock, storeID.isNotEmpty else {
-            return []
+    /// Get/Create the view of all the documents of a type.
+    ///
+    /// - Parameter type: The document type.
+    /// - Returns: The view, `nil` if the type has no `allMapBlock`.
+    func allView(of type: BaseModel.Type) -> CBLView? {
+        guard let map = type.allMapBlock else {
+            return nil
         }
-        // Get/Create the all document view
         let view = database.viewNamed("all_\(type.documentType)")
         view.setMapBlock(map, version: CouchbaseDatabase.VERSION)
-        
+        return view
+    }
+    
+    func loadProperties(all storeID: String, for type: BaseModel.Type, byName name: String) -> [[String: Any]] {
+        guard storeID.isNotEmpty else {
+            return []
+        }
+        guard let view = allView(of: type) else {
+            return []
+        }
         let query = view.createQuery()
         query.keys = [ storeID ]
         query.mapOnly = true
@@ -185,9 +208,18 @@ extension CouchbaseDatabase {
     }
     
     func delete(_ docID: String) throws {
+        _ = try delete(document: docID)
+    }
+    
+    /// Delete a document.
+    ///
+    /// - Parameter docID: The document to delete.
+    /// - Returns: The revision of the deletion, `nil` if the document does not exist.
+    /// - Throws: `DatabaseError.couldNotDeleteDocument` if the document could not be deleted.
+    private func delete(document docID: String) throws -> String? {
         guard let doc = load(document: docID) else {
             d("Document not found for \(docID)")
-            return
+            return nil
         }
         d("Deleting \(doc.documentID)/\(doc.currentRevisionID ?? "")")
         doc.expirationDate = Calendar.current.date(byAdding: .day, value: 1, to: Date())
@@ -198,6 +230,7 @@ extension CouchbaseDatabase {
             throw DatabaseError.couldNotDeleteDocument(error: error)
         }
         d("Deleted \(doc.documentID)/\(doc.currentRevisionID ?? "") (truly deleted after 1 day)")
+        return doc.currentRevisionID
     }
 
     func delete<T: BaseModel>(_ obj: T) throws {
@@ -205,9 +238,9 @@ extension CouchbaseDatabase {
     }
     
     func delete<T: BaseModel>(multi objs: [T]) throws {
-        for obj in objs {
-            try delete(obj)
-        }
+        let batch = WriteBatch()
+        batch.delete(multi: objs)
+        _ = try commit(batch)
     }
 
     func runBatch(_ block: @escaping () throws -> Void) throws {
@@ -223,5 +256,28 @@ extension CouchbaseDatabase {
         }
         // throw error if any
         if let error = lastError { throw error }
-    }    
+    }
+    
+    func commit(_ batch: WriteBatch) throws -> [WriteResult] {
+        guard !batch.isEmpty else { return [] }
+        var results: [WriteResult] = []
+        // Database change observers get all the changes at once, when the transaction ends
+        try runBatch {
+            results = []
+            for operation in batch.operations {
+                switch operation {
+                case let .save(model):
+                    results.append(try self.save(model: model))
+                case let .saveProperties(properties):
+                    let docID = try self.documentID(of: properties)
+                    results.append((docID, try self.save(document: docID, properties: properties)))
+                case let .delete(docID):
+                    if let revision = try self.delete(document: docID) {
+                        results.append((docID, revision))
+                    }
+                }
+            }
+        }
+        return results
+    }
 }
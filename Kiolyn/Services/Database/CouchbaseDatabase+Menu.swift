@@ -7,6 +7,7 @@
 //
 
 import Foundation
+import RxSwift
 
 // MARK: - Menu (Categories/Items/Modifiers)
 extension CouchbaseDatabase {
@@ -37,25 +38,74 @@ extension CouchbaseDatabase {
     
     func load(items storeID: String, forCategory category: String) -> [Item] {
         return self.loadProperties(items: storeID, forCategory: category)
-            .map { properties in Item(JSON: properties)! }
+            .map { properties in Item.decoded(properties) }
     }
     
     func loadProperties(items storeID: String, forCategory category: String) -> [[String: Any]] {
         guard storeID.isNotEmpty, category.isNotEmpty else {
             return []
         }
+        return load(menu: storeID).properties(items: category)
+    }
+    
+    func load(menu storeID: String) -> MenuSnapshot {
+        return menu.snapshot(storeID)
+    }
+    
+    func cached(menu storeID: String) -> MenuSnapshot? {
+        return menu.cached(storeID)
+    }
+    
+    var menuChanged: Observable<UInt64> {
+        return menu.changed
+    }
+    
+    /// Query the menu of a store from views, without `MenuCache`.
+    ///
+    /// - Parameter storeID: The store to load for.
+    /// - Returns: The menu.
+    func loadSnapshot(menu storeID: String) -> MenuSnapshot {
+        let checkpoint = database.lastSequenceNumber
         let query = itemByCategoryView.createQuery()
-        query.keys = [ [storeID, category] ]
+        query.startKey = [storeID]
+        query.endKey = [storeID, [:]]
         query.mapOnly = true
         query.prefetch = true
-        return query.loadPropertiesList()
+        var items: [(String, [String: Any])] = []
+        do {
+            items = try query.run().compactMap { r -> (String, [String: Any])? in
+                guard let row = r as? CBLQueryRow,
+                    let category = (row.key as? [Any])?.last as? String,
+                    let properties = row.loadProperties() else { return nil }
+                return (category, properties)
+            }
+        } catch {
+            e("Could not run query \(query.view?.name ?? ""): \(error)")
+        }
+        var modifiers: [[String: Any]] = []
+        if let view = allView(of: Modifier.self) {
+            let query = view.createQuery()
+            query.keys = [storeID]
+            query.mapOnly = true
+            query.prefetch = true
+            modifiers = query.loadPropertiesList()
+        }
+        return MenuSnapshot(storeID: storeID, checkpoint: checkpoint, items: items, modifiers: modifiers)
     }
     
     func load(modifiers itemID: String) -> [Modifier] {
+        // From the cached menus first
+        if let modifiers = menu.cached(modifiers: itemID) {
+            return modifiers
+        }
         // Load the item first
         guard let item: Item = load(itemID) else {
             return []
         }
+        // ... then its store menu, hidden items are not in menus
+        if let modifiers = load(menu: item.hasStoreID ? item.storeID : item.merchantID).load(modifiers: itemID) {
+            return modifiers
+        }
         return item.modifiers
             .map { ref -> Modifier? in
                 guard let modifier: Modifier = self.load(ref.id) else {
@@ -78,36 +128,13 @@ extension CouchbaseDatabase {
     
     func load(globalModifiers storeID: String) -> [Modifier] {
         return loadProperties(globalModifiers: storeID)
-            .map { properties in Modifier(JSON: properties)! }
+            .map { properties in Modifier.decoded(properties) }
     }
     
     func loadProperties(globalModifiers storeID: String) -> [[String: Any]] {
         guard storeID.isNotEmpty else {
             return []
         }
-        
-        let view = database.viewNamed("all_\(Modifier.documentType)")
-        view.setMapBlock(Modifier.allMapBlock!, version: CouchbaseDatabase.VERSION)
-
-        let query = view.createQuery()
-        query.keys = [storeID]
-        query.mapOnly = true
-        query.prefetch = true
-        query.postFilter = NSPredicate { (row, _) -> Bool in
-            // make sure there is a returned row
-            guard let row = row as? CBLQueryRow,
-                // ... with properties
-                let properties = row.documentProperties,
-                // ... and is global
-                let global = properties["global"] as? Bool,
-                // ... and having options
-                let options = properties["options"] as? [[String: Any]]
-                else {
-                    return false
-            }
-            return global && options.isNotEmpty
-
-        }
-        return query.loadPropertiesList()
+        return load(menu: storeID).globalModifiers
     }
 }
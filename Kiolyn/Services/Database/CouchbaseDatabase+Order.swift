@@ -55,11 +55,35 @@ extension CouchbaseDatabase {
         return view
     }
     
-    /// Group orders by store/shift/status
-    var orderByShiftAreaDriverView: CBLView {
+    /// Index orders by store/shift/area/status/delivered, so that an area reads only its own orders
+    var orderByAreaStatusView: CBLView {
         // Get/Create view
-        let view = database.viewNamed("order_by_shift_area_driver")
-        view.setMapBlock({ (doc, emit) in
+        let view = database.viewNamed("order_by_area_status")
+        view.setMapBlock(
+            { (doc, emit) in
+                // Make sure good inputs
+                guard doc["deleted"] == nil,
+                    let type = doc["type"] as? String, type == Order.documentType,
+                    let id = doc["id"] as? String, id.count > 6 ,
+                    let merchantID = doc["merchantid"] as? String, merchantID.isNotEmpty,
+                    let status = doc["status"] as? String, status.isNotEmpty,
+                    let shiftID = doc["shift_id"] as? String, shiftID.isNotEmpty else {
+                        return
+                }
+                // User storeid (new Store) or merchantid (old Store)
+                let storeID = (doc["storeid"] as? String) ?? merchantID
+                let area = (doc["area"] as? String) ?? ""
+                let delivered = (doc["delivered"] as? Bool) ?? false
+                emit([storeID, shiftID, area, status, delivered], nil)
+        }, version: CouchbaseDatabase.VERSION)
+        return view
+    }
+    
+    /// Generate the Shift/Area/Driver related orders view Map block.
+    ///
+    /// - Returns: The `CBLMapBlock`.
+    func orderShiftAreaDriverMap() -> CBLMapBlock {
+        return { (doc, emit) in
             guard doc["deleted"] == nil,
                 let type = doc["type"] as? String, type == Order.documentType,
                 let id = doc["id"] as? String, id.count > 6 ,
@@ -87,101 +111,85 @@ extension CouchbaseDatabase {
             reduced["driver_name"] = doc["driver_name"] as? String
             reduced["delivery"] = doc["delivery"] as? Bool
             emit([storeID, id[0...5], shift, area, (doc["driver"] as? String ?? BaseModel.idEmpty)], reduced)
-        }, reduce: { (keys, values, rereduce) in
-            guard let values = values as? [[String: Any]] else {
-                return [:]
-            }
-            let fields = [
-                ("total", DSum),
-                ("tip", DSum),
-                ("tax", DSum),
-                ("discount", DSum),
-                ("service_fee", DSum),
-                ("service_fee_tax", DSum),
-                ("guests", ISum)
-            ]
-            var reduced = values.sum(fields: fields)
-            reduced["count"] = values.count
-            
-            let shifts = keys.map { key -> Int in
-                guard let key = key as? [Any], let shift = key[2] as? Int else {
-                    return 0
-                }
-                return shift
-            }
-            reduced["shifts"] = shifts.unique().sorted()
-            
-            if let first = values.first {
-                reduced["area_name"] = first["area_name"] as? String
-                reduced["driver_name"] = first["driver_name"] as? String
-                reduced["delivery"] = first["delivery"] as? Bool
-            }
-            
-            return reduced
-        }, version: CouchbaseDatabase.VERSION )
-        return view
+        }
     }
     
     func load(openingOrders storeID: String, forShift shiftID: String, inArea area: Area?, withFilter filter: String) -> [Order] {
        return loadProperties(openingOrders: storeID, forShift: shiftID, inArea: area, withFilter: filter)
-            .map { properties in Order(JSON: properties)! }
+            .map { properties in Order.decoded(properties) }
     }
     
     func loadProperties(openingOrders storeID: String, forShift shiftID: String, inArea area: Area?, withFilter filter: String) -> [[String: Any]] {
         guard storeID.isNotEmpty, shiftID.isNotEmpty else {
             return []
         }
+        return openOrders.properties(openingOrders: storeID, forShift: shiftID, inArea: area, withFilter: filter)
+    }
+    
+    /// Load the not voided orders of a shift for building `OpenOrdersIndex`.
+    ///
+    /// - Parameters:
+    ///   - storeID: The store to load for.
+    ///   - shiftID: The shift to load for.
+    /// - Returns: Document ids and properties.
+    func loadDocuments(indexedOrders storeID: String, forShift shiftID: String) -> [(String, [String: Any])] {
         let query = orderByOrderStatusView.createQuery()
         query.mapOnly = true
         query.prefetch = true
-        query.startKey = [storeID, shiftID]
-        query.endKey = [storeID, shiftID, [:]]
-        
-        if let area = area {
-            if area.isDelivery {
-                // Delivery area will consider the filter value
-                query.postFilter = NSPredicate { (row, _) -> Bool in
-                    guard let row = row as? CBLQueryRow,
-                        let status = row.key2 as? String,
-                        status != OrderStatus.voided.rawValue,
-                        let properties = row.documentProperties,
-                        let orderArea = properties["area"] as? String,
-                        orderArea == area.id
-                        else { return false }
-                    if filter == "ALL" {
-                        return true
-                    } else {
-                        let delivered = properties["delivered"] as? Bool ?? false
-                        if filter == "DELIVERED" { return delivered }
-                        else if filter == "PENDING" { return !delivered }
-                    }
-                    return false
-                }
-            } else {
-                // Other areas just return the order in given area
-                query.postFilter = NSPredicate { (row, _) -> Bool in
-                    guard let row = row as? CBLQueryRow,
-                        let status = row.key2 as? String,
-                        status != OrderStatus.checked.rawValue,
-                        status != OrderStatus.voided.rawValue,
-                        let properties = row.documentProperties,
-                        let orderArea = properties["area"] as? String,
-                        orderArea == area.id
-                        else { return false }
-                    return true
-                }
+        query.keys = [OrderStatus.new, .printed, .submitted, .checked].map { [storeID, shiftID, $0.rawValue] }
+        do {
+            return try query.run().compactMap { r -> (String, [String: Any])? in
+                guard let row = r as? CBLQueryRow, let docID = row.documentID, let properties = row.loadProperties() else { return nil }
+                return (docID, properties)
             }
-        } else {
+        } catch {
+            e("Could not run query \(query.view?.name ?? ""): \(error)")
+            return []
+        }
+    }
+    
+    /// Query opening orders from views, without `OpenOrdersIndex`.
+    ///
+    /// - Parameters:
+    ///   - storeID: The store to load for.
+    ///   - shiftID: The shift to load for.
+    ///   - area: The area, `nil` for all areas.
+    ///   - filter: The delivered filter for delivery area.
+    /// - Returns: The orders properties.
+    func queryProperties(openingOrders storeID: String, forShift shiftID: String, inArea area: Area?, withFilter filter: String) -> [[String: Any]] {
+        guard storeID.isNotEmpty, shiftID.isNotEmpty else {
+            return []
+        }
+        // Opening orders are the ones neither checked nor voided
+        let opening: [OrderStatus] = [.new, .printed, .submitted]
+        guard let area = area else {
             // If no specific area is request, return all opening orders
-            query.postFilter = NSPredicate { (row, _) -> Bool in
-                guard let row = row as? CBLQueryRow,
-                    let status = row.key2 as? String,
-                    status != OrderStatus.checked.rawValue,
-                    status != OrderStatus.voided.rawValue
-                    else { return false }
-                return true
+            let query = orderByOrderStatusView.createQuery()
+            query.mapOnly = true
+            query.prefetch = true
+            query.keys = opening.map { [storeID, shiftID, $0.rawValue] }
+            return query.loadPropertiesList()
+        }
+        // Only the rows of the given area are read
+        var statuses = opening
+        var delivered = [false, true]
+        if area.isDelivery {
+            // Delivery area will consider the filter value, checked orders included
+            statuses.append(.checked)
+            switch filter {
+            case "ALL": break
+            case "DELIVERED": delivered = [true]
+            case "PENDING": delivered = [false]
+            default: return []
             }
         }
+        let query = orderByAreaStatusView.createQuery()
+        query.mapOnly = true
+        query.prefetch = true
+        query.keys = statuses
+            .map { $0.rawValue }
+            .sorted()
+            .flatMap { status in delivered.map { [storeID, shiftID, area.id, status, $0] as [Any] } }
         return query.loadPropertiesList()
     }
     
@@ -217,23 +225,40 @@ extension CouchbaseDatabase {
         }
     }
     
-    func load(orders storeID: String, forShift shiftID: String, matchingStatuses statuses: [OrderStatus], page: UInt, pageSize: UInt) -> QueryResult<Order> {
-        return QueryResult<Order>(JSON: loadProperties(orders: storeID, forShift: shiftID, matchingStatuses: statuses, page: page, pageSize: pageSize))!
+    func load(orders storeID: String, forShift shiftID: String, matchingStatuses statuses: [OrderStatus], page: UInt, pageSize: UInt, after next: String?) -> QueryResult<Order> {
+        let properties = loadProperties(orders: storeID, forShift: shiftID, matchingStatuses: statuses, page: page, pageSize: pageSize, after: next)
+        let rows = ((properties["rows"] as? [[String: Any]]) ?? []).map { Order.decoded($0) }
+        let result = QueryResult(rows: rows, summary: QuerySummary(JSON: (properties["summary"] as? [String: Any]) ?? [:]) ?? QuerySummary(count: rows.count))
+        result.next = properties["next"] as? String
+        return result
     }
     
-    func loadProperties(orders storeID: String, forShift shiftID: String, matchingStatuses statuses: [OrderStatus], page: UInt, pageSize: UInt) -> [String: Any] {
+    /// Load a page of the orders of a shift, ordered by order no.
+    ///
+    /// - Parameters:
+    ///   - storeID: The store to load for.
+    ///   - shiftID: The shift to load for.
+    ///   - statuses: The statuses to load, empty for all.
+    ///   - page: The page number, starting from 1.
+    ///   - pageSize: The page size, 0 for all.
+    ///   - next: The continuation key returned with the previous page.
+    /// - Returns: The summary, rows and continuation key of the next page.
+    func loadProperties(orders storeID: String, forShift shiftID: String, matchingStatuses statuses: [OrderStatus], page: UInt, pageSize: UInt, after next: String?) -> [String: Any] {
         guard storeID.isNotEmpty, shiftID.isNotEmpty else {
             return [:]
         }
+        let signature = QueryPager.signature(Order.self, [storeID, shiftID] + statuses.map { $0.rawValue })
         // Summary
-        let summaryQuery = orderByOrderStatusView.createQuery()
-        if statuses.isEmpty {
-            summaryQuery.startKey = [storeID, shiftID]
-            summaryQuery.endKey = [storeID, shiftID, [:]]
-        } else {
-            summaryQuery.keys = statuses.map { [storeID, shiftID, $0.rawValue] }
+        let count = pager.count(signature) {
+            let summaryQuery = orderByOrderStatusView.createQuery()
+            if statuses.isEmpty {
+                summaryQuery.startKey = [storeID, shiftID]
+                summaryQuery.endKey = [storeID, shiftID, [:]]
+            } else {
+                summaryQuery.keys = statuses.map { [storeID, shiftID, $0.rawValue] }
+            }
+            return summaryQuery.loadInt()
         }
-        let count = summaryQuery.loadInt()
         let summary: [String: Any] = ["count": count]
         // Total count is 0, no need to query for detail
         guard count > 0 else {
@@ -246,13 +271,12 @@ extension CouchbaseDatabase {
         query.postFilter = postFilter(statuses: statuses)
         query.mapOnly = true
         query.prefetch = true
-        if pageSize > 0 { query.limit = pageSize }
-        if page > 0 { query.skip = (page - 1) * pageSize }
-        let rows = query.loadPropertiesList()
-        let queryResult: [String: Any] = [
+        let (rows, following) = pager.page(signature, of: query, page: page, pageSize: pageSize, after: next)
+        var queryResult: [String: Any] = [
             "summary": summary,
-            "rows": rows
+            "rows": rows.compactMap { $0.loadProperties() }
         ]
+        queryResult["next"] = following
         return queryResult
     }
 }
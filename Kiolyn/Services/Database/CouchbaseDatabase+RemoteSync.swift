@@ -202,6 +202,8 @@ extension CouchbaseDatabase {
             push.continuous = false
             push.filter = "remotePushFilter"
             push.filterParams = ["storeid": store.id]
+            // What exists before the push starts is pushed once it completes
+            let pushFrom = self.database.lastSequenceNumber
             var disposableBag: DisposeBag? = DisposeBag()
             Observable.merge(
                 NotificationCenter.default.rx.notification(.cblReplicationChange, object: pull).skip(1),
@@ -226,6 +228,10 @@ extension CouchbaseDatabase {
                         }
                     } else { // All inactive, means done
                         i("[REMOTESYNC] Completed")
+                        // Everything up to the start of the push is now on the server
+                        if push.lastError == nil {
+                            self.markPushed(upTo: pushFrom)
+                        }
                         // Notify listener
                         observer.onCompleted()
                         disposableBag = nil
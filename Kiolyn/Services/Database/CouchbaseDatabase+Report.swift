@@ -55,6 +55,25 @@ class GroupedByShiftQueryResult<R: Mappable> : QueryResult<R> {
     }
 }
 
+extension CouchbaseDatabase {
+    /// Load the materialized rows of a report, of a single shift of a day or of all the shifts of a
+    /// range of days.
+    ///
+    /// - Parameters:
+    ///   - group: The report.
+    ///   - storeID: The store.
+    ///   - fromDate: The first day.
+    ///   - toDate: The last day.
+    ///   - shift: The shift, only when reporting a single day.
+    /// - Returns: The finest grouped rows.
+    func load(reportRows group: ReportAggregates.Group, of storeID: String, fromDate: Date, toDate: Date, shift: Int) -> [ReportAggregateRow] {
+        if fromDate.toString("yyMMdd") == toDate.toString("yyMMdd") && shift > 0 {
+            return reportAggregates.rows(group, of: storeID, fromDate: fromDate, toDate: fromDate, shift: shift)
+        }
+        return reportAggregates.rows(group, of: storeID, fromDate: fromDate, toDate: toDate, shift: 0)
+    }
+}
+
 typealias Sum = (Any?, Any?) -> Any
 let DSum: Sum = { (lhs, rhs) -> Any in (lhs as? Double ?? 0) + (rhs as? Double ?? 0) }
 let ISum: Sum = { (lhs, rhs) -> Any in (lhs as? Int ?? 0) + (rhs as? Int ?? 0) }
@@ -34,11 +34,11 @@ class TransactionReportRow: Mappable, Equatable {
 
 extension CouchbaseDatabase {
     
-    /// Group orders by store/shift/status
-    var transactionByTypeView: CBLView {
-        // Get/Create view
-        let view = database.viewNamed("transaction_by_type")
-        view.setMapBlock({ (doc, emit) in
+    /// Generate the Shift/Payment Type related transactions view Map block.
+    ///
+    /// - Returns: The `CBLMapBlock`.
+    func transactionTypeMap() -> CBLMapBlock {
+        return { (doc, emit) in
             // Make sure good inputs
             guard doc["deleted"] == nil,
                 let type = doc["type"] as? String, type == Transaction.documentType,
@@ -82,24 +82,7 @@ extension CouchbaseDatabase {
             let cardType = (doc["card_type"] as? String) ?? ""
             emit([storeID, id[0...5], shift, emitTransType, cardType],
                  ["total": approvedAmount, "tip": tipAmount])
-        }, reduce: { (keys, values, rereduce) in
-            guard let values = values as? [[String:Any]] else {
-                return [:]
-            }
-            var reduced = values.sum(fields: [("total", DSum), ("tip", DSum)])
-            reduced["count"] = values.count
-            
-            let shifts = keys.map { key -> Int in
-                guard let key = key as? [Any], let shift = key[2] as? Int else {
-                    return 0
-                }
-                return shift
-            }
-            reduced["shifts"] = shifts.unique().sorted()
-            
-            return reduced
-        }, version: CouchbaseDatabase.VERSION)
-        return view
+        }
     }
     
     /// Generate the Shift/Area related transactions view Map block.
@@ -231,17 +214,30 @@ extension CouchbaseDatabase {
                 query.endKey = [storeID, fdate, areaID, [:], [:]]
             }
         }
-        // Query the Summary
-        guard let summary = query.loadDict() else {
-            return ReportQueryResult()
+        let summary: [String: Any]
+        let transactions: [Transaction]
+        if let view = query.view, let prefix = query.startKey as? [Any],
+            let archived = rows(view, archivedOf: storeID, day: fromDate, prefix: prefix) {
+            // Archived day, the purged transactions are read from the archive
+            guard let archivedSummary = reduce(archived, of: view, level: 0).first?.value else {
+                return ReportQueryResult()
+            }
+            summary = archivedSummary
+            transactions = self.page(archived, page: page, pageSize: pageSize).map { row in Transaction.decoded(row.properties) }
+        } else {
+            // Query the Summary
+            guard let liveSummary = query.loadDict() else {
+                return ReportQueryResult()
+            }
+            summary = liveSummary
+            // Run the detail query
+            query.mapOnly = true
+            query.prefetch = true
+            if pageSize > 0 { query.limit = pageSize }
+            if page > 0 { query.skip = (page - 1) * pageSize }
+            // Load all transaction first
+            transactions = query.loadModels()
         }
-        // Run the detail query
-        query.mapOnly = true
-        query.prefetch = true
-        if pageSize > 0 { query.limit = pageSize }
-        if page > 0 { query.skip = (page - 1) * pageSize }
-        // Load all transaction first
-        let transactions: [Transaction] = query.loadModels()
         // The fill in the Order/Bill info
         let orders: [Order?] = load(multi: transactions.map { $0.order}.unique())
         let rows = transactions.map { t -> TransactionReportRow in
@@ -281,13 +277,24 @@ extension CouchbaseDatabase {
                 query.endKey = [storeID, fdate, areaID, [:], [:]]
             }
         }
-        // Query the detail first
-        query.mapOnly = true
-        query.prefetch = true
-        let rows: [Transaction] = query.loadModels()
-        // ... then the summary for each shift
-        query.groupLevel = areaID.isEmpty ? 3 : 4
-        return query.loadMulti()
+        let groupLevel = areaID.isEmpty ? 3 : 4
+        let rows: [Transaction]
+        let grouped: [(key: [Any], value: [String: Any])]
+        if let view = query.view, let prefix = query.startKey as? [Any],
+            let archived = self.rows(view, archivedOf: storeID, day: fromDate, prefix: prefix) {
+            // Archived day, the purged transactions are read from the archive
+            rows = archived.map { row in Transaction.decoded(row.properties) }
+            grouped = reduce(archived, of: view, level: groupLevel)
+        } else {
+            // Query the detail first
+            query.mapOnly = true
+            query.prefetch = true
+            rows = query.loadModels()
+            // ... then the summary for each shift
+            query.groupLevel = UInt(groupLevel)
+            grouped = query.loadMulti()
+        }
+        return grouped
             .map { (key, value) in
                 let kshift = key[2] as! Int
                 let shiftRows = rows.filter { Int($0.shiftIndex) == kshift }
@@ -105,41 +105,56 @@ extension CouchbaseDatabase {
         return view
     }
     
-    func load(unsettledTransactions storeID: String, shift shiftID: String, for paymentType: String, page: UInt, pageSize: UInt) -> QueryResult<Transaction> {
+    /// Load a page of the unsettled transactions of a shift.
+    ///
+    /// - Parameters:
+    ///   - storeID: The store to load for.
+    ///   - shiftID: The shift to load for.
+    ///   - paymentType: The payment type, empty for all.
+    ///   - page: The page number, starting from 1.
+    ///   - pageSize: The page size, 0 for all.
+    ///   - next: The continuation key returned with the previous page.
+    /// - Returns: The transactions, summary and continuation key of the next page.
+    func load(unsettledTransactions storeID: String, shift shiftID: String, for paymentType: String, page: UInt, pageSize: UInt, after next: String?) -> QueryResult<Transaction> {
         guard storeID.isNotEmpty, shiftID.isNotEmpty else {
             return QueryResult<Transaction>()
         }
         
-        var query: CBLQuery!
-        if paymentType.isEmpty {
-            query = unsettledTransactionsView.createQuery()
-            query.startKey = [storeID, shiftID]
-            query.endKey = [storeID, shiftID, [:]]
-        } else if paymentType == TransactionType.creditVoid.rawValue {
-            query = unsettledVoidedTransactionsView.createQuery()
-            query.startKey = [storeID, shiftID]
-            query.endKey = [storeID, shiftID, [:]]
-        } else {
-            query = unsettledTransactionsByTypeView.createQuery()
-            query.startKey = [storeID, shiftID, paymentType]
-            query.endKey = [storeID, shiftID, paymentType, [:]]
+        let createQuery = { () -> CBLQuery in
+            var query: CBLQuery!
+            if paymentType.isEmpty {
+                query = self.unsettledTransactionsView.createQuery()
+                query.startKey = [storeID, shiftID]
+                query.endKey = [storeID, shiftID, [:]]
+            } else if paymentType == TransactionType.creditVoid.rawValue {
+                query = self.unsettledVoidedTransactionsView.createQuery()
+                query.startKey = [storeID, shiftID]
+                query.endKey = [storeID, shiftID, [:]]
+            } else {
+                query = self.unsettledTransactionsByTypeView.createQuery()
+                query.startKey = [storeID, shiftID, paymentType]
+                query.endKey = [storeID, shiftID, paymentType, [:]]
+            }
+            return query
         }
+        let signature = QueryPager.signature(Transaction.self, ["unsettled", storeID, shiftID, paymentType])
         
         // Run query and return the first item
-        let count = query.loadInt()
+        let count = pager.count(signature) { createQuery().loadInt() }
         let summary = QuerySummary(count: count)
         // Total count is 0, no need to query for detail
         guard summary.rowCount > 0 else {
             return QueryResult<Transaction>()
         }
         
-        // Rows detail / Ordered by order no
+        // Rows detail / Ordered by trans no
+        let query = createQuery()
         query.mapOnly = true
         query.prefetch = true
-        if pageSize > 0 { query.limit = pageSize }
-        if page > 0 { query.skip = (page - 1) * pageSize }
-        let rows: [Transaction] = query.loadModels()
-        return QueryResult(rows: rows, summary: summary)
+        let (rows, following) = pager.page(signature, of: query, page: page, pageSize: pageSize, after: next)
+        let result = QueryResult(rows: rows.compactMap { row -> Transaction? in row.loadModel() }, summary: summary)
+        result.next = following
+        return result
     }
     
     func load(unsettledTransactions storeID: String) -> [Transaction] {
@@ -0,0 +1,100 @@
+//
+//  CouchbaseDatabase+Warmup.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 9/4/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+import RxSwift
+
+/// The order in which views are warmed up, the screens needing them first come first. The report
+/// aggregates are caught up last, after the views.
+enum ViewPriority: Int {
+    case login
+    case menu
+    case openOrders
+    case reports
+}
+
+// MARK: - View warm-up
+extension CouchbaseDatabase {
+
+    /// All the views with their priority, in warm-up order. Accessing a view registers its map block.
+    fileprivate var prioritizedViews: [(ViewPriority, () -> CBLView?)] {
+        let views: [(ViewPriority, () -> CBLView?)] = [
+            (.login, { self.stationByMacView }),
+            (.login, { self.employeeByPasskeyView }),
+            (.login, { self.openingShiftView }),
+            (.login, { self.shiftByDate }),
+            (.login, { self.allView(of: Area.self) }),
+            (.login, { self.allView(of: Printer.self) }),
+            (.login, { self.allView(of: TimeCard.self) }),
+            (.menu, { self.allView(of: Category.self) }),
+            (.menu, { self.itemByCategoryView }),
+            (.menu, { self.allView(of: Modifier.self) }),
+            (.openOrders, { self.orderByAreaStatusView }),
+            (.openOrders, { self.orderByOrderStatusView }),
+            (.openOrders, { self.orderByOrderNoView }),
+            (.openOrders, { self.unsettledTransactionsView }),
+            (.openOrders, { self.unsettledVoidedTransactionsView }),
+            (.openOrders, { self.unsettledTransactionsByTypeView }),
+            (.openOrders, { self.allCustomersView }),
+            (.reports, { self.orderByServerShiftView }),
+            (.reports, { self.transactionByShiftAreaView }),
+            (.reports, { self.transactionByAreaShiftView })
+        ]
+        return views.sorted { $0.0.rawValue < $1.0.rawValue }
+    }
+
+    /// Register all the views and build their indexes in background, one view after another by
+    /// priority, then catch the report aggregates up. Indexes are built on a background database
+    /// instance, queries are not queued behind them: a login query only ever updates its own
+    /// (already warmed up) view.
+    ///
+    /// - Returns: The warm-up progress observable, from 0 to 1.
+    func warmUpViews() -> Observable<Double> {
+        return Observable.create { observer in
+            var disposed = false
+            self.async {
+                let views = self.prioritizedViews.compactMap { (priority, view) -> (ViewPriority, CBLView)? in
+                    guard let view = view() else { return nil }
+                    return (priority, view)
+                }
+                let start = Date()
+                // The report aggregates are one more step
+                let steps = Double(views.count + 1)
+                /// Update the index of the view at `index` then go on with the next one.
+                func warmUp(_ index: Int) {
+                    guard !disposed else { return }
+                    guard index < views.count else {
+                        d("[DB] Warmed up \(views.count) views in \(Int(Date().timeIntervalSince(start) * 1000))ms")
+                        return self.async {
+                            guard !disposed else { return }
+                            let aggregatesStart = Date()
+                            self.reportAggregates.warmUp()
+                            v("[DB] Warmed up report aggregates in \(Int(Date().timeIntervalSince(aggregatesStart) * 1000))ms")
+                            observer.onNext(1)
+                            observer.onCompleted()
+                        }
+                    }
+                    let (priority, view) = views[index]
+                    guard view.isStale else {
+                        observer.onNext(Double(index + 1) / steps)
+                        return warmUp(index + 1)
+                    }
+                    let viewStart = Date()
+                    view.updateIndexAsync {
+                        v("[DB] Warmed up \(view.name) (\(priority)) in \(Int(Date().timeIntervalSince(viewStart) * 1000))ms")
+                        observer.onNext(Double(index + 1) / steps)
+                        warmUp(index + 1)
+                    }
+                }
+                observer.onNext(0)
+                warmUp(0)
+            }
+            return Disposables.create { disposed = true }
+        }
+    }
+}
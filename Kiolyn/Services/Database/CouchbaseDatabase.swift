@@ -92,6 +92,54 @@ class CouchbaseDatabase: NSObject, Database {
     /// Return the document count
     var documentCount: UInt { return database.documentCount }
     
+    /// The opening orders kept in memory.
+    lazy var openOrders: OpenOrdersIndex = {
+        return OpenOrdersIndex(database: database) { [unowned self] (storeID, shiftID) in
+            self.loadDocuments(indexedOrders: storeID, forShift: shiftID)
+        }
+    }()
+    
+    /// The customers search index kept in memory.
+    lazy var customerSearch: CustomerSearchIndex = {
+        return CustomerSearchIndex(database: database) { [unowned self] storeID in
+            self.loadDocuments(indexedCustomers: storeID)
+        }
+    }()
+    
+    /// The store menus kept in memory.
+    lazy var menu: MenuCache = {
+        return MenuCache(database: database) { [unowned self] storeID in
+            self.loadSnapshot(menu: storeID)
+        }
+    }()
+    
+    /// The changes for Subs to catch up with.
+    lazy var changeFeed: ChangeFeed = {
+        return ChangeFeed(database: database)
+    }()
+    
+    /// Keyset pagination and summaries cache of paged queries.
+    lazy var pager: QueryPager = {
+        return QueryPager(database: database)
+    }()
+    
+    /// Materialized aggregates of the reports.
+    lazy var reportAggregates: ReportAggregates = {
+        return ReportAggregates(
+            database: database,
+            maps: [
+                .employee: orderShiftServerMap(),
+                .area: orderShiftAreaDriverMap(),
+                .paymentType: transactionTypeMap()
+            ],
+            types: [Order.self, Transaction.self])
+    }()
+    
+    /// Columnar archive of the closed orders and settled transactions.
+    lazy var shiftArchive: ShiftArchive = {
+        return ShiftArchive()
+    }()
+    
     init(file: String? = nil, name: String = "kiolyn") {
         self.dbFile = file
         self.dbName = name
@@ -0,0 +1,322 @@
+//
+//  CustomerSearchIndex.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 8/29/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+import RxSwift
+
+/// In memory search index of the customers of a store for typeahead lookups. A store is loaded
+/// from database the first time it is searched, then kept up to date from the database change
+/// notifications. Phone (digits only), name tokens and email are kept sorted for prefix lookups,
+/// address is indexed by trigrams for substring lookups.
+class CustomerSearchIndex {
+
+    /// An indexed customer.
+    fileprivate struct Entry {
+        let docID: String
+        let storeID: String
+        let name: String
+        let nameTokens: [String]
+        let phone: String
+        let email: String
+        let address: String
+        let properties: [String: Any]
+
+        init?(docID: String, properties: [String: Any]) {
+            guard properties["_deleted"] == nil, properties["deleted"] == nil,
+                let type = properties["type"] as? String, type == Customer.documentType,
+                let id = properties["id"] as? String, id.isNotEmpty,
+                let merchantID = properties["merchantid"] as? String, merchantID.isNotEmpty,
+                let name = properties["name"] as? String, name.isNotEmpty else {
+                    return nil
+            }
+            self.docID = docID
+            // User storeid (new Store) or merchantid (old Store)
+            self.storeID = (properties["storeid"] as? String) ?? merchantID
+            self.name = name.lowercased()
+            self.nameTokens = CustomerSearchIndex.tokens(of: self.name)
+            self.phone = CustomerSearchIndex.digits(of: (properties["mobilephone"] as? String) ?? "")
+            self.email = ((properties["email"] as? String) ?? "").lowercased()
+            self.address = ((properties["address"] as? String) ?? "").lowercased()
+            self.properties = properties
+        }
+
+        /// All the name keys, the full name and each of its tokens.
+        var nameKeys: [String] {
+            return Array(Set([name] + nameTokens))
+        }
+    }
+
+    /// Sorted (key, document id) pairs for prefix lookups.
+    fileprivate struct SortedKeys {
+        fileprivate var pairs: [(String, String)] = []
+
+        init() {}
+
+        /// Sort all the pairs at once, for building a store.
+        init(_ pairs: [(String, String)]) {
+            var sorted = pairs.filter { $0.0.isNotEmpty }
+            sorted.sort { $0 < $1 }
+            // Without duplicates, like inserting one by one
+            self.pairs = sorted.enumerated()
+                .filter { $0.offset == 0 || sorted[$0.offset - 1] != $0.element }
+                .map { $0.element }
+        }
+
+        /// First position not less than the given pair.
+        fileprivate func lowerBound(_ pair: (String, String)) -> Int {
+            var low = 0, high = pairs.count
+            while low < high {
+                let mid = (low + high) / 2
+                if pairs[mid] < pair { low = mid + 1 } else { high = mid }
+            }
+            return low
+        }
+
+        mutating func insert(_ key: String, _ docID: String) {
+            guard key.isNotEmpty else { return }
+            let pair = (key, docID)
+            let index = lowerBound(pair)
+            guard index == pairs.count || pairs[index] != pair else { return }
+            pairs.insert(pair, at: index)
+        }
+
+        mutating func remove(_ key: String, _ docID: String) {
+            guard key.isNotEmpty else { return }
+            let pair = (key, docID)
+            let index = lowerBound(pair)
+            guard index < pairs.count, pairs[index] == pair else { return }
+            pairs.remove(at: index)
+        }
+
+        /// Document ids of the keys starting with the given prefix.
+        func docIDs(withPrefix prefix: String) -> Set<String> {
+            var result = Set<String>()
+            var index = lowerBound((prefix, ""))
+            while index < pairs.count, pairs[index].0.hasPrefix(prefix) {
+                result.insert(pairs[index].1)
+                index += 1
+            }
+            return result
+        }
+    }
+
+    /// The index of a single store.
+    fileprivate struct Store {
+        var entries: [String: Entry] = [:]
+        var phones = SortedKeys()
+        var names = SortedKeys()
+        var emails = SortedKeys()
+        var trigrams: [String: Set<String>] = [:]
+
+        init() {}
+
+        /// Index all the entries at once, sorting the keys once instead of inserting one by one.
+        init(_ entries: [Entry]) {
+            for entry in entries {
+                self.entries[entry.docID] = entry
+            }
+            var phones: [(String, String)] = []
+            var names: [(String, String)] = []
+            var emails: [(String, String)] = []
+            for entry in self.entries.values {
+                phones.append((entry.phone, entry.docID))
+                names += entry.nameKeys.map { ($0, entry.docID) }
+                emails.append((entry.email, entry.docID))
+                for trigram in CustomerSearchIndex.trigrams(of: entry.address) {
+                    trigrams[trigram, default: []].insert(entry.docID)
+                }
+            }
+            self.phones = SortedKeys(phones)
+            self.names = SortedKeys(names)
+            self.emails = SortedKeys(emails)
+        }
+
+        /// Add or replace an entry, for live updates.
+        mutating func add(_ entry: Entry) {
+            entries[entry.docID] = entry
+            phones.insert(entry.phone, entry.docID)
+            for key in entry.nameKeys {
+                names.insert(key, entry.docID)
+            }
+            emails.insert(entry.email, entry.docID)
+            for trigram in CustomerSearchIndex.trigrams(of: entry.address) {
+                trigrams[trigram, default: []].insert(entry.docID)
+            }
+        }
+
+        mutating func remove(_ docID: String) {
+            guard let entry = entries.removeValue(forKey: docID) else { return }
+            phones.remove(entry.phone, docID)
+            for key in entry.nameKeys {
+                names.remove(key, docID)
+            }
+            emails.remove(entry.email, docID)
+            for trigram in CustomerSearchIndex.trigrams(of: entry.address) {
+                trigrams[trigram]?.remove(docID)
+                if trigrams[trigram]?.isEmpty == true {
+                    trigrams[trigram] = nil
+                }
+            }
+        }
+    }
+
+    let disposeBag = DisposeBag()
+
+    fileprivate let lock = NSLock()
+    fileprivate var stores: [String: Store] = [:]
+    /// Store of indexed documents, for removing.
+    fileprivate var locations: [String: String] = [:]
+    fileprivate let database: CBLDatabase
+    fileprivate let load: (String) -> [(String, [String: Any])]
+
+    /// Create the index.
+    ///
+    /// - Parameters:
+    ///   - database: The database to follow changes of.
+    ///   - load: Load documents id and properties of the customers of a store.
+    init(database: CBLDatabase, load: @escaping (String) -> [(String, [String: Any])]) {
+        self.database = database
+        self.load = load
+        NotificationCenter.default.rx
+            .notification(.cblDatabaseChange, object: database)
+            .subscribe(onNext: { notification in
+                guard let changes = notification.userInfo?["changes"] as? [CBLDatabaseChange] else { return }
+                self.update(changes.map { $0.documentID })
+            })
+            .disposed(by: disposeBag)
+    }
+
+    /// Search the customers of a store, loading the store if not yet indexed. Name matches on the
+    /// prefix of every word, phone matches on the prefix of its digits, email on its prefix and
+    /// address anywhere inside. All the given fields must match.
+    ///
+    /// - Parameters:
+    ///   - storeID: The store.
+    ///   - query: The (name, phone, email, address) to search for, empty to ignore.
+    ///   - limit: Maximum number of customers to return.
+    /// - Returns: The customers properties ordered by name.
+    func properties(customers storeID: String, query: (String, String, String, String), limit: UInt) -> [[String: Any]] {
+        lock.lock()
+        let indexed = stores[storeID] != nil
+        lock.unlock()
+        if !indexed {
+            build(storeID)
+        }
+
+        let name = CustomerSearchIndex.tokens(of: query.0.lowercased())
+        let phone = query.1.isEmpty ? "" : CustomerSearchIndex.digits(of: query.1)
+        let email = query.2.lowercased()
+        let address = query.3.lowercased().trimmingCharacters(in: .whitespaces)
+        // Something was typed for phone but not a single digit
+        if query.1.isNotEmpty && phone.isEmpty {
+            return []
+        }
+
+        lock.lock()
+        defer { lock.unlock() }
+        guard let store = stores[storeID] else { return [] }
+        var candidates: Set<String>? = nil
+        let narrow = { (docIDs: Set<String>) in
+            candidates = candidates?.intersection(docIDs) ?? docIDs
+        }
+        if phone.isNotEmpty {
+            narrow(store.phones.docIDs(withPrefix: phone))
+        }
+        for token in name {
+            narrow(store.names.docIDs(withPrefix: token))
+        }
+        if email.isNotEmpty {
+            narrow(store.emails.docIDs(withPrefix: email))
+        }
+        var entries: [Entry]
+        if address.isNotEmpty {
+            let trigrams = CustomerSearchIndex.trigrams(of: address)
+            if trigrams.isNotEmpty {
+                for trigram in trigrams {
+                    narrow(store.trigrams[trigram] ?? [])
+                }
+            }
+            // Trigrams may match out of order, short address is not indexed at all
+            entries = (candidates.map { $0.compactMap { store.entries[$0] } } ?? Array(store.entries.values))
+                .filter { $0.address.contains(address) }
+        } else {
+            entries = (candidates ?? []).compactMap { store.entries[$0] }
+        }
+        return entries
+            .sorted { ($0.name, $0.docID) < ($1.name, $1.docID) }
+            .prefix(Int(limit))
+            .map { $0.properties }
+    }
+
+    /// Forget all indexed stores.
+    func reset() {
+        lock.lock()
+        stores = [:]
+        locations = [:]
+        lock.unlock()
+    }
+
+    /// Lowercased words of a name.
+    fileprivate static func tokens(of text: String) -> [String] {
+        return text
+            .components(separatedBy: CharacterSet.alphanumerics.inverted)
+            .filter { $0.isNotEmpty }
+    }
+
+    /// Digits only of a phone number.
+    fileprivate static func digits(of text: String) -> String {
+        return String(text.unicodeScalars.filter { CharacterSet.decimalDigits.contains($0) }.map(Character.init))
+    }
+
+    /// Trigrams of a lowercased text.
+    fileprivate static func trigrams(of text: String) -> Set<String> {
+        let characters = Array(text)
+        guard characters.count >= 3 else { return [] }
+        return Set((0...(characters.count - 3)).map { String(characters[$0..<($0 + 3)]) })
+    }
+
+    /// Load a store from database.
+    fileprivate func build(_ storeID: String) {
+        let start = Date()
+        let store = Store(load(storeID).compactMap { (docID, properties) -> Entry? in
+            guard let entry = Entry(docID: docID, properties: properties), entry.storeID == storeID else { return nil }
+            return entry
+        })
+        lock.lock()
+        stores[storeID] = store
+        for docID in store.entries.keys {
+            locations[docID] = storeID
+        }
+        lock.unlock()
+        d("[CustomerSearchIndex] Indexed \(store.entries.count) customers of \(storeID) in \(Int(Date().timeIntervalSince(start) * 1000))ms")
+    }
+
+    /// Apply changed documents to indexed stores.
+    fileprivate func update(_ docIDs: [String]) {
+        let prefix = "\(Customer.documentIDPrefix)_"
+        let changed = docIDs
+            .filter { $0.hasPrefix(prefix) }
+            .map { docID in (docID, database.existingDocument(withID: docID)?.properties) }
+        guard changed.isNotEmpty else { return }
+        lock.lock()
+        defer { lock.unlock() }
+        for (docID, properties) in changed {
+            // Remove from where it was
+            if let storeID = locations[docID] {
+                stores[storeID]?.remove(docID)
+                locations[docID] = nil
+            }
+            // ... and add to where it is now, if its store is indexed
+            guard let properties = properties,
+                let entry = Entry(docID: docID, properties: properties),
+                stores[entry.storeID] != nil else { continue }
+            stores[entry.storeID]?.add(entry)
+            locations[docID] = entry.storeID
+        }
+    }
+}
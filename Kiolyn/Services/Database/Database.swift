@@ -226,6 +226,21 @@ protocol Database {
     func load(globalModifiers storeID: String) -> [Modifier]
     func loadProperties(globalModifiers storeID: String) -> [[String: Any]]
     
+    /// Load the menu of a store, from memory unless a menu document changed since it was loaded.
+    ///
+    /// - Parameter storeID: the Store to load for.
+    /// - Returns: The menu.
+    func load(menu storeID: String) -> MenuSnapshot
+    
+    /// Get the menu of a store if in memory, without accessing the database (safe outside `async`).
+    ///
+    /// - Parameter storeID: the Store to get for.
+    /// - Returns: The menu, `nil` if not loaded.
+    func cached(menu storeID: String) -> MenuSnapshot?
+    
+    /// Emit the database sequence when a menu document changes.
+    var menuChanged: Observable<UInt64> { get }
+    
     // MARK: - Shift
     
     /// Return the currently opening shift.
@@ -272,9 +287,24 @@ protocol Database {
     ///   - statuses: List of `OrderStatus`es to load for.
     ///   - page: The page to load for.
     ///   - pageSize: The page size to load for.
+    ///   - next: The continuation key returned with the previous page, `nil` to go by page number.
     /// - Returns: `Order`s that matches the loading conditions with its summary.
-    func load(orders storeID: String, forShift shiftID: String, matchingStatuses statuses: [OrderStatus], page: UInt, pageSize: UInt) -> QueryResult<Order>
-    func loadProperties(orders storeID: String, forShift shiftID: String, matchingStatuses statuses: [OrderStatus], page: UInt, pageSize: UInt) -> [String: Any]
+    func load(orders storeID: String, forShift shiftID: String, matchingStatuses statuses: [OrderStatus], page: UInt, pageSize: UInt, after next: String?) -> QueryResult<Order>
+    func loadProperties(orders storeID: String, forShift shiftID: String, matchingStatuses statuses: [OrderStatus], page: UInt, pageSize: UInt, after next: String?) -> [String: Any]
+    
+    /// Load the not voided orders of a shift changed since a database sequence, for a Sub to catch up with.
+    ///
+    /// - Parameters:
+    ///   - storeID: The store to load for.
+    ///   - shiftID: The shift to load for.
+    ///   - since: The sequence the Sub caught up with, 0 for all the orders.
+    ///   - revisions: The revisions of the orders held by the Sub, by document id.
+    /// - Returns: `last_seq`, `reset` (`true` when all the orders are listed) and `changes`, each
+    ///   with `id` and either `doc`, `patch` from the `base` revision or `deleted`.
+    func loadProperties(orderChanges storeID: String, forShift shiftID: String, since: UInt64, revisions: [String: String]) -> [String: Any]
+    
+    /// The last database sequence.
+    var lastSequence: UInt64 { get }
 
     // MARK: - Customer
     
@@ -284,8 +314,9 @@ protocol Database {
     ///   - storeID: The `Store` to load for.
     ///   - page: Number of record to return.
     ///   - pageSize: Number of record to skip.
+    ///   - next: The continuation key returned with the previous page, `nil` to go by page number.
     /// - Returns: QueryResult of `Customer`s that matches the loading conditions.
-    func load(customers storeID: String, page: UInt, pageSize: UInt) -> QueryResult<Customer>
+    func load(customers storeID: String, page: UInt, pageSize: UInt, after next: String?) -> QueryResult<Customer>
     
     /// Find customers based on combination of Name, Phone, Email, Address.
     ///
@@ -307,8 +338,9 @@ protocol Database {
     ///   - paymentType: The `PaymentType` tot load for
     ///   - page: Number of record to return.
     ///   - pageSize: Number of record to skip.
+    ///   - next: The continuation key returned with the previous page, `nil` to go by page number.
     /// - Returns: `Transaction`s that matches the loading conditions with its summary.
-    func load(unsettledTransactions storeID: String, shift shiftID: String, for paymentType: String, page: UInt, pageSize: UInt) -> QueryResult<Transaction>
+    func load(unsettledTransactions storeID: String, shift shiftID: String, for paymentType: String, page: UInt, pageSize: UInt, after next: String?) -> QueryResult<Transaction>
     
     /// Load ALL unsettled transactions.
     ///
@@ -337,6 +369,28 @@ protocol Database {
     /// - Throws: any error thown by the running block.
     func runBatch(_ block: @escaping () throws -> Void) throws
     
+    /// Commit the puts and deletes of a batch in one transaction, all or nothing.
+    ///
+    /// - Parameter batch: The batch to commit.
+    /// - Returns: The written documents and their new revisions, in the batch order.
+    /// - Throws: the error of the first failing operation, nothing is written then.
+    func commit(_ batch: WriteBatch) throws -> [WriteResult]
+    
+    // MARK: - Views
+    
+    /// Register all views and build their indexes in background, login views first and report views last.
+    ///
+    /// - Returns: The warm-up progress observable, from 0 to 1.
+    func warmUpViews() -> Observable<Double>
+    
+    // MARK: - Archive
+    
+    /// Move the closed orders and settled transactions of a store to the archive.
+    ///
+    /// - Parameter storeID: The store to archive for.
+    /// - Returns: Number of archived documents.
+    /// - Throws: error if the documents could not be archived.
+    func archive(closedShifts storeID: String) throws -> Int
     
     // MARK: - Reports
     
@@ -460,5 +514,21 @@ protocol Database {
     func load(shiftSummary storeID: String, fromDate: Date, toDate: Date, shift: Int) -> QuerySummary 
 }
 
-
-
+// MARK: - Paging by page number
+extension Database {
+    func load(orders storeID: String, forShift shiftID: String, matchingStatuses statuses: [OrderStatus], page: UInt, pageSize: UInt) -> QueryResult<Order> {
+        return load(orders: storeID, forShift: shiftID, matchingStatuses: statuses, page: page, pageSize: pageSize, after: nil)
+    }
+    
+    func loadProperties(orders storeID: String, forShift shiftID: String, matchingStatuses statuses: [OrderStatus], page: UInt, pageSize: UInt) -> [String: Any] {
+        return loadProperties(orders: storeID, forShift: shiftID, matchingStatuses: statuses, page: page, pageSize: pageSize, after: nil)
+    }
+    
+    func load(customers storeID: String, page: UInt, pageSize: UInt) -> QueryResult<Customer> {
+        return load(customers: storeID, page: page, pageSize: pageSize, after: nil)
+    }
+    
+    func load(unsettledTransactions storeID: String, shift shiftID: String, for paymentType: String, page: UInt, pageSize: UInt) -> QueryResult<Transaction> {
+        return load(unsettledTransactions: storeID, shift: shiftID, for: paymentType, page: page, pageSize: pageSize, after: nil)
+    }
+}
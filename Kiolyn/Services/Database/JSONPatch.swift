@@ -0,0 +1,144 @@
+//
+//  JSONPatch.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 9/6/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+/// JSON patch (RFC 6902) between document properties, limited to the `add`, `remove` and
+/// `replace` operations. Arrays are patched index by index, items added or removed at the end.
+enum JSONPatch {
+
+    /// The operations turning a document into another.
+    ///
+    /// - Parameters:
+    ///   - from: The original properties.
+    ///   - to: The changed properties.
+    /// - Returns: The patch operations, empty if the documents are the same.
+    static func diff(_ from: [String: Any], _ to: [String: Any]) -> [[String: Any]] {
+        var operations: [[String: Any]] = []
+        diff(from, to, "", &operations)
+        return operations
+    }
+
+    /// Apply a patch to a document.
+    ///
+    /// - Parameters:
+    ///   - patch: The patch operations.
+    ///   - properties: The properties to patch.
+    /// - Returns: The patched properties, `nil` if the patch does not apply.
+    static func apply(_ patch: [[String: Any]], to properties: [String: Any]) -> [String: Any]? {
+        var document: Any = properties
+        for operation in patch {
+            guard let op = operation["op"] as? String, ["add", "remove", "replace"].contains(op),
+                let path = operation["path"] as? String, path.hasPrefix("/") else {
+                    return nil
+            }
+            let tokens = path.dropFirst().components(separatedBy: "/").map(unescape)
+            guard let patched = apply(op, tokens[...], operation["value"], to: document) else {
+                return nil
+            }
+            document = patched
+        }
+        return document as? [String: Any]
+    }
+
+    // MARK: - Diff
+
+    fileprivate static func diff(_ from: Any, _ to: Any, _ path: String, _ operations: inout [[String: Any]]) {
+        if let from = from as? [String: Any], let to = to as? [String: Any] {
+            for key in from.keys.sorted() where to[key] == nil {
+                operations.append(["op": "remove", "path": "\(path)/\(escape(key))"])
+            }
+            for key in to.keys.sorted() {
+                guard let value = to[key] else { continue }
+                if let original = from[key] {
+                    diff(original, value, "\(path)/\(escape(key))", &operations)
+                } else {
+                    operations.append(["op": "add", "path": "\(path)/\(escape(key))", "value": value])
+                }
+            }
+        } else if let from = from as? [Any], let to = to as? [Any] {
+            let common = min(from.count, to.count)
+            for index in 0..<common {
+                diff(from[index], to[index], "\(path)/\(index)", &operations)
+            }
+            for index in common..<max(common, to.count) {
+                operations.append(["op": "add", "path": "\(path)/\(index)", "value": to[index]])
+            }
+            // From the end, for the indexes to stay valid
+            for index in (common..<max(common, from.count)).reversed() {
+                operations.append(["op": "remove", "path": "\(path)/\(index)"])
+            }
+        } else if !NSArray(object: from).isEqual(to: [to]) {
+            operations.append(["op": "replace", "path": path, "value": to])
+        }
+    }
+
+    // MARK: - Apply
+
+    fileprivate static func apply(_ op: String, _ tokens: ArraySlice<String>, _ value: Any?, to target: Any) -> Any? {
+        guard let token = tokens.first else {
+            // Replacing the whole document
+            return op == "replace" ? value : nil
+        }
+        let rest = tokens.dropFirst()
+        if var dictionary = target as? [String: Any] {
+            if rest.isEmpty {
+                switch op {
+                case "add":
+                    guard let value = value else { return nil }
+                    dictionary[token] = value
+                case "replace":
+                    guard let value = value, dictionary[token] != nil else { return nil }
+                    dictionary[token] = value
+                default:
+                    guard dictionary[token] != nil else { return nil }
+                    dictionary[token] = nil
+                }
+                return dictionary
+            }
+            guard let child = dictionary[token], let patched = apply(op, rest, value, to: child) else {
+                return nil
+            }
+            dictionary[token] = patched
+            return dictionary
+        }
+        if var array = target as? [Any] {
+            let index = token == "-" ? array.count : Int(token) ?? -1
+            if rest.isEmpty {
+                switch op {
+                case "add":
+                    guard let value = value, index >= 0, index <= array.count else { return nil }
+                    array.insert(value, at: index)
+                case "replace":
+                    guard let value = value, index >= 0, index < array.count else { return nil }
+                    array[index] = value
+                default:
+                    guard index >= 0, index < array.count else { return nil }
+                    array.remove(at: index)
+                }
+                return array
+            }
+            guard index >= 0, index < array.count, let patched = apply(op, rest, value, to: array[index]) else {
+                return nil
+            }
+            array[index] = patched
+            return array
+        }
+        return nil
+    }
+
+    // MARK: - JSON pointer
+
+    fileprivate static func escape(_ token: String) -> String {
+        return token.replacingOccurrences(of: "~", with: "~0").replacingOccurrences(of: "/", with: "~1")
+    }
+
+    fileprivate static func unescape(_ token: String) -> String {
+        return token.replacingOccurrences(of: "~1", with: "/").replacingOccurrences(of: "~0", with: "~")
+    }
+}
@@ -0,0 +1,191 @@
+//
+//  MenuCache.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 9/5/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+import RxSwift
+
+/// The menu of a store (items by category and modifiers) as it was at a database sequence.
+struct MenuSnapshot {
+    /// The store of this menu.
+    let storeID: String
+    /// The database sequence this menu was built at.
+    let checkpoint: UInt64
+    /// Properties of the visible items by category, in view order.
+    fileprivate let items: [String: [[String: Any]]]
+    /// Properties of the visible items by id.
+    fileprivate let itemsByID: [String: [String: Any]]
+    /// Properties of the modifiers by id.
+    fileprivate let modifiers: [String: [String: Any]]
+    /// Properties of the global modifiers having options, in view order.
+    let globalModifiers: [[String: Any]]
+
+    /// Create a snapshot.
+    ///
+    /// - Parameters:
+    ///   - storeID: The store.
+    ///   - checkpoint: The database sequence of the loaded documents.
+    ///   - items: The categories and properties of the visible items, in view order.
+    ///   - modifiers: The properties of the modifiers, in view order.
+    init(storeID: String, checkpoint: UInt64, items: [(String, [String: Any])], modifiers: [[String: Any]]) {
+        self.storeID = storeID
+        self.checkpoint = checkpoint
+        var byCategory: [String: [[String: Any]]] = [:]
+        var byID: [String: [String: Any]] = [:]
+        for (category, properties) in items {
+            byCategory[category, default: []].append(properties)
+            if let id = properties["id"] as? String {
+                byID[id] = properties
+            }
+        }
+        self.items = byCategory
+        self.itemsByID = byID
+        var modifiersByID: [String: [String: Any]] = [:]
+        for properties in modifiers {
+            if let id = properties["id"] as? String {
+                modifiersByID[id] = properties
+            }
+        }
+        self.modifiers = modifiersByID
+        self.globalModifiers = modifiers.filter { properties in
+            guard let global = properties["global"] as? Bool,
+                let options = properties["options"] as? [[String: Any]] else {
+                    return false
+            }
+            return global && options.isNotEmpty
+        }
+    }
+
+    /// Properties of the visible items of a category.
+    ///
+    /// - Parameter category: The category.
+    /// - Returns: The items properties, in view order.
+    func properties(items category: String) -> [[String: Any]] {
+        return items[category] ?? []
+    }
+
+    /// The modifiers of an item, marked required/sameline as referred by the item.
+    ///
+    /// - Parameter itemID: The item.
+    /// - Returns: The modifiers, `nil` if the item or one of its modifiers is not in this menu.
+    func load(modifiers itemID: String) -> [Modifier]? {
+        guard let properties = itemsByID[itemID] else {
+            return nil
+        }
+        var modifiers: [Modifier] = []
+        for ref in Item.decoded(properties).modifiers {
+            guard let properties = self.modifiers[ref.id] else {
+                return nil
+            }
+            let modifier = Modifier.decoded(properties)
+            modifier.required = ref.required
+            modifier.sameline = ref.sameline
+            modifiers.append(modifier)
+        }
+        return modifiers.sorted { lhs, rhs in
+            "\(lhs.required ? 0 : 1)\(lhs.name)" < "\(rhs.required ? 0 : 1)\(rhs.name)"
+        }
+    }
+}
+
+/// In memory snapshots of the store menus. A store menu is loaded from database the first time it
+/// is asked for, then kept as is until an item, modifier or category document changes: menus
+/// rarely change so category switching does not query views.
+class MenuCache {
+    let disposeBag = DisposeBag()
+
+    /// Emit the database sequence each time the cached menus are dropped for a menu change.
+    let changed = PublishSubject<UInt64>()
+
+    fileprivate let lock = NSLock()
+    fileprivate var snapshots: [String: MenuSnapshot] = [:]
+    fileprivate let database: CBLDatabase
+    fileprivate let load: (String) -> MenuSnapshot
+
+    /// Document id prefixes of the menu documents.
+    fileprivate static let prefixes = [Item.self, Modifier.self, Category.self].map { "\($0.documentIDPrefix)_" }
+
+    /// Create the cache.
+    ///
+    /// - Parameters:
+    ///   - database: The database to follow changes of.
+    ///   - load: Load the menu of a store.
+    init(database: CBLDatabase, load: @escaping (String) -> MenuSnapshot) {
+        self.database = database
+        self.load = load
+        NotificationCenter.default.rx
+            .notification(.cblDatabaseChange, object: database)
+            .subscribe(onNext: { notification in
+                guard let changes = notification.userInfo?["changes"] as? [CBLDatabaseChange] else { return }
+                self.invalidate(changes.map { $0.documentID })
+            })
+            .disposed(by: disposeBag)
+    }
+
+    /// The menu of a store if cached, never touching the database.
+    ///
+    /// - Parameter storeID: The store.
+    /// - Returns: The menu, `nil` if not cached.
+    func cached(_ storeID: String) -> MenuSnapshot? {
+        lock.lock()
+        defer { lock.unlock() }
+        return snapshots[storeID]
+    }
+
+    /// The modifiers of an item from the cached menus, never touching the database.
+    ///
+    /// - Parameter itemID: The item.
+    /// - Returns: The modifiers, `nil` if the item is not in a cached menu.
+    func cached(modifiers itemID: String) -> [Modifier]? {
+        lock.lock()
+        let menus = Array(snapshots.values)
+        lock.unlock()
+        for menu in menus {
+            if let modifiers = menu.load(modifiers: itemID) {
+                return modifiers
+            }
+        }
+        return nil
+    }
+
+    /// The menu of a store, loading it if not cached. Must be called from the database queue.
+    ///
+    /// - Parameter storeID: The store.
+    /// - Returns: The menu.
+    func snapshot(_ storeID: String) -> MenuSnapshot {
+        if let snapshot = cached(storeID) {
+            return snapshot
+        }
+        let start = Date()
+        let snapshot = load(storeID)
+        lock.lock()
+        snapshots[storeID] = snapshot
+        lock.unlock()
+        d("[MenuCache] Loaded menu of \(storeID) at \(snapshot.checkpoint) in \(Int(Date().timeIntervalSince(start) * 1000))ms")
+        return snapshot
+    }
+
+    /// Forget all cached menus.
+    func reset() {
+        lock.lock()
+        snapshots = [:]
+        lock.unlock()
+    }
+
+    /// Drop the cached menus if a menu document changed.
+    fileprivate func invalidate(_ docIDs: [String]) {
+        guard docIDs.contains(where: { docID in MenuCache.prefixes.contains { docID.hasPrefix($0) } }) else { return }
+        lock.lock()
+        let dropped = !snapshots.isEmpty
+        snapshots = [:]
+        lock.unlock()
+        if dropped {
+            v("[MenuCache] Menu changed, dropped cached menus")
+        }
+        changed.onNext(database.lastSequenceNumber)
+    }
+}
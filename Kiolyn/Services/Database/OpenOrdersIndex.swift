@@ -0,0 +1,221 @@
+//
+//  OpenOrdersIndex.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 8/28/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+import RxSwift
+
+/// In memory index of the not voided orders of a store/shift grouped by area. A shift is loaded
+/// from database the first time it is asked for, then kept up to date from the database change
+/// notifications, so that table layout and Subs read opening orders without querying views.
+class OpenOrdersIndex {
+
+    /// An indexed order.
+    fileprivate struct Entry {
+        let docID: String
+        let shiftKey: String
+        let area: String
+        let status: String
+        let delivered: Bool
+        let properties: [String: Any]
+
+        init?(docID: String, properties: [String: Any]) {
+            guard properties["_deleted"] == nil, properties["deleted"] == nil,
+                let type = properties["type"] as? String, type == Order.documentType,
+                let merchantID = properties["merchantid"] as? String, merchantID.isNotEmpty,
+                let status = properties["status"] as? String, status.isNotEmpty, status != OrderStatus.voided.rawValue,
+                let shiftID = properties["shift_id"] as? String, shiftID.isNotEmpty else {
+                    return nil
+            }
+            self.docID = docID
+            // User storeid (new Store) or merchantid (old Store)
+            self.shiftKey = OpenOrdersIndex.key((properties["storeid"] as? String) ?? merchantID, shiftID)
+            self.area = (properties["area"] as? String) ?? ""
+            self.status = status
+            self.delivered = (properties["delivered"] as? Bool) ?? false
+            self.properties = properties
+        }
+    }
+
+    let disposeBag = DisposeBag()
+
+    fileprivate let lock = NSLock()
+    /// Entries by shift key, area and document id.
+    fileprivate var shifts: [String: [String: [String: Entry]]] = [:]
+    /// Shift key and area of indexed documents, for removing.
+    fileprivate var locations: [String: (String, String)] = [:]
+    fileprivate let database: CBLDatabase
+    fileprivate let load: (String, String) -> [(String, [String: Any])]
+
+    /// Create the index.
+    ///
+    /// - Parameters:
+    ///   - database: The database to follow changes of.
+    ///   - load: Load documents id and properties of the not voided orders of a store/shift.
+    init(database: CBLDatabase, load: @escaping (String, String) -> [(String, [String: Any])]) {
+        self.database = database
+        self.load = load
+        NotificationCenter.default.rx
+            .notification(.cblDatabaseChange, object: database)
+            .subscribe(onNext: { notification in
+                guard let changes = notification.userInfo?["changes"] as? [CBLDatabaseChange] else { return }
+                self.update(changes.map { $0.documentID })
+            })
+            .disposed(by: disposeBag)
+    }
+
+    /// Get the opening orders of a store/shift, loading the shift if not yet indexed.
+    ///
+    /// - Parameters:
+    ///   - storeID: The store.
+    ///   - shiftID: The shift.
+    ///   - area: The area, `nil` for all areas.
+    ///   - filter: The delivered filter for delivery area (ALL, DELIVERED or PENDING).
+    /// - Returns: The orders properties ordered by status.
+    func properties(openingOrders storeID: String, forShift shiftID: String, inArea area: Area?, withFilter filter: String) -> [[String: Any]] {
+        return OpenOrdersIndex.select(areas(storeID, shiftID), inArea: area, withFilter: filter)
+    }
+
+    /// The indexed orders of a store/shift, loading the shift if not yet indexed.
+    ///
+    /// - Parameters:
+    ///   - storeID: The store.
+    ///   - shiftID: The shift.
+    /// - Returns: The orders document ids and properties.
+    func documents(_ storeID: String, forShift shiftID: String) -> [(String, [String: Any])] {
+        return areas(storeID, shiftID).values.flatMap { $0.values }.map { ($0.docID, $0.properties) }
+    }
+
+    /// Select the opening orders among the not voided orders of a shift, as the index does.
+    ///
+    /// - Parameters:
+    ///   - documents: The not voided orders document ids and properties.
+    ///   - area: The area, `nil` for all areas.
+    ///   - filter: The delivered filter for delivery area (ALL, DELIVERED or PENDING).
+    /// - Returns: The orders properties ordered by status.
+    static func properties(openingOrders documents: [(String, [String: Any])], inArea area: Area?, withFilter filter: String) -> [[String: Any]] {
+        var areas: [String: [String: Entry]] = [:]
+        for (docID, properties) in documents {
+            guard let entry = Entry(docID: docID, properties: properties) else { continue }
+            areas[entry.area, default: [:]][docID] = entry
+        }
+        return select(areas, inArea: area, withFilter: filter)
+    }
+
+    /// Whether an order is one of the indexed (not voided) orders of a store/shift.
+    ///
+    /// - Parameters:
+    ///   - properties: The order properties.
+    ///   - storeID: The store.
+    ///   - shiftID: The shift.
+    /// - Returns: `true` if the order would be indexed for the store/shift.
+    static func indexes(_ properties: [String: Any], of storeID: String, forShift shiftID: String) -> Bool {
+        return Entry(docID: "", properties: properties)?.shiftKey == key(storeID, shiftID)
+    }
+
+    /// The indexed orders of a store/shift by area, loading the shift if not yet indexed.
+    fileprivate func areas(_ storeID: String, _ shiftID: String) -> [String: [String: Entry]] {
+        let shiftKey = OpenOrdersIndex.key(storeID, shiftID)
+        lock.lock()
+        let indexed = shifts[shiftKey] != nil
+        lock.unlock()
+        if !indexed {
+            build(storeID, shiftID)
+        }
+
+        lock.lock()
+        defer { lock.unlock() }
+        return shifts[shiftKey] ?? [:]
+    }
+
+    /// Select the opening orders of an area.
+    fileprivate static func select(_ areas: [String: [String: Entry]], inArea area: Area?, withFilter filter: String) -> [[String: Any]] {
+        let opening = [OrderStatus.new.rawValue, OrderStatus.printed.rawValue, OrderStatus.submitted.rawValue]
+        var entries: [Entry]
+        if let area = area {
+            let candidates = Array((areas[area.id] ?? [:]).values)
+            if area.isDelivery {
+                // Delivery area will consider the filter value
+                switch filter {
+                case "ALL": entries = candidates
+                case "DELIVERED": entries = candidates.filter { $0.delivered }
+                case "PENDING": entries = candidates.filter { !$0.delivered }
+                default: entries = []
+                }
+            } else {
+                entries = candidates.filter { opening.contains($0.status) }
+            }
+        } else {
+            entries = areas.values.flatMap { $0.values }.filter { opening.contains($0.status) }
+        }
+        return entries
+            .sorted { ($0.status, $0.docID) < ($1.status, $1.docID) }
+            .map { $0.properties }
+    }
+
+    /// Forget all indexed shifts.
+    func reset() {
+        lock.lock()
+        shifts = [:]
+        locations = [:]
+        lock.unlock()
+    }
+
+    /// Key of a store/shift.
+    fileprivate static func key(_ storeID: String, _ shiftID: String) -> String {
+        return "\(storeID)/\(shiftID)"
+    }
+
+    /// Load a shift from database, older shifts of the same store are dropped.
+    fileprivate func build(_ storeID: String, _ shiftID: String) {
+        let start = Date()
+        let shiftKey = OpenOrdersIndex.key(storeID, shiftID)
+        var areas: [String: [String: Entry]] = [:]
+        var indexed: [String: (String, String)] = [:]
+        for (docID, properties) in load(storeID, shiftID) {
+            guard let entry = Entry(docID: docID, properties: properties), entry.shiftKey == shiftKey else { continue }
+            areas[entry.area, default: [:]][docID] = entry
+            indexed[docID] = (shiftKey, entry.area)
+        }
+        lock.lock()
+        let storePrefix = "\(storeID)/"
+        for key in shifts.keys where key.hasPrefix(storePrefix) {
+            shifts[key] = nil
+        }
+        locations = locations.filter { !$0.value.0.hasPrefix(storePrefix) }
+        shifts[shiftKey] = areas
+        for (docID, location) in indexed {
+            locations[docID] = location
+        }
+        lock.unlock()
+        d("[OpenOrdersIndex] Indexed \(indexed.count) orders of \(shiftKey) in \(Int(Date().timeIntervalSince(start) * 1000))ms")
+    }
+
+    /// Apply changed documents to indexed shifts.
+    fileprivate func update(_ docIDs: [String]) {
+        let prefix = "\(Order.documentIDPrefix)_"
+        let changed = docIDs
+            .filter { $0.hasPrefix(prefix) }
+            .map { docID in (docID, database.existingDocument(withID: docID)?.properties) }
+        guard changed.isNotEmpty else { return }
+        lock.lock()
+        defer { lock.unlock() }
+        for (docID, properties) in changed {
+            // Remove from where it was
+            if let (shiftKey, area) = locations[docID] {
+                shifts[shiftKey]?[area]?[docID] = nil
+                locations[docID] = nil
+            }
+            // ... and add to where it is now, if its shift is indexed
+            guard let properties = properties,
+                let entry = Entry(docID: docID, properties: properties),
+                shifts[entry.shiftKey] != nil else { continue }
+            shifts[entry.shiftKey]?[entry.area, default: [:]][docID] = entry
+            locations[docID] = (entry.shiftKey, entry.area)
+        }
+    }
+}
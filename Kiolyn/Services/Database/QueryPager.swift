@@ -0,0 +1,187 @@
+//
+//  QueryPager.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 8/30/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+import RxSwift
+
+/// A page of rows with the continuation key of the next page, `nil` if this is the last page.
+typealias QueryPage = (rows: [CBLQueryRow], next: String?)
+
+/// Keyset pagination of view queries. A page starts at the key/document id of its first row
+/// instead of skipping the rows of the previous pages, the start of the next page is returned as
+/// an opaque continuation key and also remembered so that page numbers keep working. Summaries
+/// are cached by query signature. Both are dropped when a document of the signature type changes.
+class QueryPager {
+
+    /// Where a page starts.
+    fileprivate struct Cursor {
+        let key: Any
+        let docID: String
+
+        init(key: Any, docID: String) {
+            self.key = key
+            self.docID = docID
+        }
+
+        init?(_ encoded: String) {
+            // URL safe base64 back to base64
+            var base64 = encoded.replacingOccurrences(of: "-", with: "+").replacingOccurrences(of: "_", with: "/")
+            base64 += String(repeating: "=", count: (4 - base64.count % 4) % 4)
+            guard let data = Data(base64Encoded: base64),
+                let json = (try? JSONSerialization.jsonObject(with: data)) as? [String: Any],
+                let key = json["k"], let docID = json["d"] as? String else {
+                    return nil
+            }
+            self.init(key: key, docID: docID)
+        }
+
+        var encoded: String? {
+            guard JSONSerialization.isValidJSONObject(["k": key]),
+                let data = try? JSONSerialization.data(withJSONObject: ["k": key, "d": docID]) else {
+                    return nil
+            }
+            // URL safe, to be passed as query parameter
+            return data.base64EncodedString()
+                .replacingOccurrences(of: "+", with: "-")
+                .replacingOccurrences(of: "/", with: "_")
+                .replacingOccurrences(of: "=", with: "")
+        }
+    }
+
+    let disposeBag = DisposeBag()
+
+    fileprivate let lock = NSLock()
+    /// Row count by signature.
+    fileprivate var summaries: [String: Int] = [:]
+    /// First row of pages by signature, page size and page number.
+    fileprivate var anchors: [String: [UInt: [UInt: Cursor]]] = [:]
+
+    /// Create the pager.
+    ///
+    /// - Parameter database: The database to follow changes of.
+    init(database: CBLDatabase) {
+        NotificationCenter.default.rx
+            .notification(.cblDatabaseChange, object: database)
+            .subscribe(onNext: { notification in
+                guard let changes = notification.userInfo?["changes"] as? [CBLDatabaseChange] else { return }
+                self.invalidate(changes.map { $0.documentID })
+            })
+            .disposed(by: disposeBag)
+    }
+
+    /// Signature of a query, starting with the document id prefix of the queried type.
+    ///
+    /// - Parameters:
+    ///   - type: The queried document type.
+    ///   - parts: What makes the query unique.
+    /// - Returns: The signature.
+    static func signature(_ type: BaseModel.Type, _ parts: [String]) -> String {
+        return ([type.documentIDPrefix] + parts).joined(separator: "|")
+    }
+
+    /// Get the cached row count of a query, counting if not yet cached.
+    ///
+    /// - Parameters:
+    ///   - signature: The query signature.
+    ///   - load: Count the rows.
+    /// - Returns: The row count.
+    func count(_ signature: String, _ load: () -> Int) -> Int {
+        lock.lock()
+        let cached = summaries[signature]
+        lock.unlock()
+        if let count = cached {
+            return count
+        }
+        let count = load()
+        lock.lock()
+        summaries[signature] = count
+        lock.unlock()
+        return count
+    }
+
+    /// Load a page of a query. The query must use `startKey`/`endKey` (not `keys`) and must not set
+    /// `skip`/`limit`. When the continuation key is not given, the page starts from the remembered
+    /// start of the page or of the closest page before it.
+    ///
+    /// - Parameters:
+    ///   - signature: The query signature.
+    ///   - query: The query to page through.
+    ///   - page: The page number, starting from 1.
+    ///   - pageSize: The page size, 0 to load all rows.
+    ///   - next: The continuation key returned with the previous page.
+    /// - Returns: The rows and the continuation key of the next page.
+    func page(_ signature: String, of query: CBLQuery, page: UInt, pageSize: UInt, after next: String? = nil) -> QueryPage {
+        guard pageSize > 0 else {
+            return (run(query), nil)
+        }
+        let page = max(page, 1)
+        var start: Cursor? = next.flatMap { Cursor($0) }
+        var skipped: UInt = 0
+        if start == nil && page > 1 {
+            lock.lock()
+            // Page starts of other page sizes are not page starts of this one
+            let known = anchors[signature]?[pageSize] ?? [:]
+            lock.unlock()
+            if let closest = known.keys.filter({ $0 <= page }).max(), let anchor = known[closest] {
+                start = anchor
+                skipped = (page - closest) * pageSize
+            } else {
+                skipped = (page - 1) * pageSize
+            }
+        }
+        if let start = start {
+            query.startKey = start.key
+            query.startKeyDocID = start.docID
+        }
+        query.skip = skipped
+        // One more row to know where the next page starts
+        query.limit = pageSize + 1
+        var rows = run(query)
+        var following: Cursor? = nil
+        if rows.count > Int(pageSize), let last = rows.popLast(), let docID = last.documentID, let key = last.key {
+            following = Cursor(key: key, docID: docID)
+        }
+        lock.lock()
+        if let first = rows.first, let docID = first.documentID, let key = first.key {
+            anchors[signature, default: [:]][pageSize, default: [:]][page] = Cursor(key: key, docID: docID)
+        }
+        if let following = following {
+            anchors[signature, default: [:]][pageSize, default: [:]][page + 1] = following
+        }
+        lock.unlock()
+        return (rows, following?.encoded)
+    }
+
+    /// Drop all cached summaries and page starts.
+    func reset() {
+        lock.lock()
+        summaries = [:]
+        anchors = [:]
+        lock.unlock()
+    }
+
+    fileprivate func run(_ query: CBLQuery) -> [CBLQueryRow] {
+        do {
+            return try query.run().compactMap { $0 as? CBLQueryRow }
+        } catch {
+            e("Could not run query \(query.view?.name ?? ""): \(error)")
+            return []
+        }
+    }
+
+    /// Drop the cache of the types of the changed documents.
+    fileprivate func invalidate(_ docIDs: [String]) {
+        let prefixes = Set(docIDs.compactMap { docID in docID.components(separatedBy: "_").first.map { "\($0)|" } })
+        guard !prefixes.isEmpty else { return }
+        lock.lock()
+        defer { lock.unlock() }
+        let changed = { (signature: String) in prefixes.contains { signature.hasPrefix($0) } }
+        summaries = summaries.filter { !changed($0.key) }
+        anchors = anchors.filter { !changed($0.key) }
+    }
+}
@@ -15,6 +15,8 @@ class QueryResult<R: Mappable>: Mappable {
     var rows: [R]
     /// Summary of this query
     var summary: QuerySummary
+    /// Continuation key of the next page, `nil` for the last page.
+    var next: String?
     
     required init?(map: Map) {
         rows = []
@@ -34,5 +36,6 @@ class QueryResult<R: Mappable>: Mappable {
     func mapping(map: Map) {
         rows <- map["rows"]
         summary <- map["summary"]
+        next <- map["next"]
     }
 }
@@ -0,0 +1,475 @@
+//
+//  ReportAggregates.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 8/31/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+import RxSwift
+
+/// A materialized report row, the key is [storeID, day, shift, ...].
+typealias ReportAggregateRow = (key: [Any], value: [String: Any])
+
+/// Materialized report aggregates. The report map blocks are run once per changed order/transaction
+/// and their emitted values are summed into per store/day/shift buckets kept in local (not synced)
+/// documents, one per day. Reports read and group the buckets of the asked days instead of reducing
+/// every document of the range.
+///
+/// Changes are applied by database sequence: after each database change, the documents changed
+/// since the last applied sequence are applied together with the new sequence in one transaction,
+/// so that the aggregates are never ahead nor behind the documents they were built from, even after
+/// a crash. The very first run goes through all the documents once. Deletions are not listed by
+/// sequence: they are taken from the change notifications, and those raised while the app was not
+/// following changes are found once per run by listing the deleted documents still contributing.
+class ReportAggregates {
+
+    /// The aggregated reports.
+    enum Group: String {
+        /// store/day/shift/server
+        case employee
+        /// store/day/shift/area/driver
+        case area
+        /// store/day/shift/transaction type/card type
+        case paymentType = "payment_type"
+    }
+
+    /// Fields that are not summed, the first value is kept.
+    fileprivate static let textFields: Set<String> = ["name", "area_name", "driver_name", "delivery"]
+    /// Fields that are summed as integer, the others are summed as double.
+    fileprivate static let intFields: Set<String> = ["count", "guests", "opening", "closing"]
+    fileprivate static let checkpointID = "report_aggregates"
+
+    let disposeBag = DisposeBag()
+
+    fileprivate let lock = NSRecursiveLock()
+    fileprivate let database: CBLDatabase
+    fileprivate let maps: [Group: CBLMapBlock]
+    fileprivate let prefixes: [String]
+    /// Buckets of recently read days.
+    fileprivate var cache: [String: [String: Any]] = [:]
+    /// The deletions not applied by a previous run were looked for.
+    fileprivate var deletionsChecked = false
+
+    /// Create the aggregates.
+    ///
+    /// - Parameters:
+    ///   - database: The database to follow changes of.
+    ///   - maps: The map block of each report, emitting [storeID, day, shift, ...] keys.
+    ///   - types: The documents types to aggregate.
+    init(database: CBLDatabase, maps: [Group: CBLMapBlock], types: [BaseModel.Type]) {
+        self.database = database
+        self.maps = maps
+        self.prefixes = types.map { "\($0.documentIDPrefix)_" }
+        NotificationCenter.default.rx
+            .notification(.cblDatabaseChange, object: database)
+            .subscribe(onNext: { notification in
+                guard let changes = notification.userInfo?["changes"] as? [CBLDatabaseChange] else { return }
+                let docIDs = changes.map { $0.documentID }.filter { self.aggregates($0) }
+                guard docIDs.isNotEmpty else { return }
+                self.catchUp(deleted: docIDs.filter { docID in
+                    self.database.existingDocument(withID: docID)?.isDeleted ?? true
+                })
+            })
+            .disposed(by: disposeBag)
+    }
+
+    /// Get the rows of a report for a store and a range of days, finest grouped.
+    ///
+    /// - Parameters:
+    ///   - group: The report.
+    ///   - storeID: The store.
+    ///   - fromDate: The first day.
+    ///   - toDate: The last day.
+    ///   - shift: The shift, 0 for all shifts.
+    /// - Returns: The rows ordered by key.
+    func rows(_ group: Group, of storeID: String, fromDate: Date, toDate: Date, shift: Int) -> [ReportAggregateRow] {
+        catchUp()
+        var rows: [ReportAggregateRow] = []
+        lock.lock()
+        for day in ReportAggregates.days(from: fromDate, to: toDate) {
+            let buckets = ((self.buckets(of: day)[storeID] as? [String: Any])?[group.rawValue] as? [String: [String: Any]]) ?? [:]
+            for bucket in buckets.values {
+                guard let key = bucket["key"] as? [Any], let value = bucket["value"] as? [String: Any] else { continue }
+                if shift > 0 && (key.first as? Int) != shift { continue }
+                rows.append((key: [storeID, day] + key, value: value))
+            }
+        }
+        lock.unlock()
+        return rows.sorted { ReportAggregates.compare($0.key, $1.key) }
+    }
+
+    /// Group rows on the first `level` elements of their keys, the same way a view query with
+    /// `groupLevel` would. The reduced values also have `count`, `shifts` and optionally `servers`.
+    ///
+    /// - Parameters:
+    ///   - rows: The rows ordered by key.
+    ///   - level: The number of key elements to group on, 0 for a single summary row.
+    ///   - servers: `true` to list the servers (4th key element) of each group.
+    /// - Returns: The grouped rows.
+    static func reduce(_ rows: [ReportAggregateRow], level: Int, servers: Bool = false) -> [ReportAggregateRow] {
+        var grouped: [ReportAggregateRow] = []
+        var shifts: [Int] = []
+        var serverIDs: [String] = []
+        let close = {
+            guard var last = grouped.popLast() else { return }
+            last.value["shifts"] = shifts.unique().sorted()
+            if servers {
+                last.value["servers"] = serverIDs.unique()
+            }
+            grouped.append(last)
+        }
+        for row in rows {
+            let key = Array(row.key.prefix(level))
+            if let last = grouped.last, compare(last.key, key) == false, compare(key, last.key) == false {
+                grouped[grouped.count - 1].value = merge(last.value, row.value)
+            } else {
+                close()
+                grouped.append((key: key, value: merge([:], row.value)))
+                shifts = []
+                serverIDs = []
+            }
+            if row.key.count > 2, let shift = row.key[2] as? Int {
+                shifts.append(shift)
+            }
+            if row.key.count > 3, let server = row.key[3] as? String {
+                serverIDs.append(server)
+            }
+        }
+        close()
+        return grouped
+    }
+
+    /// Apply the changes not applied yet, the very first time going through all the documents, so
+    /// that the first report does not wait for it.
+    func warmUp() {
+        catchUp()
+    }
+
+    /// Drop all the aggregates, they are rebuilt on next read from the live documents only: the
+    /// contributions of the archived ones are lost.
+    func reset() {
+        lock.lock()
+        defer { lock.unlock() }
+        let days = (database.existingLocalDocument(withID: ReportAggregates.checkpointID)?["days"] as? [String]) ?? []
+        _ = database.inTransaction {
+            for day in days {
+                try? self.database.putLocalDocument(nil, withID: "report_aggregates_\(day)")
+                try? self.database.putLocalDocument(nil, withID: "report_sources_\(day)")
+            }
+            try? self.database.putLocalDocument(nil, withID: ReportAggregates.checkpointID)
+            return true
+        }
+        cache = [:]
+    }
+
+    /// Keep the contributions of documents that are about to be purged (archived), so that their
+    /// removal does not take them out of the aggregates.
+    ///
+    /// - Parameter docIDs: The documents to be purged.
+    /// - Returns: The detached contributions by day then document, to attach back if the documents are not purged.
+    /// - Throws: `DatabaseError.couldNotSaveDocument` if the sources could not be saved.
+    @discardableResult
+    func detach(_ docIDs: [String]) throws -> [String: [String: Any]] {
+        lock.lock()
+        defer { lock.unlock() }
+        // Make sure their last contributions are in
+        catchUp()
+        var byDay: [String: [String]] = [:]
+        for docID in docIDs where aggregates(docID) {
+            guard let day = ReportAggregates.day(of: docID) else { continue }
+            byDay[day, default: []].append(docID)
+        }
+        var detached: [String: [String: Any]] = [:]
+        var failure: Error? = nil
+        _ = database.inTransaction {
+            do {
+                for (day, docIDs) in byDay {
+                    var sources = (self.database.existingLocalDocument(withID: "report_sources_\(day)") ?? [:]).filter { !$0.key.hasPrefix("_") }
+                    for docID in docIDs {
+                        detached[day, default: [:]][docID] = sources[docID]
+                        sources[docID] = nil
+                    }
+                    try self.database.putLocalDocument(sources, withID: "report_sources_\(day)")
+                }
+                return true
+            } catch {
+                failure = error
+                return false
+            }
+        }
+        if let error = failure {
+            throw DatabaseError.couldNotSaveDocument(error: error)
+        }
+        return detached
+    }
+
+    /// Attach back the contributions of documents detached then not purged, for their next changes
+    /// to replace them. The aggregates themselves did not change.
+    ///
+    /// - Parameter detached: The contributions returned by `detach`.
+    func attach(_ detached: [String: [String: Any]]) {
+        lock.lock()
+        defer { lock.unlock() }
+        _ = database.inTransaction {
+            do {
+                for (day, contributions) in detached {
+                    var sources = (self.database.existingLocalDocument(withID: "report_sources_\(day)") ?? [:]).filter { !$0.key.hasPrefix("_") }
+                    // Applied again since, already attached
+                    for (docID, contribution) in contributions where sources[docID] == nil {
+                        sources[docID] = contribution
+                    }
+                    try self.database.putLocalDocument(sources, withID: "report_sources_\(day)")
+                }
+                return true
+            } catch {
+                e("[ReportAggregates] Could not attach back \(detached.count) days: \(error)")
+                return false
+            }
+        }
+    }
+
+    // MARK: - Applying changes
+
+    fileprivate func aggregates(_ docID: String) -> Bool {
+        return prefixes.contains { docID.hasPrefix($0) }
+    }
+
+    /// Apply the documents changed since the last applied sequence.
+    ///
+    /// - Parameter deleted: Deleted documents, not listed by sequence.
+    fileprivate func catchUp(deleted: [String] = []) {
+        lock.lock()
+        defer { lock.unlock() }
+        let checkpoint = database.existingLocalDocument(withID: ReportAggregates.checkpointID) ?? [:]
+        let applied = (checkpoint["sequence"] as? NSNumber)?.uint64Value ?? 0
+        var deleted = deleted
+        // A deletion also moves the sequence, nothing was missed otherwise
+        if !deletionsChecked, applied > 0, applied < database.lastSequenceNumber {
+            deleted += missedDeletions()
+        }
+        deletionsChecked = true
+        guard applied < database.lastSequenceNumber || deleted.isNotEmpty else { return }
+        let start = Date()
+
+        var changed: [(String, [String: Any]?)] = deleted.map { ($0, nil) }
+        var sequence = applied
+        let query = database.createAllDocumentsQuery()
+        query.allDocsMode = .bySequence
+        query.descending = true
+        query.prefetch = true
+        // A document is listed once, at its last sequence
+        query.limit = UInt(database.lastSequenceNumber - min(applied, database.lastSequenceNumber))
+        do {
+            for r in try query.run() {
+                guard let row = r as? CBLQueryRow else { continue }
+                // Newest first, stop at what was already applied
+                guard row.sequenceNumber > applied else { break }
+                sequence = max(sequence, row.sequenceNumber)
+                guard let docID = row.documentID, aggregates(docID) else { continue }
+                changed.append((docID, row.documentProperties))
+            }
+        } catch {
+            e("[ReportAggregates] Could not list changes: \(error)")
+            return
+        }
+
+        var days = Set((checkpoint["days"] as? [String]) ?? [])
+        let done = database.inTransaction {
+            var byDay: [String: [(String, [String: Any]?)]] = [:]
+            for change in changed {
+                guard let day = ReportAggregates.day(of: change.0) else { continue }
+                byDay[day, default: []].append(change)
+            }
+            do {
+                for (day, changes) in byDay {
+                    if try self.apply(changes, to: day) {
+                        days.insert(day)
+                    }
+                }
+                try self.database.putLocalDocument(["sequence": NSNumber(value: sequence), "days": Array(days)], withID: ReportAggregates.checkpointID)
+                return true
+            } catch {
+                e("[ReportAggregates] Could not save aggregates: \(error)")
+                return false
+            }
+        }
+        if !done {
+            // Rolled back, read again from the database
+            cache = [:]
+        } else if changed.count > 100 {
+            d("[ReportAggregates] Applied \(changed.count) documents in \(Int(Date().timeIntervalSince(start) * 1000))ms")
+        }
+    }
+
+    /// The deleted documents still contributing to the aggregates, deleted while not following the
+    /// database changes. Must be called with the lock held.
+    ///
+    /// - Returns: The deleted documents.
+    fileprivate func missedDeletions() -> [String] {
+        var deleted: [String] = []
+        var sources: [String: [String: Any]] = [:]
+        for prefix in prefixes {
+            let query = database.createAllDocumentsQuery()
+            query.allDocsMode = .includeDeleted
+            query.startKey = prefix
+            query.endKey = "\(prefix)\u{FFFF}"
+            do {
+                for r in try query.run() {
+                    guard let row = r as? CBLQueryRow, let docID = row.documentID,
+                        ((row.value as? [String: Any])?["deleted"] as? Bool) == true,
+                        let day = ReportAggregates.day(of: docID) else { continue }
+                    if sources[day] == nil {
+                        sources[day] = database.existingLocalDocument(withID: "report_sources_\(day)") ?? [:]
+                    }
+                    if sources[day]?[docID] != nil {
+                        deleted.append(docID)
+                    }
+                }
+            } catch {
+                e("[ReportAggregates] Could not list deleted documents: \(error)")
+            }
+        }
+        if deleted.isNotEmpty {
+            d("[ReportAggregates] Found \(deleted.count) deletions not applied")
+        }
+        return deleted
+    }
+
+    /// Replace the contributions of the changed documents of a day. Changes not altering what a
+    /// document contributes (open orders, printing flags...) are skipped, and so is the write when
+    /// none of them does.
+    ///
+    /// - Returns: `true` if the aggregates of the day changed.
+    fileprivate func apply(_ changes: [(String, [String: Any]?)], to day: String) throws -> Bool {
+        var buckets = self.buckets(of: day)
+        // Without local document meta
+        var sources = (database.existingLocalDocument(withID: "report_sources_\(day)") ?? [:]).filter { !$0.key.hasPrefix("_") }
+        var changed = false
+        for (docID, properties) in changes {
+            let previous = (sources[docID] as? [[String: Any]]) ?? []
+            let current = contributions(of: properties)
+            guard !(previous as NSArray).isEqual(to: current) else { continue }
+            changed = true
+            // Take out the previous contributions ...
+            for contribution in previous {
+                guard let storeID = contribution["store"] as? String,
+                    let group = contribution["group"] as? String,
+                    let key = contribution["key"] as? [Any],
+                    let value = contribution["value"] as? [String: Any] else { continue }
+                ReportAggregates.add(value, to: &buckets, storeID, group, key, sign: -1)
+            }
+            // ... and put the current ones
+            for contribution in current {
+                guard let storeID = contribution["store"] as? String,
+                    let group = contribution["group"] as? String,
+                    let key = contribution["key"] as? [Any],
+                    let value = contribution["value"] as? [String: Any] else { continue }
+                ReportAggregates.add(value, to: &buckets, storeID, group, key, sign: 1)
+            }
+            sources[docID] = current.isEmpty ? nil : current
+        }
+        guard changed else { return false }
+        try database.putLocalDocument(buckets, withID: "report_aggregates_\(day)")
+        try database.putLocalDocument(sources, withID: "report_sources_\(day)")
+        cache[day] = buckets
+        return true
+    }
+
+    /// What a document contributes to the reports, by running the report map blocks on it.
+    ///
+    /// - Parameter properties: The document properties, `nil` if deleted.
+    /// - Returns: The contributions, with their store, group, key (without store and day) and value.
+    fileprivate func contributions(of properties: [String: Any]?) -> [[String: Any]] {
+        guard let properties = properties, properties["_deleted"] == nil else { return [] }
+        var contributions: [[String: Any]] = []
+        // Same order for the same document, to be compared with the saved ones
+        for group in [Group.employee, .area, .paymentType] {
+            guard let map = maps[group] else { continue }
+            map(properties) { key, value in
+                guard let key = key as? [Any], key.count > 2,
+                    let storeID = key[0] as? String,
+                    var value = value as? [String: Any] else { return }
+                value["count"] = 1
+                contributions.append(["store": storeID, "group": group.rawValue, "key": Array(key[2...]), "value": value])
+            }
+        }
+        return contributions
+    }
+
+    /// Buckets of a day, by store, group then key.
+    fileprivate func buckets(of day: String) -> [String: Any] {
+        if let buckets = cache[day] {
+            return buckets
+        }
+        // Without local document meta
+        let buckets = (database.existingLocalDocument(withID: "report_aggregates_\(day)") ?? [:]).filter { !$0.key.hasPrefix("_") }
+        if cache.count > 62 {
+            cache = [:]
+        }
+        cache[day] = buckets
+        return buckets
+    }
+
+    // MARK: - Helpers
+
+    fileprivate static func add(_ value: [String: Any], to buckets: inout [String: Any], _ storeID: String, _ group: String, _ key: [Any], sign: Int) {
+        let keyString = key.map { "\($0)" }.joined(separator: "\t")
+        var store = (buckets[storeID] as? [String: Any]) ?? [:]
+        var groupBuckets = (store[group] as? [String: [String: Any]]) ?? [:]
+        let current = (groupBuckets[keyString]?["value"] as? [String: Any]) ?? [:]
+        let updated = merge(current, value, sign: sign)
+        groupBuckets[keyString] = (updated["count"] as? Int ?? 0) > 0 ? ["key": key, "value": updated] : nil
+        store[group] = groupBuckets
+        buckets[storeID] = store
+    }
+
+    /// Sum two values.
+    fileprivate static func merge(_ lhs: [String: Any], _ rhs: [String: Any], sign: Int = 1) -> [String: Any] {
+        var merged = lhs
+        for (field, value) in rhs {
+            if textFields.contains(field) {
+                if merged[field] == nil { merged[field] = value }
+            } else if intFields.contains(field) {
+                merged[field] = (lhs[field] as? Int ?? 0) + sign * (value as? Int ?? 0)
+            } else if field != "shifts" && field != "servers" {
+                merged[field] = (lhs[field] as? Double ?? 0) + Double(sign) * (value as? Double ?? 0)
+            }
+        }
+        return merged
+    }
+
+    /// Order keys the way views do for the strings and numbers they contain.
+    fileprivate static func compare(_ lhs: [Any], _ rhs: [Any]) -> Bool {
+        for (l, r) in zip(lhs, rhs) {
+            if let l = l as? Int, let r = r as? Int {
+                if l != r { return l < r }
+            } else {
+                let l = "\(l)", r = "\(r)"
+                if l != r { return l < r }
+            }
+        }
+        return lhs.count < rhs.count
+    }
+
+    /// Day (yyMMdd) of an order/transaction document, from its id.
+    fileprivate static func day(of docID: String) -> String? {
+        guard let separator = docID.index(of: "_") else { return nil }
+        let id = docID[docID.index(after: separator)...]
+        guard id.count > 6 else { return nil }
+        return String(id.prefix(6))
+    }
+
+    /// Days (yyMMdd) of a dates range.
+    fileprivate static func days(from fromDate: Date, to toDate: Date) -> [String] {
+        var days: [String] = []
+        var date = Calendar.current.startOfDay(for: fromDate)
+        while date <= toDate && days.count < 3660 {
+            days.append(date.toString("yyMMdd"))
+            guard let next = Calendar.current.date(byAdding: .day, value: 1, to: date) else { break }
+            date = next
+        }
+        return days
+    }
+}
@@ -0,0 +1,334 @@
+//
+//  ShiftArchive.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 9/1/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+/// Values of an archived column.
+enum ArchiveColumn {
+    case strings([String])
+    case ints([Int64])
+    case doubles([Double])
+
+    var count: Int {
+        switch self {
+        case let .strings(values): return values.count
+        case let .ints(values): return values.count
+        case let .doubles(values): return values.count
+        }
+    }
+}
+
+/// The archived documents of a store/day, with the requested columns only.
+struct ArchiveBatch {
+    /// The day (yyMMdd).
+    let day: String
+    /// Number of archived documents.
+    let count: Int
+    let columns: [String: ArchiveColumn]
+
+    func strings(_ name: String) -> [String] {
+        if case let .strings(values)? = columns[name] { return values }
+        return []
+    }
+
+    func ints(_ name: String) -> [Int64] {
+        if case let .ints(values)? = columns[name] { return values }
+        return []
+    }
+
+    func doubles(_ name: String) -> [Double] {
+        if case let .doubles(values)? = columns[name] { return values }
+        return []
+    }
+
+    /// The full documents properties, when the `document` column was requested.
+    var documents: [[String: Any]] {
+        return strings("document").compactMap { json in
+            (try? JSONSerialization.jsonObject(with: Data(json.utf8))) as? [String: Any]
+        }
+    }
+}
+
+/// Archive of closed orders and settled transactions, kept out of the live database in columnar
+/// segment files, one per store/day. Each column is compressed on its own so that scanning reads
+/// and inflates only the columns it asks for; the full document is kept in the `document` column.
+///
+/// Segment layout (little endian):
+///
+///     "KSEG" | version u8 | rows u32 | columns u16
+///     column: name (u32 length + utf8) | kind u8 | codec u8 | raw length u32 | stored length u32 | stored bytes
+class ShiftArchive {
+
+    fileprivate enum Kind: UInt8 {
+        case string = 1
+        case int = 2
+        case double = 3
+    }
+
+    fileprivate enum Codec: UInt8 {
+        case raw = 0
+        case zlib = 1
+    }
+
+    /// Definition of the archived columns.
+    fileprivate static let definitions: [(String, Kind, ([String: Any]) -> Any)] = [
+        ("doc_id", .string, { _ in "" }),
+        ("type", .string, { $0["type"] as? String ?? "" }),
+        ("shift_id", .string, { ($0["shift_id"] as? String) ?? ($0["shift"] as? String) ?? "" }),
+        ("shift", .int, { Int64(($0["shift_index"] as? Int) ?? ($0["shift"] as? Int) ?? 0) }),
+        ("status", .string, { $0["status"] as? String ?? "" }),
+        ("number", .int, { Int64(($0["order_no"] as? Int) ?? ($0["trans_num"] as? Int) ?? 0) }),
+        ("area", .string, { $0["area"] as? String ?? "" }),
+        ("employee", .string, { $0["created_by"] as? String ?? "" }),
+        ("total", .double, { properties in
+            if let amount = properties["approved_amount"] as? Double { return amount }
+            let bills = (properties["bills"] as? [[String: Any]]) ?? []
+            return bills.filter { !($0["voided"] as? Bool ?? false) }.reduce(0.0) { $0 + ($1["total"] as? Double ?? 0) }
+        }),
+        ("tip", .double, { properties in
+            if let tip = properties["tip_amount"] as? Double { return tip }
+            let bills = (properties["bills"] as? [[String: Any]]) ?? []
+            return bills.filter { !($0["voided"] as? Bool ?? false) }.reduce(0.0) { $0 + ($1["tip"] as? Double ?? 0) }
+        }),
+        ("document", .string, { properties in
+            guard let data = try? JSONSerialization.data(withJSONObject: properties) else { return "" }
+            return String(data: data, encoding: .utf8) ?? ""
+        })
+    ]
+
+    /// Days of live data to keep before archiving, refunds and reprints need the recent documents.
+    var retentionDays = 7
+
+    /// The default archive directory.
+    static var defaultDirectory: String {
+        let dir = NSSearchPathForDirectoriesInDomains(.applicationSupportDirectory, .userDomainMask, true).first ?? NSTemporaryDirectory()
+        return "\(dir)/archive"
+    }
+
+    fileprivate let directory: String
+    fileprivate let lock = NSLock()
+
+    /// Create the archive.
+    ///
+    /// - Parameter directory: Where the segment files are kept.
+    init(directory: String = ShiftArchive.defaultDirectory) {
+        self.directory = directory
+    }
+
+    /// Add documents to the segment of a store/day, replacing the already archived ones. The segment
+    /// is written to disk and synced before returning, so the documents can then be purged.
+    ///
+    /// - Parameters:
+    ///   - documents: The document id and properties to archive.
+    ///   - storeID: The store.
+    ///   - day: The day (yyMMdd).
+    /// - Throws: `DatabaseError.couldNotSaveDocument` if the segment could not be written.
+    func append(_ documents: [(String, [String: Any])], of storeID: String, day: String) throws {
+        guard documents.isNotEmpty else { return }
+        lock.lock()
+        defer { lock.unlock() }
+        let path = self.path(of: storeID, day: day)
+        // Existing rows first, minus those archived again
+        let archiving = Set(documents.map { $0.0 })
+        var rows: [[Any]] = []
+        if let segment = read(path, columns: nil) {
+            let keep = segment.strings("doc_id").map { !archiving.contains($0) }
+            for index in 0..<segment.count where keep[index] {
+                rows.append(ShiftArchive.definitions.map { definition -> Any in
+                    switch segment.columns[definition.0] {
+                    case let .strings(values)?: return values[index]
+                    case let .ints(values)?: return values[index]
+                    case let .doubles(values)?: return values[index]
+                    case nil: return ""
+                    }
+                })
+            }
+        }
+        for (docID, properties) in documents {
+            rows.append(ShiftArchive.definitions.map { definition in
+                definition.0 == "doc_id" ? docID : definition.2(properties)
+            })
+        }
+        try write(rows, to: path)
+    }
+
+    /// Scan the archived documents of a store, one batch per day.
+    ///
+    /// - Parameters:
+    ///   - storeID: The store.
+    ///   - fromDate: The first day.
+    ///   - toDate: The last day.
+    ///   - columns: The columns to read.
+    ///   - body: Called with each archived day.
+    func scan(_ storeID: String, fromDate: Date, toDate: Date, columns: [String], _ body: (ArchiveBatch) throws -> Void) rethrows {
+        let from = fromDate.toString("yyMMdd"), to = toDate.toString("yyMMdd")
+        let days = ((try? FileManager.default.contentsOfDirectory(atPath: "\(directory)/\(storeID)")) ?? [])
+            .filter { $0.hasSuffix(".kseg") }
+            .map { String($0.prefix(6)) }
+            .filter { $0 >= from && $0 <= to }
+            .sorted()
+        for day in days {
+            lock.lock()
+            let batch = read(path(of: storeID, day: day), columns: Set(columns))
+            lock.unlock()
+            if let batch = batch {
+                try body(batch)
+            }
+        }
+    }
+
+    // MARK: - Segment file
+
+    fileprivate func path(of storeID: String, day: String) -> String {
+        return "\(directory)/\(storeID)/\(day).kseg"
+    }
+
+    /// Must be called with `lock`.
+    fileprivate func write(_ rows: [[Any]], to path: String) throws {
+        var data = Data()
+        data.append(contentsOf: Array("KSEG".utf8))
+        data.append(1)
+        data.append(segment: UInt32(rows.count))
+        data.append(segment: UInt16(ShiftArchive.definitions.count))
+        for (index, definition) in ShiftArchive.definitions.enumerated() {
+            var raw = Data()
+            for row in rows {
+                switch definition.1 {
+                case .string: raw.append(segment: row[index] as? String ?? "")
+                case .int: raw.append(segment: UInt64(bitPattern: row[index] as? Int64 ?? 0))
+                case .double: raw.append(segment: (row[index] as? Double ?? 0).bitPattern)
+                }
+            }
+            let compressed = raw.count > 64 ? raw.deflated() : nil
+            let codec: Codec = compressed == nil ? .raw : .zlib
+            let stored = compressed ?? raw
+            data.append(segment: definition.0)
+            data.append(definition.1.rawValue)
+            data.append(codec.rawValue)
+            data.append(segment: UInt32(raw.count))
+            data.append(segment: UInt32(stored.count))
+            data.append(stored)
+        }
+        try FileManager.default.createDirectory(atPath: (path as NSString).deletingLastPathComponent, withIntermediateDirectories: true, attributes: nil)
+        let tmp = "\(path).tmp"
+        guard FileManager.default.createFile(atPath: tmp, contents: data, attributes: nil) else {
+            throw DatabaseError.couldNotSaveDocument(error: CocoaError(.fileWriteUnknown))
+        }
+        let fd = open(tmp, O_WRONLY)
+        if fd >= 0 {
+            fsync(fd)
+            close(fd)
+        }
+        guard rename(tmp, path) == 0 else {
+            throw DatabaseError.couldNotSaveDocument(error: CocoaError(.fileWriteUnknown))
+        }
+    }
+
+    /// Read a segment, `nil` columns to read them all. Must be called with `lock`.
+    fileprivate func read(_ path: String, columns: Set<String>?) -> ArchiveBatch? {
+        guard let data = try? Data(contentsOf: URL(fileURLWithPath: path), options: .alwaysMapped) else { return nil }
+        var reader = SegmentReader(data: data)
+        guard let magic = reader.bytes(4), magic == Data("KSEG".utf8), reader.uint8() == 1,
+            let rows = reader.uint32(), let count = reader.uint16() else {
+                e("[ShiftArchive] Bad segment \(path)")
+                return nil
+        }
+        var read: [String: ArchiveColumn] = [:]
+        for _ in 0..<count {
+            guard let name = reader.string(),
+                let kind = reader.uint8().flatMap({ Kind(rawValue: $0) }),
+                let codec = reader.uint8().flatMap({ Codec(rawValue: $0) }),
+                let rawLength = reader.uint32(),
+                let storedLength = reader.uint32(),
+                let stored = reader.bytes(Int(storedLength)) else {
+                    e("[ShiftArchive] Truncated segment \(path)")
+                    return nil
+            }
+            // Only inflate what is asked for
+            guard columns?.contains(name) ?? true else { continue }
+            guard let raw = codec == .zlib ? stored.inflated(count: Int(rawLength)) : stored else {
+                e("[ShiftArchive] Bad column \(name) of \(path)")
+                return nil
+            }
+            var values = SegmentReader(data: raw)
+            switch kind {
+            case .string: read[name] = .strings((0..<rows).map { _ in values.string() ?? "" })
+            case .int: read[name] = .ints((0..<rows).map { _ in Int64(bitPattern: values.uint64() ?? 0) })
+            case .double: read[name] = .doubles((0..<rows).map { _ in Double(bitPattern: values.uint64() ?? 0) })
+            }
+        }
+        let day = String(((path as NSString).lastPathComponent).prefix(6))
+        return ArchiveBatch(day: day, count: Int(rows), columns: read)
+    }
+}
+
+fileprivate extension Data {
+    mutating func append(segment value: UInt16) {
+        var value = value.littleEndian
+        append(Data(bytes: &value, count: 2))
+    }
+
+    mutating func append(segment value: UInt32) {
+        var value = value.littleEndian
+        append(Data(bytes: &value, count: 4))
+    }
+
+    mutating func append(segment value: UInt64) {
+        var value = value.littleEndian
+        append(Data(bytes: &value, count: 8))
+    }
+
+    /// Append a string prefixed with its UTF8 length on 4 bytes.
+    mutating func append(segment string: String) {
+        let utf8 = Data(string.utf8)
+        append(segment: UInt32(utf8.count))
+        append(utf8)
+    }
+}
+
+/// Sequential reader of segment files, returning `nil` when there is not enough data.
+fileprivate struct SegmentReader {
+    let data: Data
+    var offset = 0
+
+    init(data: Data) {
+        self.data = data
+    }
+
+    mutating func bytes(_ count: Int) -> Data? {
+        guard count >= 0, offset + count <= data.count else { return nil }
+        let start = data.startIndex + offset
+        offset += count
+        return data.subdata(in: start..<(start + count))
+    }
+
+    mutating func uint8() -> UInt8? {
+        return bytes(1)?.first
+    }
+
+    mutating func uint16() -> UInt16? {
+        guard let b = bytes(2) else { return nil }
+        return UInt16(b[b.startIndex]) | UInt16(b[b.startIndex + 1]) << 8
+    }
+
+    mutating func uint32() -> UInt32? {
+        guard let b = bytes(4) else { return nil }
+        return (0..<4).reduce(UInt32(0)) { $0 | UInt32(b[b.startIndex + $1]) << UInt32($1 * 8) }
+    }
+
+    mutating func uint64() -> UInt64? {
+        guard let b = bytes(8) else { return nil }
+        return (0..<8).reduce(UInt64(0)) { $0 | UInt64(b[b.startIndex + $1]) << UInt64($1 * 8) }
+    }
+
+    /// A string prefixed with its UTF8 length on 4 bytes.
+    mutating func string() -> String? {
+        guard let length = uint32(), let b = bytes(Int(length)) else { return nil }
+        return String(data: b, encoding: .utf8)
+    }
+}
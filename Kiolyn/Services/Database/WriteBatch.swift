@@ -0,0 +1,99 @@
+//
+//  WriteBatch.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 9/3/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+/// The document written by a batch and its new revision.
+typealias WriteResult = (docID: String, revision: String)
+
+/// Puts and deletes collected to be committed together, all or nothing, in one database
+/// transaction with `Database.commit(_:)`.
+class WriteBatch {
+    enum Operation {
+        /// Save a model.
+        case save(model: BaseModel)
+        /// Save raw properties, validated as `Database.save(properties:)` does.
+        case saveProperties(properties: [String: Any])
+        /// Delete a document.
+        case delete(docID: String)
+    }
+
+    /// The collected operations, in order.
+    fileprivate(set) var operations: [Operation] = []
+
+    /// `true` if there is nothing to commit.
+    var isEmpty: Bool { return operations.isEmpty }
+
+    init() { }
+
+    /// Save a model.
+    ///
+    /// - Parameter model: The model to save.
+    func save(_ model: BaseModel) {
+        operations.append(.save(model: model))
+    }
+
+    /// Save multiple models.
+    ///
+    /// - Parameter models: The models to save.
+    func save(all models: [BaseModel]) {
+        operations.append(contentsOf: models.map { .save(model: $0) })
+    }
+
+    /// Save raw properties.
+    ///
+    /// - Parameter properties: The properties to save.
+    func save(properties: [String: Any]) {
+        operations.append(.saveProperties(properties: properties))
+    }
+
+    /// Delete a model.
+    ///
+    /// - Parameter model: The model to delete.
+    func delete(_ model: BaseModel) {
+        operations.append(.delete(docID: model.documentID))
+    }
+
+    /// Delete multiple models.
+    ///
+    /// - Parameter models: The models to delete.
+    func delete(multi models: [BaseModel]) {
+        operations.append(contentsOf: models.map { .delete(docID: $0.documentID) })
+    }
+
+    /// Delete a document.
+    ///
+    /// - Parameter docID: The document to delete.
+    func delete(_ docID: String) {
+        operations.append(.delete(docID: docID))
+    }
+
+    /// The ids of the models of a type written by this batch, for change events.
+    ///
+    /// - Parameter type: The model type.
+    /// - Returns: The model ids, without duplicates.
+    func ids(of type: BaseModel.Type) -> [String] {
+        let prefix = "\(type.documentIDPrefix)_"
+        var ids: [String] = []
+        for operation in operations {
+            var id: String? = nil
+            switch operation {
+            case let .save(model):
+                id = Swift.type(of: model) == type ? model.id : nil
+            case let .saveProperties(properties):
+                id = (properties["type"] as? String) == type.documentType ? properties["id"] as? String : nil
+            case let .delete(docID):
+                id = docID.hasPrefix(prefix) ? String(docID.dropFirst(prefix.count)) : nil
+            }
+            if let id = id, !ids.contains(id) {
+                ids.append(id)
+            }
+        }
+        return ids
+    }
+}
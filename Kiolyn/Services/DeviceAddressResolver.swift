@@ -0,0 +1,184 @@
+//
+//  DeviceAddressResolver.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 8/27/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+import RxSwift
+import MMLanScan
+
+/// Keep a MAC → IP table of the LAN devices (printers, payment devices) refreshed by background
+/// sweeps, so that printing and payment find a device's IP address without scanning while the
+/// customer is waiting. Only a miss falls back to the targeted (slow) search of the caller.
+class DeviceAddressResolver {
+    /// A discovery returning IP addresses by raw MAC address.
+    typealias Source = () -> [String: String]
+
+    let disposeBag = DisposeBag()
+
+    /// Interval between sweeps.
+    var interval: TimeInterval = 60
+    /// Maximum time for the LAN sweep.
+    var sweepTimeout: TimeInterval = 60
+
+    fileprivate let lock = NSLock()
+    fileprivate var table: [String: String] = [:]
+    fileprivate var sources: [String: Source] = [:]
+    fileprivate let queue = DispatchQueue(label: "com.kiolyn.network.resolver")
+    fileprivate var sweeping: Disposable?
+
+    init() {
+        guard !Configuration.testPrinting else { return }
+        // Sweep while signed in only
+        SP.authService.currentIdentity
+            .asObservable()
+            .map { $0 != nil }
+            .distinctUntilChanged()
+            .subscribe(onNext: { signedIn in
+                if signedIn {
+                    self.start()
+                } else {
+                    self.stop()
+                }
+            })
+            .disposed(by: disposeBag)
+    }
+
+    /// Start sweeping.
+    func start() {
+        stop()
+        let scheduler = SerialDispatchQueueScheduler(queue: queue, internalSerialQueueName: "com.kiolyn.network.resolver")
+        sweeping = Observable<Int>.timer(0, period: interval, scheduler: scheduler)
+            .subscribe(onNext: { _ in self.sweep() })
+    }
+
+    /// Stop sweeping, the known addresses are kept.
+    func stop() {
+        sweeping?.dispose()
+        sweeping = nil
+    }
+
+    /// Add a discovery to be run on every sweep, such as vendor specific printer search.
+    ///
+    /// - Parameters:
+    ///   - name: The source name, registering the same name replaces the previous source.
+    ///   - source: The discovery.
+    func register(source name: String, _ source: @escaping Source) {
+        lock.lock()
+        sources[name] = source
+        lock.unlock()
+    }
+
+    /// Get the last known IP address of a MAC address.
+    ///
+    /// - Parameter mac: The MAC address, with or without `:`.
+    /// - Returns: The IP address or `nil` if not known.
+    func ip(of mac: String) -> String? {
+        lock.lock()
+        defer { lock.unlock() }
+        return table[mac.rawMac.lowercased()]
+    }
+
+    /// Remember the IP address of a MAC address.
+    ///
+    /// - Parameters:
+    ///   - mac: The MAC address, with or without `:`.
+    ///   - ip: The IP address.
+    func record(_ mac: String, ip: String) {
+        let key = mac.rawMac.lowercased()
+        guard key.isNotEmpty, ip.isNotEmpty else { return }
+        lock.lock()
+        let previous = table[key]
+        table[key] = ip
+        lock.unlock()
+        if previous != ip {
+            d("[DeviceAddressResolver] \(key) is at \(ip)")
+        }
+    }
+
+    /// Resolve a MAC address from the table, running `probe` only if the address is unknown
+    /// or is the one which just failed.
+    ///
+    /// - Parameters:
+    ///   - mac: The MAC address, with or without `:`.
+    ///   - failedIP: The IP address which could not be reached, not to be returned from the table.
+    ///   - probe: The targeted search.
+    /// - Returns: The IP address or `nil` if not found.
+    func resolve(_ mac: String, excluding failedIP: String = "", probe: () -> String?) -> String? {
+        if let ip = ip(of: mac), ip != failedIP {
+            return ip
+        }
+        guard let ip = probe(), ip.isNotEmpty else {
+            return nil
+        }
+        record(mac, ip: ip)
+        return ip
+    }
+
+    /// Run all the discoveries and update the table, must be called on `queue`.
+    fileprivate func sweep() {
+        let start = Date()
+        lock.lock()
+        let discoveries = Array(sources.values)
+        lock.unlock()
+        var found = LANSweep().run(timeout: sweepTimeout)
+        for discover in discoveries {
+            for (mac, ip) in discover() {
+                found[mac.rawMac.lowercased()] = ip
+            }
+        }
+        for (mac, ip) in found {
+            record(mac, ip: ip)
+        }
+        v("[DeviceAddressResolver] Swept \(found.count) devices in \(Date().timeIntervalSince(start))s")
+    }
+}
+
+/// A single LAN scan collecting every device having MAC address.
+fileprivate class LANSweep: NSObject, MMLANScannerDelegate {
+    private let done = DispatchSemaphore(value: 0)
+    private let lock = NSLock()
+    private var found: [String: String] = [:]
+    private lazy var scanner = MMLANScanner(delegate: self)
+
+    /// Scan the LAN, blocking the caller.
+    ///
+    /// - Parameter timeout: Maximum time for scanning.
+    /// - Returns: IP addresses by raw MAC address.
+    func run(timeout: TimeInterval) -> [String: String] {
+        guard let scanner = scanner, !scanner.isScanning else {
+            return [:]
+        }
+        scanner.start()
+        if done.wait(timeout: .now() + timeout) == .timedOut {
+            scanner.stop()
+        }
+        lock.lock()
+        defer { lock.unlock() }
+        return found
+    }
+
+    func lanScanDidFailedToScan() {
+        done.signal()
+    }
+
+    func lanScanDidFinishScanning(with status: MMLanScannerStatus) {
+        done.signal()
+    }
+
+    func lanScanProgressPinged(_ pingedHosts: Float, from overallHosts: Int) {
+
+    }
+
+    func lanScanDidFindNewDevice(_ device: MMDevice!) {
+        guard let mac = device.macAddress, let ip = device.ipAddress, ip.isNotEmpty else {
+            return
+        }
+        lock.lock()
+        found[mac.rawMac.lowercased()] = ip
+        lock.unlock()
+    }
+}
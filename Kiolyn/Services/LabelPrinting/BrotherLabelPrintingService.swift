@@ -14,6 +14,16 @@ class BrotherLabelPrintingService: LabelPrintingService {
     
     fileprivate let queue = DispatchQueue(label: "com.kiolyn.labelprinting", attributes: .concurrent)
     
+    init() {
+        guard !Configuration.testPrinting else { return }
+        // Search for the label printers of current store on every sweep
+        SP.addressResolver.register(source: "brother") {
+            let printers: [Printer] = (try? await(SP.dataService.loadAll())) ?? []
+            let models = Set(printers.filter { $0.printerModel.isLabelPrinter }.map { $0.printerModel.name })
+            return BrotherPrinterFinder().findAll(models: Array(models))
+        }
+    }
+    
     /// Build string template for printing items.
     ///
     /// - Parameters:
@@ -94,12 +104,16 @@ class BrotherLabelPrintingService: LabelPrintingService {
         return data
     }
     
-    /// Find a printer's IP address.
+    /// Find a printer's IP address, from the address table when possible.
     ///
-    /// - Parameter printer: the printer to find.
+    /// - Parameters:
+    ///   - printer: the printer to find.
+    ///   - failedIP: the IP address which could not be reached.
     /// - Returns: the printer's IP address in current network.
-    private func findIP(printer: Printer) -> String? {
-        return BrotherPrinterFinder().findIP(printer: printer)
+    private func findIP(printer: Printer, excluding failedIP: String = "") -> String? {
+        return SP.addressResolver.resolve(printer.macAddress, excluding: failedIP) {
+            BrotherPrinterFinder().findIP(printer: printer)
+        }
     }
     
     /// Send an image to printer.
@@ -179,7 +193,9 @@ class BrotherLabelPrintingService: LabelPrintingService {
             // Build and send list of OrderItems
             let buildImages = { (items: [OrderItem], settings: LabelPrintingSettings) throws -> [UIImage] in
                 let content = try self.build(itemsTemplate: items, ofOrder: order, withType: type, and: settings)
-                let image = content.rasterize(width: 720)
+                guard let image = MonochromeRaster.image(of: content, width: 720) else {
+                    throw PrintError.printingError(detail: "Could not render label")
+                }
                 if settings.printSeparateItem, items.count == 1, let item = items.first {
                     return [UIImage](repeating: image, count: Int(item.count))
                 } else {
@@ -211,7 +227,7 @@ class BrotherLabelPrintingService: LabelPrintingService {
                 w("Failed sending data to printer \(error)")
                 // IP might changed, so try to find the printer again
                 // if the printer is found with same IP, something is wrong
-                guard let ip = self.findIP(printer: printer), ip.isNotEmpty else {
+                guard let ip = self.findIP(printer: printer, excluding: printer.ipAddress), ip.isNotEmpty else {
                     throw PrintError.printerNotFound
                 }
                 // IP is found and the same as before, so it's some different error
@@ -243,22 +259,34 @@ private class BrotherPrinterFinder: NSObject, BRPtouchNetworkDelegate {
     /// - Parameter printer: the printer to find.
     /// - Returns: the found IP or nothing.
     func findIP(printer: Printer) -> String? {
-        networkManager = BRPtouchNetworkManager(printerName: printer.printerModel.name)
+        return findAll(models: [printer.printerModel.name])[printer.macAddress.rawMac.lowercased()]
+    }
+    
+    /// Find all the printers of the given models.
+    ///
+    /// - Parameter models: the printer model names.
+    /// - Returns: the found IPs by raw MAC address.
+    func findAll(models: [String]) -> [String: String] {
+        guard let model = models.first else {
+            return [:]
+        }
+        networkManager = BRPtouchNetworkManager(printerName: model)
         guard let nm = networkManager else {
-            return nil
+            return [:]
         }
         nm.delegate = self
         nm.isEnableIPv6Search = false
-        nm.setPrinterNames([printer.printerModel.name])
+        nm.setPrinterNames(models)
         DispatchQueue.main.async {
             nm.startSearch(5)
         }
         _ = self.semaphore.wait(timeout: .distantFuture)
-        return nm.getPrinterNetInfo()
-            .map { info in info as? BRPtouchDeviceInfo }
-            .filterNil()
-            .first { info in info.strMACAddress.rawMac.lowercased() == printer.macAddress.lowercased() }
-            .map { info in info.strIPAddress! }
+        var found: [String: String] = [:]
+        for info in nm.getPrinterNetInfo().map({ info in info as? BRPtouchDeviceInfo }).filterNil() {
+            guard let mac = info.strMACAddress, let ip = info.strIPAddress else { continue }
+            found[mac.rawMac.lowercased()] = ip
+        }
+        return found
     }
     
     func didFinishSearch(_ sender: Any!) {
@@ -0,0 +1,229 @@
+//
+//  MessagePack.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 9/7/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+/// MessagePack errors.
+enum MessagePackError: LocalizedError {
+    /// The value can not be encoded.
+    case unsupported(Any)
+    /// The data ends or has an unknown format.
+    case invalidData
+    
+    var errorDescription: String? {
+        switch self {
+        case let .unsupported(value):
+            return "Can not encode \(type(of: value)) as MessagePack"
+        case .invalidData:
+            return "Invalid MessagePack data"
+        }
+    }
+}
+
+/// MessagePack encoding of JSON objects (nil, bool, numbers, strings, arrays and string keyed maps),
+/// the same objects `JSONSerialization` reads and writes. Numbers and booleans are decoded as
+/// `NSNumber` like `JSONSerialization` does, for ObjectMapper to map them the same.
+enum MessagePack {
+    
+    /// Encode a JSON object.
+    ///
+    /// - Parameter object: The object.
+    /// - Returns: The encoded data.
+    /// - Throws: `MessagePackError.unsupported` if the object is not a JSON object.
+    static func encode(_ object: Any) throws -> Data {
+        var data = Data()
+        try encode(object, into: &data)
+        return data
+    }
+    
+    /// Decode a JSON object.
+    ///
+    /// - Parameter data: The encoded data.
+    /// - Returns: The object.
+    /// - Throws: `MessagePackError.invalidData` if the data is not a single MessagePack object.
+    static func decode(_ data: Data) throws -> Any {
+        return try data.withUnsafeBytes { (bytes: UnsafePointer<UInt8>) -> Any in
+            var reader = Reader(bytes: bytes, count: data.count)
+            let object = try reader.read()
+            guard reader.offset == data.count else {
+                throw MessagePackError.invalidData
+            }
+            return object
+        }
+    }
+    
+    // MARK: - Encode
+    
+    fileprivate static func encode(_ object: Any, into data: inout Data) throws {
+        switch object {
+        case is NSNull:
+            data.append(0xc0)
+        case let string as String:
+            encode(string: string, into: &data)
+        case let number as NSNumber:
+            encode(number: number, into: &data)
+        case let dictionary as [String: Any]:
+            encode(header: dictionary.count, fix: 0x80, fixMax: 15, wide: 0xde, into: &data)
+            for (key, value) in dictionary {
+                encode(string: key, into: &data)
+                try encode(value, into: &data)
+            }
+        case let array as [Any]:
+            encode(header: array.count, fix: 0x90, fixMax: 15, wide: 0xdc, into: &data)
+            for value in array {
+                try encode(value, into: &data)
+            }
+        default:
+            throw MessagePackError.unsupported(object)
+        }
+    }
+    
+    fileprivate static func encode(string: String, into data: inout Data) {
+        let utf8 = Data(string.utf8)
+        if utf8.count <= 31 {
+            data.append(0xa0 | UInt8(utf8.count))
+        } else if utf8.count <= Int(UInt8.max) {
+            data.append(0xd9)
+            data.append(UInt8(utf8.count))
+        } else {
+            encode(header: utf8.count, fix: 0, fixMax: -1, wide: 0xda, into: &data)
+        }
+        data.append(utf8)
+    }
+    
+    /// Header of the str 16/32, array and map formats: `wide` is the 16 bits format, the 32 bits one follows it.
+    fileprivate static func encode(header count: Int, fix: UInt8, fixMax: Int, wide: UInt8, into data: inout Data) {
+        if count <= fixMax {
+            data.append(fix | UInt8(count))
+        } else if count <= Int(UInt16.max) {
+            data.append(wide)
+            append(UInt16(count), to: &data)
+        } else {
+            data.append(wide + 1)
+            append(UInt32(count), to: &data)
+        }
+    }
+    
+    fileprivate static func encode(number: NSNumber, into data: inout Data) {
+        if CFGetTypeID(number) == CFBooleanGetTypeID() {
+            data.append(number.boolValue ? 0xc3 : 0xc2)
+        } else if CFNumberIsFloatType(number) {
+            data.append(0xcb)
+            append(number.doubleValue.bitPattern, to: &data)
+        } else if number.int64Value >= 0 {
+            let value = number.uint64Value
+            switch value {
+            case 0...0x7f: data.append(UInt8(value))
+            case 0...UInt64(UInt8.max): data.append(0xcc); data.append(UInt8(value))
+            case 0...UInt64(UInt16.max): data.append(0xcd); append(UInt16(value), to: &data)
+            case 0...UInt64(UInt32.max): data.append(0xce); append(UInt32(value), to: &data)
+            default: data.append(0xcf); append(value, to: &data)
+            }
+        } else {
+            let value = number.int64Value
+            switch value {
+            case -32..<0: data.append(UInt8(bitPattern: Int8(value)))
+            case Int64(Int8.min)..<0: data.append(0xd0); data.append(UInt8(bitPattern: Int8(value)))
+            case Int64(Int16.min)..<0: data.append(0xd1); append(UInt16(bitPattern: Int16(value)), to: &data)
+            case Int64(Int32.min)..<0: data.append(0xd2); append(UInt32(bitPattern: Int32(value)), to: &data)
+            default: data.append(0xd3); append(UInt64(bitPattern: value), to: &data)
+            }
+        }
+    }
+    
+    /// Append an integer, big endian.
+    fileprivate static func append<T: FixedWidthInteger>(_ value: T, to data: inout Data) {
+        var bigEndian = value.bigEndian
+        withUnsafeBytes(of: &bigEndian) { bytes in data.append(contentsOf: bytes) }
+    }
+    
+    // MARK: - Decode
+    
+    fileprivate struct Reader {
+        let bytes: UnsafePointer<UInt8>
+        let count: Int
+        var offset = 0
+        
+        init(bytes: UnsafePointer<UInt8>, count: Int) {
+            self.bytes = bytes
+            self.count = count
+        }
+        
+        mutating func read() throws -> Any {
+            let format = try byte()
+            switch format {
+            case 0x00...0x7f: return NSNumber(value: format)
+            case 0x80...0x8f: return try map(Int(format & 0x0f))
+            case 0x90...0x9f: return try array(Int(format & 0x0f))
+            case 0xa0...0xbf: return try string(Int(format & 0x1f))
+            case 0xc0: return NSNull()
+            case 0xc2: return NSNumber(value: false)
+            case 0xc3: return NSNumber(value: true)
+            case 0xca: return NSNumber(value: Float(bitPattern: try integer(UInt32.self)))
+            case 0xcb: return NSNumber(value: Double(bitPattern: try integer(UInt64.self)))
+            case 0xcc: return NSNumber(value: try byte())
+            case 0xcd: return NSNumber(value: try integer(UInt16.self))
+            case 0xce: return NSNumber(value: try integer(UInt32.self))
+            case 0xcf: return NSNumber(value: try integer(UInt64.self))
+            case 0xd0: return NSNumber(value: Int8(bitPattern: try byte()))
+            case 0xd1: return NSNumber(value: Int16(bitPattern: try integer(UInt16.self)))
+            case 0xd2: return NSNumber(value: Int32(bitPattern: try integer(UInt32.self)))
+            case 0xd3: return NSNumber(value: Int64(bitPattern: try integer(UInt64.self)))
+            case 0xd9: return try string(Int(try byte()))
+            case 0xda: return try string(Int(try integer(UInt16.self)))
+            case 0xdb: return try string(Int(try integer(UInt32.self)))
+            case 0xdc: return try array(Int(try integer(UInt16.self)))
+            case 0xdd: return try array(Int(try integer(UInt32.self)))
+            case 0xde: return try map(Int(try integer(UInt16.self)))
+            case 0xdf: return try map(Int(try integer(UInt32.self)))
+            case 0xe0...0xff: return NSNumber(value: Int8(bitPattern: format))
+            default: throw MessagePackError.invalidData
+            }
+        }
+        
+        mutating func byte() throws -> UInt8 {
+            guard offset < count else { throw MessagePackError.invalidData }
+            defer { offset += 1 }
+            return bytes[offset]
+        }
+        
+        mutating func integer<T: FixedWidthInteger>(_ type: T.Type) throws -> T {
+            var value: T = 0
+            for _ in 0..<MemoryLayout<T>.size {
+                value = value << 8 | T(try byte())
+            }
+            return value
+        }
+        
+        mutating func string(_ length: Int) throws -> String {
+            guard length <= count - offset else { throw MessagePackError.invalidData }
+            let buffer = UnsafeBufferPointer(start: bytes + offset, count: length)
+            guard let string = String(bytes: buffer, encoding: .utf8) else { throw MessagePackError.invalidData }
+            offset += length
+            return string
+        }
+        
+        mutating func array(_ count: Int) throws -> [Any] {
+            var array: [Any] = []
+            array.reserveCapacity(min(count, self.count - offset))
+            for _ in 0..<count {
+                array.append(try read())
+            }
+            return array
+        }
+        
+        mutating func map(_ count: Int) throws -> [String: Any] {
+            var map: [String: Any] = Dictionary(minimumCapacity: min(count, self.count - offset))
+            for _ in 0..<count {
+                guard let key = try read() as? String else { throw MessagePackError.invalidData }
+                map[key] = try read()
+            }
+            return map
+        }
+    }
+}
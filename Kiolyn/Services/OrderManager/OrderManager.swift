@@ -35,6 +35,27 @@ class OrderManager {
             .asObservable()
             .subscribe()
             .disposed(by: disposeBag)
+        
+        // Leases expire if not renewed, lock the current order again while it is being edited
+        order
+            .asObservable()
+            .map { order in order?.id }
+            .distinctUntilChanged { $0 == $1 }
+            .flatMapLatest { orderID -> Observable<Order?> in
+                guard orderID != nil else { return Observable.empty() }
+                return Observable<Int>
+                    .interval(OrderLockManager.ttl / 3, scheduler: MainScheduler.instance)
+                    .flatMapFirst { _ -> Observable<Order?> in
+                        guard let order = self.order.value, order.id == orderID else { return Observable.empty() }
+                        return self.dataService.lock(order: order).asObservable().catchErrorJustReturn(nil)
+                    }
+            }
+            .subscribe(onNext: { locked in
+                if locked == nil {
+                    w("[OrderManager] Could not renew the lock of the current order")
+                }
+            })
+            .disposed(by: disposeBag)
     }
     
     
@@ -138,9 +159,11 @@ func modify<T>(order: Order, _ purpose: String, with item: T, task: @escaping (T
 
 /// Modify the current order and save it if the returned result is positive.
 ///
-/// - Parameter task: the modification task to perform
+/// - Parameters:
+///   - task: the modification task to perform
+///   - unlockingAll: `true` to unlock all the orders of this station along with saving.
 /// - Returns: the `Single` of the whole modification process
-func modify(order: Order, _ purpose: String, task: @escaping (Order) -> Single<Order?>) -> Single<Order?> {
+func modify(order: Order, _ purpose: String, unlockingAll: Bool = false, task: @escaping (Order) -> Single<Order?>) -> Single<Order?> {
     return task(order)
         .flatMap { order in
             guard let order = order else {
@@ -149,7 +172,7 @@ func modify(order: Order, _ purpose: String, task: @escaping (Order) -> Single<O
             d("[OrderManager] \(purpose) Modifying \(order)")
             order.updateCalculatedValues()
             return SP.dataService
-                .save(order)
+                .save(order: order, unlockingAll: unlockingAll)
                 .map { order -> Order? in
                     guard let order = order else {
                         return nil
@@ -161,7 +184,8 @@ func modify(order: Order, _ purpose: String, task: @escaping (Order) -> Single<O
     }
 }
 
-/// Lock/Modify/Unlock given Order.
+/// Lock/Modify/Unlock given Order. The modified order is saved and unlocked in one go, orders are
+/// unlocked on their own only if nothing was saved.
 ///
 /// - Parameters:
 ///   - order: the `Order` to be manipulated.
@@ -175,7 +199,7 @@ func lock(andModify order: Order, _ purpose: String, task: @escaping (Order) ->
             guard let order = order else {
                 return Single.just(nil)
             }
-            return modify(order: order, purpose, task: task)
+            return modify(order: order, purpose, unlockingAll: true, task: task)
         }
         .catchError { error -> Single<Order?> in
             SP.dataService
@@ -183,7 +207,10 @@ func lock(andModify order: Order, _ purpose: String, task: @escaping (Order) ->
                 .map { _ -> Order? in nil}
         }
         .flatMap { order -> Single<Order?> in
-            SP.dataService
+            guard order == nil else {
+                return Single.just(order)
+            }
+            return SP.dataService
                 .unlockAllOrders()
                 .map { order }
     }
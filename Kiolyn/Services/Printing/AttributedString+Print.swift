@@ -46,6 +46,19 @@ extension NSAttributedString {
     }
 }
 
+// MARK: - Printing font
+extension UIFont {
+    /// `true` if this is the bold printing font.
+    var isPrintingBold: Bool {
+        return fontName == fontBold
+    }
+
+    /// Size multiplier comparing to the base printing font size.
+    var printingMultiple: Int {
+        return max(1, Int((pointSize / printingFontSizeBase).rounded()))
+    }
+}
+
 /// Extension NSMutableAttributedString to append string with NSAttributedString
 extension NSMutableAttributedString {
 
@@ -13,7 +13,10 @@ extension ISCBBuilder {
     ///
     /// - Parameter string: The string to append.
     func append(bitmap str: NSAttributedString) {
-        let image = str.rasterize(width: PrintPaperSize.threeInches.fvalue)
+        // Already 1bpp, so the builder has no dithering left to do
+        guard let image = MonochromeRaster.image(of: str, width: PrintPaperSize.threeInches.rawValue) else {
+            return
+        }
         appendBitmap(image, diffusion: false)
 
         #if DEBUG
@@ -0,0 +1,128 @@
+//
+//  ICSBuilder+Text.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 8/22/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+// MARK: - Native text printing
+extension ISCBBuilder {
+    /// Append printing content, as native text or as bitmap depending on `Configuration.textModePrinting`
+    /// and on the printer emulation (raster only printers such as TSP100 always get bitmap).
+    ///
+    /// - Parameters:
+    ///   - str: The content built by printing templates.
+    ///   - emulation: The emulation the builder was created for.
+    func append(content str: NSAttributedString, emulation: StarIoExtEmulation) {
+        if Configuration.textModePrinting && emulation.supportsText {
+            append(text: str)
+        } else {
+            append(bitmap: str)
+        }
+    }
+
+    /// Append Attributed String as native printer commands. Templates are laid out for
+    /// 48 monospaced columns which matches the printer Font A on 3 inches paper, so bold
+    /// becomes emphasis, double size font becomes 2x multiple and paragraph alignment is kept.
+    /// Lines which could not be printed as text (logo, non ASCII characters) are rasterized alone.
+    ///
+    /// - Parameter str: The string to append.
+    func append(text str: NSAttributedString) {
+        var state = TextState()
+        state.apply(to: self, force: true)
+
+        let nsstring = str.string as NSString
+        nsstring.enumerateSubstrings(in: NSRange(location: 0, length: nsstring.length), options: [.byLines, .substringNotRequired]) { _, lineRange, enclosingRange, _ in
+            let line = str.attributedSubstring(from: lineRange)
+            if lineRange.length > 0 && !line.isPrintableAsText {
+                // Bitmap line is printed as it is with its own alignment
+                state = TextState()
+                state.apply(to: self, force: true)
+                // Logo looks better dithered, text is sharper with threshold
+                let dithering: MonochromeRaster.Dithering = line.hasAttachment ? .floydSteinberg : .threshold(128)
+                if let image = MonochromeRaster.image(of: line, width: PrintPaperSize.threeInches.rawValue, dithering: dithering) {
+                    self.appendBitmap(image, diffusion: false)
+                }
+                return
+            }
+            // Text runs including the line terminator so that empty lines keep their size
+            str.enumerateAttributes(in: enclosingRange, options: []) { attrs, range, _ in
+                let font = attrs[.font] as? UIFont
+                let paragraph = attrs[.paragraphStyle] as? NSParagraphStyle
+                var runState = TextState()
+                runState.bold = font?.isPrintingBold ?? false
+                runState.multiple = font?.printingMultiple ?? 1
+                runState.alignment = paragraph?.alignment.printingAlignment ?? .left
+                runState.apply(to: self, from: state)
+                state = runState
+                // Line terminators of any kind become a single LF
+                let text = nsstring.substring(with: range).replacingOccurrences(of: "\r\n", with: "\n").replacingOccurrences(of: "\r", with: "\n")
+                if let data = text.data(using: .ascii) {
+                    self.appendData(data)
+                }
+            }
+        }
+        // Leave the builder in default state for the next content
+        TextState().apply(to: self, from: state)
+    }
+}
+
+extension StarIoExtEmulation {
+    /// `false` for raster only emulation, which has no built-in fonts.
+    var supportsText: Bool {
+        return self != .none && self != .starGraphic
+    }
+}
+
+/// Printer text state, to only send commands when the state actually changes.
+fileprivate struct TextState {
+    var bold = false
+    var multiple = 1
+    var alignment = SCBAlignmentPosition.left
+
+    /// Send the commands to switch from `previous` state to this state.
+    func apply(to builder: ISCBBuilder, from previous: TextState = TextState(), force: Bool = false) {
+        if force || bold != previous.bold {
+            builder.appendEmphasis(bold)
+        }
+        if force || multiple != previous.multiple {
+            builder.appendMultiple(multiple, height: multiple)
+        }
+        if force || alignment != previous.alignment {
+            builder.appendAlignment(alignment)
+        }
+    }
+}
+
+fileprivate extension NSAttributedString {
+    /// `true` if this content contains an attachment (logo).
+    var hasAttachment: Bool {
+        var found = false
+        enumerateAttribute(.attachment, in: NSRange(location: 0, length: length), options: []) { value, _, stop in
+            if value != nil {
+                found = true
+                stop.pointee = true
+            }
+        }
+        return found
+    }
+
+    /// `true` if this content contains no attachment and only ASCII characters.
+    var isPrintableAsText: Bool {
+        return !hasAttachment && string.canBeConverted(to: .ascii)
+    }
+}
+
+fileprivate extension NSTextAlignment {
+    /// The corresponding printer alignment.
+    var printingAlignment: SCBAlignmentPosition {
+        switch self {
+        case .center: return .center
+        case .right: return .right
+        default: return .left
+        }
+    }
+}
@@ -0,0 +1,244 @@
+//
+//  MonochromeRaster.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 8/24/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+/// Render printing content to 1 bit per pixel raster. Content is drawn into an 8 bits
+/// grayscale buffer (a quarter of the RGBA bitmap context), then thresholded or dithered
+/// and packed MSB first, 1 = black, 8 dots per byte. Buffers only grow and are reused
+/// between renderings, use `MonochromeRaster.with(_:)` to borrow a shared instance.
+class MonochromeRaster {
+
+    /// The way gray is converted to black/white.
+    enum Dithering {
+        /// Black if gray is lower than the given level.
+        case threshold(UInt8)
+        /// Floyd–Steinberg error diffusion, for logos and photos.
+        case floydSteinberg
+    }
+
+    /// Width in dots.
+    fileprivate(set) var width = 0
+    /// Height in dots.
+    fileprivate(set) var height = 0
+    /// Number of bytes of a packed row.
+    var bytesPerRow: Int { return (width + 7) / 8 }
+
+    /// 8 bits gray, `width` bytes per row.
+    fileprivate var gray: [UInt8] = []
+    /// Error rows for dithering (current and next), with 1 pixel padding on both sides.
+    fileprivate var errors: [Int16] = []
+    /// Packed raster, `bytesPerRow` bytes per row.
+    fileprivate(set) var packed: [UInt8] = []
+
+    // MARK: - Rendering
+
+    /// Render attributed string, the raster is always as wide as `width` so alignment is kept.
+    ///
+    /// - Parameters:
+    ///   - str: The content to render.
+    ///   - width: The width in dots.
+    func render(_ str: NSAttributedString, width: Int) {
+        let options: NSStringDrawingOptions = [.usesLineFragmentOrigin, .truncatesLastVisibleLine]
+        let rect = str.boundingRect(with: CGSize(width: CGFloat(width), height: 10000), options: options, context: nil)
+        draw(width: width, height: Int(ceil(rect.height))) { _, bounds in
+            str.draw(in: bounds)
+        }
+    }
+
+    /// Render image scaled to `width`.
+    ///
+    /// - Parameters:
+    ///   - image: The image to render.
+    ///   - width: The width in dots.
+    func render(_ image: CGImage, width: Int) {
+        let height = Int((CGFloat(image.height) * CGFloat(width) / CGFloat(max(1, image.width))).rounded())
+        draw(width: width, height: height) { context, bounds in
+            context.draw(image, in: bounds)
+        }
+    }
+
+    /// Prepare gray buffer with white background and draw into it with UIKit coordinates.
+    fileprivate func draw(width: Int, height: Int, _ drawing: (CGContext, CGRect) -> Void) {
+        self.width = max(0, width)
+        self.height = max(0, height)
+        let size = self.width * self.height
+        if gray.count < size {
+            gray = [UInt8](repeating: 255, count: size)
+        }
+        guard size > 0 else { return }
+        gray.withUnsafeMutableBytes { buffer in
+            guard let context = CGContext(data: buffer.baseAddress, width: self.width, height: self.height, bitsPerComponent: 8, bytesPerRow: self.width, space: CGColorSpaceCreateDeviceGray(), bitmapInfo: CGImageAlphaInfo.none.rawValue) else {
+                return
+            }
+            let bounds = CGRect(x: 0, y: 0, width: self.width, height: self.height)
+            context.setFillColor(gray: 1, alpha: 1)
+            context.fill(bounds)
+            // UIKit drawing is top-down
+            context.translateBy(x: 0, y: CGFloat(self.height))
+            context.scaleBy(x: 1, y: -1)
+            UIGraphicsPushContext(context)
+            drawing(context, bounds)
+            UIGraphicsPopContext()
+        }
+    }
+
+    /// Set the gray buffer directly, for testing and for already decoded content.
+    ///
+    /// - Parameters:
+    ///   - pixels: The 8 bits gray pixels, `width` per row.
+    ///   - width: The width in dots.
+    func load(gray pixels: [UInt8], width: Int) {
+        self.width = width
+        self.height = width > 0 ? pixels.count / width : 0
+        if gray.count < pixels.count {
+            gray = pixels
+        } else {
+            gray.replaceSubrange(0..<pixels.count, with: pixels)
+        }
+    }
+
+    // MARK: - Packing
+
+    /// Convert the gray buffer to packed 1bpp raster.
+    ///
+    /// - Parameter dithering: The conversion method.
+    func pack(_ dithering: Dithering = .threshold(128)) {
+        let size = bytesPerRow * height
+        if packed.count < size {
+            packed = [UInt8](repeating: 0, count: size)
+        }
+        switch dithering {
+        case let .threshold(level): packThreshold(level)
+        case .floydSteinberg: packFloydSteinberg()
+        }
+    }
+
+    fileprivate func packThreshold(_ level: UInt8) {
+        let width = self.width, height = self.height, bytesPerRow = self.bytesPerRow
+        gray.withUnsafeBufferPointer { src in
+            packed.withUnsafeMutableBufferPointer { dst in
+                for y in 0..<height {
+                    let row = y * width
+                    let out = y * bytesPerRow
+                    var x = 0
+                    // 8 dots at a time for the full bytes
+                    while x + 8 <= width {
+                        var byte: UInt8 = 0
+                        for bit in 0..<8 where src[row + x + bit] < level {
+                            byte |= 0x80 >> UInt8(bit)
+                        }
+                        dst[out + (x >> 3)] = byte
+                        x += 8
+                    }
+                    // Remaining dots of the last byte
+                    if x < width {
+                        var byte: UInt8 = 0
+                        for bit in 0..<(width - x) where src[row + x + bit] < level {
+                            byte |= 0x80 >> UInt8(bit)
+                        }
+                        dst[out + (x >> 3)] = byte
+                    }
+                }
+            }
+        }
+    }
+
+    fileprivate func packFloydSteinberg() {
+        let width = self.width, height = self.height, bytesPerRow = self.bytesPerRow
+        let stride = width + 2
+        if errors.count < stride * 2 {
+            errors = [Int16](repeating: 0, count: stride * 2)
+        } else {
+            for i in 0..<(stride * 2) { errors[i] = 0 }
+        }
+        gray.withUnsafeBufferPointer { src in
+            packed.withUnsafeMutableBufferPointer { dst in
+                errors.withUnsafeMutableBufferPointer { err in
+                    var current = 0, next = stride
+                    for y in 0..<height {
+                        let row = y * width
+                        let out = y * bytesPerRow
+                        var byte: UInt8 = 0
+                        for x in 0..<width {
+                            let value = Int16(src[row + x]) + err[current + x + 1]
+                            let black = value < 128
+                            let error = black ? value : value - 255
+                            // Distribute 7/16 right, 3/16 bottom left, 5/16 bottom, 1/16 bottom right
+                            err[current + x + 2] += error * 7 / 16
+                            err[next + x] += error * 3 / 16
+                            err[next + x + 1] += error * 5 / 16
+                            err[next + x + 2] += error / 16
+                            if black {
+                                byte |= 0x80 >> UInt8(x & 7)
+                            }
+                            if x & 7 == 7 || x == width - 1 {
+                                dst[out + (x >> 3)] = byte
+                                byte = 0
+                            }
+                        }
+                        // Swap rows and clear the new next row
+                        swap(&current, &next)
+                        for i in next..<(next + stride) { err[i] = 0 }
+                    }
+                }
+            }
+        }
+    }
+
+    // MARK: - Output
+
+    /// The packed raster as a 1 bit per pixel image.
+    var image: UIImage? {
+        guard width > 0, height > 0 else { return nil }
+        let data = Data(packed[0..<(bytesPerRow * height)])
+        guard let provider = CGDataProvider(data: data as CFData),
+            // Packed bit 1 is black, so decode is inverted comparing to gray
+            let cgImage = CGImage(width: width, height: height, bitsPerComponent: 1, bitsPerPixel: 1, bytesPerRow: bytesPerRow, space: CGColorSpaceCreateDeviceGray(), bitmapInfo: CGBitmapInfo(rawValue: CGImageAlphaInfo.none.rawValue), provider: provider, decode: [1, 0], shouldInterpolate: false, intent: .defaultIntent) else {
+                return nil
+        }
+        return UIImage(cgImage: cgImage)
+    }
+
+    // MARK: - Sharing
+
+    fileprivate static let lock = NSLock()
+    fileprivate static var idle: [MonochromeRaster] = []
+
+    /// Borrow a raster for the time of `body`, so that buffers are reused between printings.
+    ///
+    /// - Parameter body: The work to do with the raster.
+    /// - Returns: The result of `body`.
+    /// - Throws: Error thrown by `body`.
+    static func with<T>(_ body: (MonochromeRaster) throws -> T) rethrows -> T {
+        lock.lock()
+        let raster = idle.popLast() ?? MonochromeRaster()
+        lock.unlock()
+        defer {
+            lock.lock()
+            idle.append(raster)
+            lock.unlock()
+        }
+        return try body(raster)
+    }
+
+    /// Render attributed string to 1 bit per pixel image.
+    ///
+    /// - Parameters:
+    ///   - str: The content to render.
+    ///   - width: The width in dots.
+    ///   - dithering: The conversion method.
+    /// - Returns: The rendered image.
+    static func image(of str: NSAttributedString, width: Int, dithering: Dithering = .threshold(128)) -> UIImage? {
+        return with { raster in
+            raster.render(str, width: width)
+            raster.pack(dithering)
+            return raster.image
+        }
+    }
+}
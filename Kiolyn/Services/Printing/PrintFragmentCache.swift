@@ -0,0 +1,126 @@
+//
+//  PrintFragmentCache.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 8/23/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+/// Cache of already encoded printer commands for the static parts of printing templates
+/// (store header, logo ...). A fragment is bound to the revision of the documents it was
+/// built from, any new revision of the `Store` or of the settings makes it rebuilt. A fragment
+/// built while some of its content is missing (logo not downloaded yet) is not kept.
+class PrintFragmentCache {
+
+    fileprivate struct Entry {
+        let revision: String
+        let data: Data
+    }
+
+    fileprivate let lock = NSLock()
+    fileprivate var entries: [String: Entry] = [:]
+    fileprivate var logos: [String: UIImage] = [:]
+
+    fileprivate var hitCount = 0
+    fileprivate var missCount = 0
+
+    /// Number of fragments served from cache.
+    var hits: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return hitCount
+    }
+
+    /// Number of fragments built.
+    var misses: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return missCount
+    }
+
+    /// Get the encoded commands of a fragment, build it if not cached or outdated.
+    ///
+    /// - Parameters:
+    ///   - name: The fragment name.
+    ///   - storeID: The `Store` the fragment is for.
+    ///   - revision: The revision of the documents the fragment is built from.
+    ///   - paperSize: The paper size.
+    ///   - emulation: The printer emulation.
+    ///   - complete: Checked after building, `false` if the fragment misses some content and must
+    ///     be built again next time.
+    ///   - build: Build the fragment commands.
+    /// - Returns: The encoded commands.
+    /// - Throws: Error thrown by `build`.
+    func fragment(_ name: String, storeID: String, revision: String, paperSize: PrintPaperSize, emulation: StarIoExtEmulation, complete: () -> Bool = { true }, build: () throws -> Data) rethrows -> Data {
+        let key = "\(storeID)/\(name)/\(paperSize.rawValue)/\(emulation.rawValue)"
+        lock.lock()
+        if let entry = entries[key], entry.revision == revision {
+            hitCount += 1
+            lock.unlock()
+            return entry.data
+        }
+        lock.unlock()
+        // Build outside of the lock, the worst case is the same fragment built twice
+        let data = try build()
+        let isComplete = complete()
+        lock.lock()
+        missCount += 1
+        if isComplete {
+            entries[key] = Entry(revision: revision, data: data)
+        }
+        lock.unlock()
+        return data
+    }
+
+    /// Get a decoded logo image, load it if not cached.
+    ///
+    /// - Parameters:
+    ///   - image: The logo `Image`.
+    ///   - load: Load and decode the image.
+    /// - Returns: The decoded image.
+    func logo(_ image: Image, load: () -> UIImage?) -> UIImage? {
+        lock.lock()
+        if let logo = logos[image.file] {
+            lock.unlock()
+            return logo
+        }
+        lock.unlock()
+        guard let logo = load() else { return nil }
+        lock.lock()
+        // Only a single logo per store, drop the old ones
+        logos = [image.file: logo]
+        lock.unlock()
+        return logo
+    }
+
+    /// `true` if the logo image is loaded already.
+    ///
+    /// - Parameter image: The logo `Image`.
+    func hasLogo(_ image: Image) -> Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        return logos[image.file] != nil
+    }
+
+    /// Drop everything, they are built again when printed.
+    func invalidateAll() {
+        lock.lock()
+        entries.removeAll()
+        logos.removeAll()
+        lock.unlock()
+    }
+}
+
+extension StarIoExtEmulation {
+    /// Encode printing content to printer commands, to be spliced later with `appendRawData`.
+    ///
+    /// - Parameter content: The content to encode.
+    /// - Returns: The encoded commands.
+    func encode(_ content: NSAttributedString) -> Data {
+        let builder: ISCBBuilder = StarIoExt.createCommandBuilder(self)
+        builder.append(content: content, emulation: self)
+        return builder.commands.copy() as! Data
+    }
+}
@@ -0,0 +1,279 @@
+//
+//  PrintSpool.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 8/27/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+/// State of a spooled printing job.
+enum PrintSpoolState: UInt8 {
+    /// Waiting to be sent.
+    case queued = 1
+    /// Sending started, not yet confirmed by printer.
+    case sent = 2
+    /// Confirmed by printer, the job is done.
+    case acked = 3
+}
+
+/// A printing job kept in spool.
+struct SpooledPrintJob {
+    let id: String
+    /// The printer key.
+    let key: String
+    let portName: String
+    let portSettings: String
+    /// The encoded printing commands.
+    let data: Data
+    let createdAt: Date
+    var state: PrintSpoolState
+}
+
+/// Append only spool file of printing jobs, so that jobs survive app being killed and printer
+/// being offline. Records are buffered in memory and written with a single fsync by `flush()`,
+/// which the scheduler calls once per batch. The file is rewritten with only the live jobs
+/// on loading and every `compactThreshold` records.
+class PrintSpool {
+    /// Jobs older than this are dropped, a kitchen ticket is useless after that long.
+    var maxAge: TimeInterval = 30 * 60
+    /// Number of appended records before the file is compacted.
+    var compactThreshold = 256
+
+    /// The default spool file.
+    static var defaultPath: String {
+        let dir = NSSearchPathForDirectoriesInDomains(.applicationSupportDirectory, .userDomainMask, true).first ?? NSTemporaryDirectory()
+        return "\(dir)/print.spool"
+    }
+
+    fileprivate let path: String
+    fileprivate let lock = NSLock()
+    fileprivate var fd: Int32 = -1
+    fileprivate var buffer = Data()
+    fileprivate var jobs: [String: SpooledPrintJob] = [:]
+    fileprivate var appended = 0
+
+    /// Open the spool, loading the jobs left by previous run.
+    ///
+    /// - Parameter path: The spool file.
+    init(path: String = PrintSpool.defaultPath) {
+        self.path = path
+        try? FileManager.default.createDirectory(atPath: (path as NSString).deletingLastPathComponent, withIntermediateDirectories: true, attributes: nil)
+        lock.lock()
+        load()
+        compact()
+        lock.unlock()
+    }
+
+    deinit {
+        if fd >= 0 {
+            close(fd)
+        }
+    }
+
+    /// The jobs not yet confirmed by printer, oldest first.
+    var pending: [SpooledPrintJob] {
+        lock.lock()
+        defer { lock.unlock() }
+        let now = Date()
+        return jobs.values
+            .filter { now.timeIntervalSince($0.createdAt) < maxAge }
+            .sorted { $0.createdAt < $1.createdAt }
+    }
+
+    /// Add a job, a job with the same id replaces the previous one.
+    ///
+    /// - Parameter job: The job to add.
+    func enqueue(_ job: SpooledPrintJob) {
+        lock.lock()
+        jobs[job.id] = job
+        append(encode(job))
+        lock.unlock()
+    }
+
+    /// Change the state of a job, acked jobs are forgotten.
+    ///
+    /// - Parameters:
+    ///   - id: The job id.
+    ///   - state: The new state.
+    func mark(_ id: String, _ state: PrintSpoolState) {
+        lock.lock()
+        defer { lock.unlock() }
+        guard jobs[id] != nil else { return }
+        if state == .acked {
+            jobs[id] = nil
+        } else {
+            jobs[id]?.state = state
+        }
+        append(encode(id: id, state: state))
+    }
+
+    /// Write the buffered records and sync them to disk.
+    func flush() {
+        lock.lock()
+        defer { lock.unlock() }
+        if appended >= compactThreshold {
+            compact()
+        } else {
+            write(buffer)
+        }
+        buffer.removeAll(keepingCapacity: true)
+    }
+
+    // MARK: - File
+
+    /// Must be called with `lock`.
+    fileprivate func append(_ record: Data) {
+        var length = UInt32(record.count).littleEndian
+        buffer.append(Data(bytes: &length, count: 4))
+        buffer.append(record)
+        appended += 1
+    }
+
+    /// Must be called with `lock`.
+    fileprivate func write(_ data: Data) {
+        guard data.count > 0 else { return }
+        if fd < 0 {
+            fd = open(path, O_WRONLY | O_APPEND | O_CREAT, 0o644)
+        }
+        guard fd >= 0 else {
+            e("[PrintSpool] Could not open \(path)")
+            return
+        }
+        let written = data.withUnsafeBytes { (bytes: UnsafePointer<UInt8>) in Darwin.write(fd, bytes, data.count) }
+        if written != data.count {
+            e("[PrintSpool] Could not write \(path)")
+        }
+        fsync(fd)
+    }
+
+    /// Rewrite the file with live jobs only, must be called with `lock`.
+    fileprivate func compact() {
+        let now = Date()
+        jobs = jobs.filter { now.timeIntervalSince($0.value.createdAt) < maxAge }
+        buffer.removeAll(keepingCapacity: true)
+        for job in jobs.values.sorted(by: { $0.createdAt < $1.createdAt }) {
+            append(encode(job))
+        }
+        appended = 0
+        if fd >= 0 {
+            close(fd)
+            fd = -1
+        }
+        let tmp = "\(path).tmp"
+        FileManager.default.createFile(atPath: tmp, contents: buffer, attributes: nil)
+        let tmpfd = open(tmp, O_WRONLY)
+        if tmpfd >= 0 {
+            fsync(tmpfd)
+            close(tmpfd)
+        }
+        if rename(tmp, path) != 0 {
+            e("[PrintSpool] Could not compact \(path)")
+        }
+        buffer.removeAll(keepingCapacity: true)
+    }
+
+    /// Read all records, a truncated record at the end (crash while writing) is ignored.
+    /// Must be called with `lock`.
+    fileprivate func load() {
+        guard let data = FileManager.default.contents(atPath: path) else { return }
+        var reader = SpoolReader(data: data)
+        while let length = reader.uint32(), let record = reader.bytes(Int(length)) {
+            var fields = SpoolReader(data: record)
+            guard let raw = fields.uint8(), let state = PrintSpoolState(rawValue: raw), let id = fields.string() else { break }
+            if state == .queued {
+                guard let key = fields.string(),
+                    let portName = fields.string(),
+                    let portSettings = fields.string(),
+                    let createdAt = fields.double(),
+                    let length = fields.uint32(),
+                    let commands = fields.bytes(Int(length)) else { break }
+                jobs[id] = SpooledPrintJob(id: id, key: key, portName: portName, portSettings: portSettings, data: commands, createdAt: Date(timeIntervalSince1970: createdAt), state: .queued)
+            } else if state == .acked {
+                jobs[id] = nil
+            } else {
+                jobs[id]?.state = state
+            }
+        }
+        if !jobs.isEmpty {
+            i("[PrintSpool] \(jobs.count) jobs left from previous run")
+        }
+    }
+
+    // MARK: - Encoding
+
+    fileprivate func encode(_ job: SpooledPrintJob) -> Data {
+        var data = Data(capacity: job.data.count + 128)
+        data.append(PrintSpoolState.queued.rawValue)
+        data.append(spool: job.id)
+        data.append(spool: job.key)
+        data.append(spool: job.portName)
+        data.append(spool: job.portSettings)
+        var createdAt = job.createdAt.timeIntervalSince1970.bitPattern.littleEndian
+        data.append(Data(bytes: &createdAt, count: 8))
+        var length = UInt32(job.data.count).littleEndian
+        data.append(Data(bytes: &length, count: 4))
+        data.append(job.data)
+        return data
+    }
+
+    fileprivate func encode(id: String, state: PrintSpoolState) -> Data {
+        var data = Data()
+        data.append(state.rawValue)
+        data.append(spool: id)
+        return data
+    }
+}
+
+fileprivate extension Data {
+    /// Append a string prefixed with its UTF8 length.
+    mutating func append(spool string: String) {
+        let utf8 = Data(string.utf8)
+        var length = UInt16(utf8.count).littleEndian
+        append(Data(bytes: &length, count: 2))
+        append(utf8)
+    }
+}
+
+/// Sequential reader of spool records, returning `nil` when there is not enough data.
+fileprivate struct SpoolReader {
+    let data: Data
+    var offset = 0
+
+    init(data: Data) {
+        self.data = data
+    }
+
+    mutating func bytes(_ count: Int) -> Data? {
+        guard count >= 0, offset + count <= data.count else { return nil }
+        let start = data.startIndex + offset
+        offset += count
+        return data.subdata(in: start..<(start + count))
+    }
+
+    mutating func uint8() -> UInt8? {
+        return bytes(1)?.first
+    }
+
+    mutating func uint16() -> UInt16? {
+        guard let b = bytes(2) else { return nil }
+        return UInt16(b[b.startIndex]) | UInt16(b[b.startIndex + 1]) << 8
+    }
+
+    mutating func uint32() -> UInt32? {
+        guard let b = bytes(4) else { return nil }
+        return (0..<4).reduce(UInt32(0)) { $0 | UInt32(b[b.startIndex + $1]) << UInt32($1 * 8) }
+    }
+
+    mutating func double() -> Double? {
+        guard let b = bytes(8) else { return nil }
+        let bits = (0..<8).reduce(UInt64(0)) { $0 | UInt64(b[b.startIndex + $1]) << UInt64($1 * 8) }
+        return Double(bitPattern: bits)
+    }
+
+    mutating func string() -> String? {
+        guard let length = uint16(), let b = bytes(Int(length)) else { return nil }
+        return String(data: b, encoding: .utf8)
+    }
+}
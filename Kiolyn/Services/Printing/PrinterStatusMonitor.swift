@@ -0,0 +1,172 @@
+//
+//  PrinterStatusMonitor.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 8/26/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+import RxSwift
+import RxCocoa
+
+/// Health of a `Printer` as seen by the last status poll.
+struct PrinterHealth {
+    /// `true` if the printer port could be opened.
+    var reachable = false
+    /// `true` if the printer reports itself online.
+    var online = false
+    /// `true` if receipt paper is empty.
+    var paperEmpty = false
+    /// `true` if printer cover is open.
+    var coverOpen = false
+    /// Time for opening port and getting status.
+    var latency: TimeInterval = 0
+    /// Time of the poll.
+    var checkedAt = Date.distantPast
+
+    /// `true` if the printer can print right now.
+    var isReady: Bool { return reachable && online && !paperEmpty && !coverOpen }
+}
+
+/// Poll all the ethernet Star printers of the current store in background and keep their
+/// latest health in memory, so that printing jobs and UI can check printer state without
+/// any network round trip.
+class PrinterStatusMonitor {
+    let disposeBag = DisposeBag()
+
+    /// Interval between polls.
+    var interval: TimeInterval = 15
+    /// Status older than this is not trusted by printing jobs.
+    var freshness: TimeInterval { return interval * 2 }
+    /// Timeout for opening port when polling (ms).
+    var timeout: UInt32 = 3000
+
+    /// The latest health of printers, by printer id.
+    let statuses = BehaviorRelay<[String: PrinterHealth]>(value: [:])
+
+    fileprivate let queue = DispatchQueue(label: "com.kiolyn.printing.status")
+    fileprivate let isBusy: (Printer) -> Bool
+    fileprivate var polling: Disposable?
+
+    /// Create a monitor.
+    ///
+    /// - Parameter isBusy: Return `true` if a job is sending to the printer, such printer is not polled.
+    init(isBusy: @escaping (Printer) -> Bool) {
+        self.isBusy = isBusy
+        guard !Configuration.testPrinting else { return }
+        // Poll while signed in only
+        SP.authService.currentIdentity
+            .asObservable()
+            .map { $0 != nil }
+            .distinctUntilChanged()
+            .subscribe(onNext: { signedIn in
+                if signedIn {
+                    self.start()
+                } else {
+                    self.stop()
+                }
+            })
+            .disposed(by: disposeBag)
+    }
+
+    /// Start polling.
+    func start() {
+        stop()
+        let scheduler = SerialDispatchQueueScheduler(queue: queue, internalSerialQueueName: "com.kiolyn.printing.status")
+        polling = Observable<Int>.timer(0, period: interval, scheduler: scheduler)
+            .flatMapLatest { _ -> Observable<[Printer]> in
+                let printers: Single<[Printer]> = SP.dataService.loadAll()
+                return printers.asObservable().catchErrorJustReturn([])
+            }
+            .observeOn(scheduler)
+            .subscribe(onNext: { printers in
+                self.poll(printers)
+            })
+    }
+
+    /// Stop polling and forget all statuses.
+    func stop() {
+        polling?.dispose()
+        polling = nil
+        statuses.accept([:])
+    }
+
+    /// Get the health of a printer if it is recent enough.
+    ///
+    /// - Parameter printer: The `Printer` to check.
+    /// - Returns: The health or `nil` if unknown or outdated.
+    func health(of printer: Printer) -> PrinterHealth? {
+        guard let health = statuses.value[printer.id], Date().timeIntervalSince(health.checkedAt) < freshness else {
+            return nil
+        }
+        return health
+    }
+
+    /// Record the result of a printing job, it is as good as a poll.
+    ///
+    /// - Parameters:
+    ///   - printer: The `Printer` printed to.
+    ///   - succeed: `true` if the job was sent successfully.
+    func record(_ printer: Printer, succeed: Bool) {
+        queue.async {
+            var health = self.statuses.value[printer.id] ?? PrinterHealth()
+            health.reachable = succeed
+            health.online = succeed
+            if succeed {
+                health.paperEmpty = false
+                health.coverOpen = false
+            }
+            health.checkedAt = Date()
+            self.update(printer, health)
+        }
+    }
+
+    /// Must be called on `queue`.
+    fileprivate func poll(_ printers: [Printer]) {
+        for printer in printers where printer.printerType == .ethernet && !printer.printerModel.isLabelPrinter && printer.hasIPAddress {
+            // Job result is fresher than anything we could get
+            guard !isBusy(printer) else { continue }
+            update(printer, status(of: printer))
+        }
+    }
+
+    /// Must be called on `queue`.
+    fileprivate func update(_ printer: Printer, _ health: PrinterHealth) {
+        let previous = statuses.value[printer.id]
+        if previous?.isReady != health.isReady {
+            i("[PrinterStatusMonitor] \(printer.name) is \(health.isReady ? "ready" : "not ready") \(health)")
+        }
+        var all = statuses.value
+        all[printer.id] = health
+        statuses.accept(all)
+    }
+
+    /// Get printer status through a pooled port, closed right after.
+    fileprivate func status(of printer: Printer) -> PrinterHealth {
+        var health = PrinterHealth()
+        let start = Date()
+        guard let port = StarPortPool.shared.checkout(portName: printer.portName, portSettings: printer.portSettings, timeout: timeout) else {
+            health.latency = Date().timeIntervalSince(start)
+            health.checkedAt = Date()
+            return health
+        }
+        var error: NSError?
+        var status = StarPrinterStatus_2()
+        port.getParsedStatus(&status, 2, &error)
+        health.latency = Date().timeIntervalSince(start)
+        health.checkedAt = Date()
+        guard error == nil else {
+            StarPortPool.shared.invalidate(port)
+            return health
+        }
+        // Not kept idle in the pool, the printer takes a single connection and other stations
+        // would be kept from printing most of the polling interval
+        StarPortPool.shared.invalidate(port)
+        health.reachable = true
+        health.online = status.offline == sm_false
+        health.paperEmpty = status.receiptPaperEmpty == sm_true
+        health.coverOpen = status.coverOpen == sm_true
+        return health
+    }
+}
@@ -8,10 +8,22 @@
 
 import Foundation
 import RxSwift
+import RxCocoa
 
 /// Main interface for printing service.
 protocol PrintingService {
     
+    /// The latest known health of printers, by printer id.
+    var printerStatuses: BehaviorRelay<[String: PrinterHealth]> { get }
+    
+    /// The part of the current job sent to each printer, from 0 to 1, by printer id.
+    var printingProgress: Observable<(printerID: String, progress: Double)> { get }
+    
+    /// Cancel the jobs being sent to given `Printer`, they fail and are not replayed.
+    ///
+    /// - Parameter printer: The `Printer` to stop sending to.
+    func cancelPrinting(on printer: Printer)
+    
     /// Open a cash drawer connected to given `Printer`
     ///
     /// - Parameter printer: The connected `Printer`.
@@ -144,6 +156,8 @@ public enum PrintError: LocalizedError {
     case failedSendingPrintingData
     case printingError(detail: String)
     case invalidInputs(detail: String)
+    /// The job is kept in spool, it is printed when the printer is back.
+    case spooled(printer: String)
     
     public var errorDescription: String? {
         switch self {
@@ -157,6 +171,8 @@ public enum PrintError: LocalizedError {
             return detail
         case .invalidInputs(let detail):
             return detail
+        case .spooled(let printer):
+            return "Printer \(printer) is not available, the job will be printed when it is back"
         }
     }
 }
@@ -0,0 +1,109 @@
+//
+//  StarCommunication+Stream.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 8/25/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+// MARK: - Streaming write
+extension StarCommunication {
+    /// Size of a single port write.
+    static let writeChunkSize = 1024
+    /// Maximum time for a single chunk to be accepted by printer.
+    static let writeChunkTimeout: TimeInterval = 5
+
+    /// Send commands to printer in a checked block, writing in chunks straight from `commands`.
+    ///
+    /// - Parameters:
+    ///   - commands: The commands to send.
+    ///   - portName: The port name.
+    ///   - portSettings: The port settings.
+    ///   - timeout: Timeout for opening port (ms).
+    ///   - isCancelled: Checked between chunks.
+    ///   - progress: Called with the number of bytes written after each chunk.
+    /// - Throws: `PrintError` or port error.
+    static func sendInCheckedBlock(commands: NSData, portName: String, portSettings: String, timeout: UInt32, isCancelled: () -> Bool = { false }, progress: (Int) -> Void = { _ in }) throws {
+        guard !isCancelled() else {
+            throw PrintError.printingError(detail: "Printing cancelled")
+        }
+        // Port is kept opened in pool between jobs
+        guard let port = StarPortPool.shared.checkout(portName: portName, portSettings: portSettings, timeout: timeout) else {
+            throw PrintError.printingError(detail: "Fail to Open Port")
+        }
+        var succeed = false
+        defer {
+            // Only healthy port goes back to the pool
+            if succeed {
+                StarPortPool.shared.checkin(port)
+            } else {
+                StarPortPool.shared.invalidate(port)
+            }
+        }
+
+        var error: NSError?
+        var printerStatus = StarPrinterStatus_2()
+        port.beginCheckedBlock(&printerStatus, 2, &error)
+        if let error = error {
+            throw error
+        }
+        if printerStatus.offline == sm_true {
+            throw PrintError.printingError(detail: "Printer is offline (BeginCheckedBlock)")
+        }
+
+        try write(commands: commands, to: port, isCancelled: isCancelled, progress: progress)
+
+        port.endCheckedBlockTimeoutMillis = 30000
+        port.endCheckedBlock(&printerStatus, 2, &error)
+        if let error = error {
+            throw error
+        }
+        if printerStatus.offline == sm_true {
+            throw PrintError.printingError(detail: "Printer is offline (EndCheckedBlock)")
+        }
+        succeed = true
+    }
+
+    /// Write commands to an opened port in fixed size chunks. When printer buffer is full
+    /// the write returns less than asked, so we back off a little until the chunk deadline. A
+    /// chunk must be fully written before its deadline, however little the printer takes at a time.
+    ///
+    /// - Parameters:
+    ///   - commands: The commands to write.
+    ///   - port: The opened port.
+    ///   - chunkSize: Size of a single write.
+    ///   - chunkTimeout: Maximum time for a chunk to be written.
+    ///   - isCancelled: Checked between writes.
+    ///   - progress: Called with the number of bytes written after each chunk.
+    /// - Throws: `PrintError` or port error.
+    static func write(commands: NSData, to port: SMPort, chunkSize: Int = writeChunkSize, chunkTimeout: TimeInterval = writeChunkTimeout, isCancelled: () -> Bool = { false }, progress: (Int) -> Void = { _ in }) throws {
+        let length = commands.length
+        guard length > 0 else { return }
+        let bytes = commands.bytes.assumingMemoryBound(to: UInt8.self)
+        var total = 0
+        while total < length {
+            let chunkEnd = min(length, total + chunkSize)
+            let deadline = Date().addingTimeInterval(chunkTimeout)
+            while total < chunkEnd {
+                guard !isCancelled() else {
+                    throw PrintError.printingError(detail: "Printing cancelled")
+                }
+                guard Date() < deadline else {
+                    throw PrintError.printingError(detail: "Write port timed out")
+                }
+                var error: NSError?
+                let written = Int(port.write(bytes, UInt32(total), UInt32(chunkEnd - total), &error))
+                if let error = error {
+                    throw error
+                }
+                total += written
+                if written == 0 {
+                    Thread.sleep(forTimeInterval: 0.01)
+                }
+            }
+            progress(total)
+        }
+    }
+}
@@ -240,88 +240,15 @@ class StarCommunication {
         var title:   String = ""
         var message: String = ""
         
-        var error: NSError?
-        
-        let length: UInt32 = UInt32(commands.length)
-        
-        var array: [UInt8] = [UInt8](repeating: 0, count: commands.length)
-        
-        commands.getBytes(&array, length: commands.length)
-        
-        // Send commands processing
-        while true {
-            guard let port: SMPort = SMPort.getPort(portName, portSettings, timeout) else {
-                title   = "Fail to Open Port"
-                message = ""
-                break
-            }
-            
-            defer {
-                SMPort.release(port)
-            }
-            
-            var printerStatus: StarPrinterStatus_2 = StarPrinterStatus_2()
-            
-            port.beginCheckedBlock(&printerStatus, 2, &error)
-            
-            if error != nil {
-                break
-            }
-            
-            if printerStatus.offline == sm_true {
-                title   = "Printer Error"
-                message = "Printer is offline (BeginCheckedBlock)"
-                break
-            }
-            
-            let startDate: NSDate = NSDate()
-            
-            var total: UInt32 = 0
-            
-            while total < length {
-                let written: UInt32 = port.write(array, total, length - total, &error)
-                
-                if error != nil {
-                    break
-                }
-                
-                total += written
-                
-                if NSDate().timeIntervalSince(startDate as Date) >= 30.0 {     // 30000mS!!!
-                    title   = "Printer Error"
-                    message = "Write port timed out"
-                    break
-                }
-            }
-            
-            if total < length {
-                break
-            }
-            
-            port.endCheckedBlockTimeoutMillis = 30000     // 30000mS!!!
-            
-            port.endCheckedBlock(&printerStatus, 2, &error)
-            
-            if error != nil {
-                break
-            }
-            
-            if printerStatus.offline == sm_true {
-                title   = "Printer Error"
-                message = "Printer is offline (EndCheckedBlock)"
-                break
-            }
-            
+        // Commands are written in chunks straight from the data, see StarCommunication+Stream
+        do {
+            try sendInCheckedBlock(commands: commands, portName: portName, portSettings: portSettings, timeout: timeout)
             title   = "Send Commands"
             message = "Success"
-            
             result = true
-            break
-        }
-        
-        if error != nil {
+        } catch {
             title   = "Printer Error"
-            message = error!.description
+            message = error.localizedDescription
         }
         
         if completionHandler != nil {
@@ -23,7 +23,15 @@ extension StarIOPrintingService {
         guard let image = image else {
             return nil
         }
-        
+        // Decode once, the logo is printed on every check
+        return fragments.logo(image) { loadImage(image) }
+    }
+    
+    /// Load image from local file, download it if not available.
+    ///
+    /// - Parameter image: The image to load.
+    /// - Returns: UImage
+    fileprivate func loadImage(_ image: Image) -> UIImage? {
         if let dstPath = NSSearchPathForDirectoriesInDomains(.cachesDirectory, .userDomainMask, true).first {
             let prefix = "store_logo_"
             do {
@@ -72,7 +80,43 @@ extension StarIOPrintingService {
         }
         // Load print settings (or just use a default one if not exist)
         let settings: CheckReceiptPrintingSettings = try await(ds.load(order.storeID)) ?? CheckReceiptPrintingSettings()
-        
+        data.append(build(checkHeaderTemplate: store, settings: settings))
+        data.append(try build(checkBodyTemplate: bill, ofOrder: order, byServer: server, settings: settings, using: ds))
+        return data
+    }
+    
+    /// Append a Check receipt to builder, the store header is taken from the fragment cache.
+    ///
+    /// - Parameters:
+    ///   - for: The `Bill` to print for
+    ///   - order: The `Order` owns the printed `Bill`.
+    ///   - server: The `Employee` who request the printing.
+    ///   - builder: The builder to append to.
+    ///   - emulation: The emulation of the builder.
+    ///   - db: The database for querying data.
+    /// - Throws: `PrintError`.
+    func append(check bill: Bill, ofOrder order: Order, byServer server: Employee, to builder: ISCBBuilder, emulation: StarIoExtEmulation, using ds: DataService) throws {
+        guard let store: Store =  try await(ds.load(order.storeID)) else {
+            return
+        }
+        let settings: CheckReceiptPrintingSettings = try await(ds.load(order.storeID)) ?? CheckReceiptPrintingSettings()
+        // Without the logo until it is downloaded, not kept until then
+        let logo = settings.printLogo ? store.logo : nil
+        let header = fragments.fragment("check_header", storeID: store.id, revision: "\(store.revision)/\(settings.revision)", paperSize: .threeInches, emulation: emulation, complete: { logo.map { fragments.hasLogo($0) } ?? true }) {
+            emulation.encode(build(checkHeaderTemplate: store, settings: settings))
+        }
+        builder.appendRawData(header)
+        builder.append(content: try build(checkBodyTemplate: bill, ofOrder: order, byServer: server, settings: settings, using: ds), emulation: emulation)
+    }
+    
+    /// Build the static header of a Check receipt (logo, store information).
+    ///
+    /// - Parameters:
+    ///   - store: The `Store` to print for.
+    ///   - settings: The printing settings.
+    /// - Returns: The data to be printed as `NSAttributedString`.
+    func build(checkHeaderTemplate store: Store, settings: CheckReceiptPrintingSettings) -> NSAttributedString {
+        let data = NSMutableAttributedString(string:"")
         //Center Alignment
         if settings.printLogo, let storeLogo = downloadImage(store.logo ?? nil) { /* TODO print the logo */
             let storeLogoAttachment = NSTextAttachment.init()
@@ -105,6 +149,21 @@ extension StarIOPrintingService {
         if settings.printPhone {
             data.appendCenter("\(store.bizPhone)\n")
         }
+        return data
+    }
+    
+    /// Build the Order/Bill dependent part of a Check receipt.
+    ///
+    /// - Parameters:
+    ///   - for: The `Bill` to print for
+    ///   - order: The `Order` owns the printed `Bill`.
+    ///   - server: The `Employee` who request the printing.
+    ///   - settings: The printing settings.
+    ///   - db: The database for querying data.
+    /// - Returns: The data to be printed as `NSAttributedString`.
+    /// - Throws: `PrintError`.
+    func build(checkBodyTemplate bill: Bill, ofOrder order: Order, byServer server: Employee, settings: CheckReceiptPrintingSettings, using ds: DataService) throws -> NSAttributedString {
+        let data = NSMutableAttributedString(string:"")
         // Make space
         data.append("\n")
         // Server
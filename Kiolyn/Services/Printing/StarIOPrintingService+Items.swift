@@ -22,15 +22,32 @@ extension StarIOPrintingService {
     /// - Returns: The data to be printed as `NSAttributedString`.
     /// - Throws: `PrintError`.
     func build(itemsTemplate items: [OrderItem], ofOrder order: Order, byServer server: Employee, withType type: PrintItemsType, using ds: DataService) throws -> NSAttributedString {
-        // The final data
-        let data = NSMutableAttributedString(string: "")
-
         // Load printer settings
         guard items.count > 0 else {
-            return data
+            return NSMutableAttributedString(string: "")
         }
         // Load print settings (or just use a default one if not exist)
         let settings: KitchenPrintingSettings = try await(ds.load(order.storeID)) ?? KitchenPrintingSettings()
+        return try build(itemsTemplate: items, ofOrder: order, byServer: server, withType: type, settings: settings, using: ds)
+    }
+    
+    /// Build string template for printing items with the given settings.
+    ///
+    /// - Parameters:
+    ///   - items: The `Item`s to print.
+    ///   - order: The `Order` that the orders belong to.
+    ///   - server: The server who request the printing.
+    ///   - type: The type of printing.
+    ///   - settings: The kitchen printing settings.
+    ///   - ds: The data service for querying categories and customer.
+    /// - Returns: The data to be printed as `NSAttributedString`.
+    /// - Throws: `PrintError`.
+    func build(itemsTemplate items: [OrderItem], ofOrder order: Order, byServer server: Employee, withType type: PrintItemsType, settings: KitchenPrintingSettings, using ds: DataService) throws -> NSAttributedString {
+        // The final data
+        let data = NSMutableAttributedString(string: "")
+        guard items.count > 0 else {
+            return data
+        }
         
         // 3 spaces on top
         data.append("\n\n\n")
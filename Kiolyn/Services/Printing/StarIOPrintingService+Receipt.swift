@@ -20,6 +20,19 @@ extension StarIOPrintingService {
     /// - Throws: `PrintError`.
     func build(receiptTemplate trans: Transaction, for type: PrintReceiptType, store: Store, order: Order?, server: Employee, settings: CCReceiptPrintingSettings) throws -> NSAttributedString {
         // The final data
+        let data = NSMutableAttributedString(string:"")
+        data.append(build(receiptHeaderTemplate: store, settings: settings))
+        data.append(try build(receiptBodyTemplate: trans, for: type, store: store, order: order, server: server, settings: settings))
+        return data
+    }
+    
+    /// Build the static header of a Receipt (store information).
+    ///
+    /// - Parameters:
+    ///   - store: The `Store` to print for.
+    ///   - settings: The printing settings.
+    /// - Returns: The data to be printed as `NSAttributedString`.
+    func build(receiptHeaderTemplate store: Store, settings: CCReceiptPrintingSettings) -> NSAttributedString {
         let data = NSMutableAttributedString(string:"")
         // 2 spaces on top
         data.append("\n\n")
@@ -33,6 +46,20 @@ extension StarIOPrintingService {
         if settings.printPhone {
             data.appendCenter("\(store.bizPhone)\n")
         }
+        return data
+    }
+    
+    /// Build the Transaction dependent part of a Receipt.
+    ///
+    /// - Parameters:
+    ///   - for: The `Bill` to print for
+    ///   - server: The `Employee` who request the printing.
+    ///   - for: The type of Receipt.
+    ///   - settings: The printing settings.
+    /// - Returns: The data to be printed as `NSAttributedString`.
+    /// - Throws: `PrintError`.
+    func build(receiptBodyTemplate trans: Transaction, for type: PrintReceiptType, store: Store, order: Order?, server: Employee, settings: CCReceiptPrintingSettings) throws -> NSAttributedString {
+        let data = NSMutableAttributedString(string:"")
         if settings.printDateTime {
             data.appendCenter("\(trans.createdTime.toString("MMM d yyyy HH:mm"))\n")
         }
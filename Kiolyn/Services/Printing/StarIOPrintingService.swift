@@ -8,12 +8,30 @@
 
 import Foundation
 import RxSwift
+import RxCocoa
 import AwaitKit
 
-fileprivate extension Printer {
+/// StarIO port information of a `Printer`.
+extension Printer {
     var portName: String { return "TCP:\(self.ipAddress)" }
     var portSettings: String { return "" }
-    var modelName: String { return "TSP143 (STR_T-001)" }
+    /// The model reported by the printer when last found on the LAN, the configured model otherwise.
+    var modelName: String {
+        if let found = StarIOPrintingService.foundModel(macAddress) {
+            return found
+        }
+        guard case let .star(model) = printerModel else { return "" }
+        return model
+    }
+    /// The emulation of the printer model, raster only (TSP100) if the model is not known.
+    var emulation: StarIoExtEmulation {
+        var modelIndex = StarModelCapability.modelIndexAtModelName(modelName: modelName)
+        if modelIndex == .None {
+            // Configured models are the model titles (TSP650II) rather than the reported names (TSP654II (STR_T-001))
+            modelIndex = StarModelCapability.modelIndexArray.first { StarModelCapability.titleAtModelIndex(modelIndex: $0) == modelName } ?? .TSP100
+        }
+        return StarModelCapability.emulationAtModelIndex(modelIndex: modelIndex)
+    }
 }
 
 /// Paper size of printing
@@ -32,26 +50,96 @@ enum PrintPaperSize: Int {
 /// StarIO implementation of the printing services.
 class StarIOPrintingService {
     
+    let disposeBag = DisposeBag()
     fileprivate let queue = DispatchQueue(label: "com.kiolyn.printing", attributes: .concurrent)
+    /// Jobs are built concurrently but sent in order per printer.
+    fileprivate let scheduler: StarPrintScheduler
+    /// Encoded static parts of templates.
+    let fragments = PrintFragmentCache()
+    /// Background printer status polling.
+    let monitor: PrinterStatusMonitor
+    /// Part of the job sent so far, by printer id.
+    let progress = PublishSubject<(printerID: String, progress: Double)>()
+    /// The jobs being streamed, by printer id, so they can be cancelled.
+    fileprivate var streams: [String: [String: Disposable]] = [:]
+    fileprivate let streamsLock = NSLock()
+    /// Model names of the printers found on the LAN, by raw MAC address.
+    fileprivate static var foundModels: [String: String] = [:]
+    fileprivate static let foundModelsLock = NSLock()
+    
+    init() {
+        let scheduler = StarPrintScheduler(spool: Configuration.testPrinting ? nil : PrintSpool())
+        self.scheduler = scheduler
+        // Printer being printed to is not polled
+        monitor = PrinterStatusMonitor { printer in scheduler.isBusy(printer.id) }
+        if !Configuration.testPrinting {
+            SP.addressResolver.register(source: "star") { StarIOPrintingService.searchPrinters() }
+        }
+        // Jobs left from previous run or from printer outage are sent once the printer is back
+        var ready: Set<String> = []
+        monitor.statuses
+            .asObservable()
+            .subscribe(onNext: { statuses in
+                let nowReady = Set(statuses.filter { _, health in health.isReady }.map { id, _ in id })
+                for id in nowReady.subtracting(ready) {
+                    scheduler.replay(key: id)
+                }
+                ready = nowReady
+            })
+            .disposed(by: disposeBag)
+        // Fragments and logos are built again on next printing
+        NotificationCenter.default.rx
+            .notification(.UIApplicationDidReceiveMemoryWarning)
+            .subscribe(onNext: { [fragments] _ in
+                fragments.invalidateAll()
+            })
+            .disposed(by: disposeBag)
+    }
     
-    /// Find a printer IP address
+    /// Find a printer IP address, from the address table when possible.
     ///
-    /// - Parameter printer: The Printer to find.
+    /// - Parameters:
+    ///   - printer: The Printer to find.
+    ///   - failedIP: The IP address which could not be reached.
     /// - Returns: The found IP address.
-    func findIP(printer: Printer) -> String? {
+    func findIP(printer: Printer, excluding failedIP: String = "") -> String? {
+        return SP.addressResolver.resolve(printer.macAddress, excluding: failedIP) {
+            StarIOPrintingService.searchPrinters()[printer.macAddress.rawMac.lowercased()]
+        }
+    }
+    
+    /// Search the LAN for Star printers.
+    ///
+    /// - Returns: The found IP addresses by raw MAC address.
+    static func searchPrinters() -> [String: String] {
         // Add list printer to array
         guard let foundPorts = SMPort.searchPrinter("TCP:") as? [PortInfo],
             foundPorts.isNotEmpty else {
-                return nil
-        }
-        return foundPorts
-            .first { port -> Bool in
-                // Must contain all the necessary info
-                guard let _ = port.modelName, let macAddress = port.macAddress, let _ = port.portName else { return false }
-                // Must match the one we are looking for
-                return macAddress.replacingOccurrences(of: ":", with: "").lowercased() == printer.macAddress.lowercased()
-            }
-            .map { $0.portName!.right(from: 4) }
+                return [:]
+        }
+        var found: [String: String] = [:]
+        var models: [String: String] = [:]
+        for port in foundPorts {
+            // Must contain all the necessary info
+            guard let modelName = port.modelName, let macAddress = port.macAddress, let portName = port.portName else { continue }
+            found[macAddress.rawMac.lowercased()] = portName.right(from: 4)
+            models[macAddress.rawMac.lowercased()] = modelName
+        }
+        foundModelsLock.lock()
+        foundModels.merge(models) { _, new in new }
+        foundModelsLock.unlock()
+        return found
+    }
+
+    /// Get the model name a printer reported when it was found on the LAN.
+    ///
+    /// - Parameter macAddress: The printer MAC address.
+    /// - Returns: The model name, `nil` if the printer was not found yet.
+    static func foundModel(_ macAddress: String) -> String? {
+        guard macAddress.isNotEmpty else { return nil }
+        foundModelsLock.lock()
+        defer { foundModelsLock.unlock() }
+        return foundModels[macAddress.rawMac.lowercased()]
     }
     
     /// Send builder to printer.
@@ -59,11 +147,35 @@ class StarIOPrintingService {
     /// - Parameters:
     ///   - printer: The `Printer` to perform the printing on
     ///   - builder: The Builder to send.
+    ///   - id: The job id, the same for all attempts of a job.
     /// - Returns: `true` if sending OK, false otherwise
-    private func send(to printer: Printer, data: NSData) -> Bool {
+    /// - Throws: `PrintError.printingError` if the job was cancelled by `cancelPrinting(on:)`.
+    private func send(to printer: Printer, data: NSData, id: String) throws -> Bool {
         guard !Configuration.testPrinting else { return true }
-        // Send to printer
-        return StarCommunication.sendCommands(commands: data, portName: printer.portName, portSettings: printer.portSettings, timeout: 10000) { (succeed, title, message) in }
+        // Send to printer, after the previous jobs of the same printer
+        let done = DispatchSemaphore(value: 0)
+        var succeed = false
+        let stream = scheduler.stream(data: data, key: printer.id, portName: printer.portName, portSettings: printer.portSettings, id: id)
+            .subscribe(onNext: { written in
+                self.progress.onNext((printer.id, Double(written) / Double(max(1, data.length))))
+            }, onCompleted: {
+                succeed = true
+            }, onDisposed: {
+                done.signal()
+            })
+        streamsLock.lock()
+        streams[printer.id, default: [:]][id] = stream
+        streamsLock.unlock()
+        done.wait()
+        streamsLock.lock()
+        // Cancelled jobs are taken out by `cancelPrinting(on:)`
+        let cancelled = streams[printer.id]?.removeValue(forKey: id) == nil
+        streamsLock.unlock()
+        guard !cancelled else {
+            throw PrintError.printingError(detail: "Printing on \(printer.name) was cancelled")
+        }
+        monitor.record(printer, succeed: succeed)
+        return succeed
     }
     
     /// Send text content to printing.
@@ -74,7 +186,7 @@ class StarIOPrintingService {
     /// - Returns: A `Promise` about the printing result.
     func send(to printer: Printer, data generate: @escaping (DataService) throws -> NSAttributedString) -> Single<Void> {
         return self.send(to: printer) { (db, builder) in
-            builder.append(bitmap: try generate(db))
+            builder.append(content: try generate(db), emulation: printer.emulation)
             builder.appendPaperCut()
             builder.appendBuzz()
         }
@@ -113,43 +225,78 @@ class StarIOPrintingService {
             #endif
             
             // Build content
-            let modelIndex = StarModelCapability.modelIndexAtModelName(modelName: printer.modelName)
-            let emulation = StarModelCapability.emulationAtModelIndex(modelIndex: modelIndex)
-            let builder: ISCBBuilder = StarIoExt.createCommandBuilder(emulation)
+            let builder: ISCBBuilder = StarIoExt.createCommandBuilder(printer.emulation)
             builder.beginDocument()
             try generate(ds, builder)
             builder.endDocument()
             let data: NSData = builder.commands.copy() as! NSData
+            let id = UUID().uuidString
+            // Job is kept in spool by the failed attempts, tell user it is not lost
+            let spooled = PrintError.spooled(printer: printer.name)
             
-            // It will success most of the case
-            if self.send(to: printer, data: data) {
+            // Known state from background polling, no need to wait for port to fail
+            let health = Configuration.testPrinting ? nil : self.monitor.health(of: printer)
+            // Printer is there but not ready, keep the job for when it is
+            if let health = health, health.reachable, health.paperEmpty || health.coverOpen {
+                let reason = health.paperEmpty ? "out of paper" : "cover open"
+                guard self.scheduler.hold(data: data, key: printer.id, portName: printer.portName, portSettings: printer.portSettings, id: id) else {
+                    throw PrintError.printingError(detail: "Printer \(printer.name) is \(reason)")
+                }
+                throw PrintError.spooled(printer: "\(printer.name) (\(reason))")
+            }
+            // It will success most of the case, unless printer is known to be unreachable
+            let tried = health?.reachable ?? true
+            if tried, try self.send(to: printer, data: data, id: id) {
                 return
             }
             
             // IP might changed, so try to find the printer again
             // if the printer is found with same IP, something is wrong
-            guard let ip = self.findIP(printer: printer), ip.isNotEmpty else {
-                throw PrintError.printerNotFound
+            guard let ip = self.findIP(printer: printer, excluding: printer.ipAddress), ip.isNotEmpty else {
+                if tried {
+                    throw spooled
+                }
+                // Not sent at all, keep it for when the printer is back
+                throw self.scheduler.hold(data: data, key: printer.id, portName: printer.portName, portSettings: printer.portSettings, id: id) ? spooled : PrintError.printerNotFound
             }
             // IP is found and the same as before, so it's some different error
             guard ip != printer.ipAddress else {
-                throw PrintError.failedSendingPrintingData
+                // ... unless we have not tried because printer was known unreachable, it might be back
+                if !tried, try self.send(to: printer, data: data, id: id) {
+                    return
+                }
+                throw spooled
             }
             // Looks like IP has changed, we save the new IP
             printer.ipAddress = ip
             _ = try await(ds.save(printer))
-            // ... then resend
-            if self.send(to: printer, data: data) {
+            // ... then resend, the spooled job is replaced with the new IP
+            if try self.send(to: printer, data: data, id: id) {
                 return
             } else {
-                throw PrintError.failedSendingPrintingData
-            }            
+                throw spooled
+            }
         }
     }
 }
 
 extension StarIOPrintingService: PrintingService {
     
+    var printerStatuses: BehaviorRelay<[String: PrinterHealth]> {
+        return monitor.statuses
+    }
+    
+    var printingProgress: Observable<(printerID: String, progress: Double)> {
+        return progress.asObservable()
+    }
+    
+    func cancelPrinting(on printer: Printer) {
+        streamsLock.lock()
+        let cancelled = Array((streams.removeValue(forKey: printer.id) ?? [:]).values)
+        streamsLock.unlock()
+        cancelled.forEach { $0.dispose() }
+    }
+    
     func open(cashDrawer printer: Printer) -> Single<Void> {
         return send(to: printer) { (db, builder) in
             builder.appendPeripheral(.no1)
@@ -159,7 +306,7 @@ extension StarIOPrintingService: PrintingService {
     func print(items: [[OrderItem]], ofOrder order: Order, byServer server: Employee, withType type: PrintItemsType, toPrinter printer: Printer) -> Single<Void> {
         return send(to: printer) { (ds, builder) in
             for its in items {
-                builder.append(bitmap: try self.build(itemsTemplate: its, ofOrder: order, byServer: server, withType: type, using: ds))
+                builder.append(content: try self.build(itemsTemplate: its, ofOrder: order, byServer: server, withType: type, using: ds), emulation: printer.emulation)
                 builder.appendPaperCut()
             }
             builder.appendBuzz()
@@ -168,18 +315,13 @@ extension StarIOPrintingService: PrintingService {
     
     /// If bill is given, send that bill alone, otherwise send ALL the bill found in Order.
     func print(check bill: Bill?, ofOrder order: Order, byServer server: Employee, toPrinter printer: Printer) -> Single<Void> {
-        if let bill = bill {
-            return send(to: printer) { ds in
-                try self.build(checkTemplate: bill, ofOrder: order, byServer: server, using: ds)
-            }
-        } else {
-            return send(to: printer) { (ds, builder) in
-                for bill in order.bills {
-                    builder.append(bitmap: try self.build(checkTemplate: bill, ofOrder: order, byServer: server, using: ds))
-                    builder.appendPaperCut()
-                }
-                builder.appendBuzz()
+        let bills = bill.map { [$0] } ?? order.bills
+        return send(to: printer) { (ds, builder) in
+            for bill in bills {
+                try self.append(check: bill, ofOrder: order, byServer: server, to: builder, emulation: printer.emulation, using: ds)
+                builder.appendPaperCut()
             }
+            builder.appendBuzz()
         }
     }
     
@@ -197,15 +339,22 @@ extension StarIOPrintingService: PrintingService {
             if (transaction.transType == .creditSale || transaction.transType == .cash || transaction.transType == .custom) && transaction.order.isNotEmpty {
                 order = try await(ds.load(transaction.order))
             }
+            // Store header is the same for both copies
+            let emulation = printer.emulation
+            let header = self.fragments.fragment("receipt_header", storeID: store.id, revision: "\(store.revision)/\(settings.revision)", paperSize: .threeInches, emulation: emulation) {
+                emulation.encode(self.build(receiptHeaderTemplate: store, settings: settings))
+            }
             // MERCHANT copy
             builder.appendAlignment(SCBAlignmentPosition.center)
-            let mdata = try self.build(receiptTemplate: transaction, for: .merchant, store: store, order: order, server: server, settings: settings)
-            builder.append(bitmap: mdata)
+            builder.appendRawData(header)
+            let mdata = try self.build(receiptBodyTemplate: transaction, for: .merchant, store: store, order: order, server: server, settings: settings)
+            builder.append(content: mdata, emulation: printer.emulation)
             builder.appendPaperCut()
             // CUSTOMER copy
             builder.appendAlignment(SCBAlignmentPosition.center)
-            let cdata = try self.build(receiptTemplate: transaction, for: .customer, store: store, order: order, server: server, settings: settings)
-            builder.append(bitmap: cdata)
+            builder.appendRawData(header)
+            let cdata = try self.build(receiptBodyTemplate: transaction, for: .customer, store: store, order: order, server: server, settings: settings)
+            builder.append(content: cdata, emulation: printer.emulation)
             builder.appendPaperCut()
             
             builder.appendBuzz()
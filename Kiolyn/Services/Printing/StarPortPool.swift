@@ -0,0 +1,159 @@
+//
+//  StarPortPool.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 8/20/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+/// Keep opened `SMPort`s alive between print jobs so that a busy printer does not pay
+/// the TCP handshake on every ticket. Ports are exclusive, a port is either checked out
+/// by a job or idle in the pool. Idle ports are health checked before reuse and closed
+/// once they stay idle longer than `idleTimeout` (other stations might need the printer).
+class StarPortPool {
+
+    /// Pool statistics, for diagnosing printing latency.
+    struct Statistics {
+        /// Number of checkouts served by an idle port.
+        var hits = 0
+        /// Number of checkouts which had to open a new port.
+        var misses = 0
+        /// Number of idle ports dropped because of failed health check.
+        var unhealthy = 0
+        /// Number of idle ports closed because of idle timeout.
+        var expired = 0
+        /// Number of failed port opening.
+        var openFailures = 0
+        /// Total time spent in `SMPort.getPort`.
+        var openTime: TimeInterval = 0
+
+        /// Ratio of checkouts served from pool.
+        var hitRate: Double {
+            let total = hits + misses
+            return total == 0 ? 0 : Double(hits) / Double(total)
+        }
+        /// Average time for opening a port.
+        var averageOpenTime: TimeInterval {
+            let opened = misses - openFailures
+            return opened <= 0 ? 0 : openTime / Double(opened)
+        }
+    }
+
+    /// The shared pool used by `StarCommunication`.
+    static let shared = StarPortPool()
+
+    /// Idle port is closed after this interval.
+    var idleTimeout: TimeInterval = 10
+
+    fileprivate struct IdlePort {
+        let port: SMPort
+        let settings: String
+        let lastUsed: Date
+    }
+
+    fileprivate let queue = DispatchQueue(label: "com.kiolyn.printing.port-pool")
+    fileprivate var idlePorts: [String: IdlePort] = [:]
+    fileprivate var stats = Statistics()
+
+    /// Current statistics snapshot.
+    var statistics: Statistics {
+        return queue.sync { stats }
+    }
+
+    /// Get a port for the given port name, reuse an idle one if it is still healthy.
+    ///
+    /// - Parameters:
+    ///   - portName: The port name (TCP:<ip>).
+    ///   - portSettings: The port settings.
+    ///   - timeout: Timeout for opening new port (ms).
+    /// - Returns: The opened port or `nil` if the port could not be opened.
+    func checkout(portName: String, portSettings: String, timeout: UInt32) -> SMPort? {
+        let idle: IdlePort? = queue.sync { idlePorts.removeValue(forKey: portName) }
+        if let idle = idle {
+            if idle.settings == portSettings, Date().timeIntervalSince(idle.lastUsed) < idleTimeout, isHealthy(idle.port) {
+                queue.sync { stats.hits += 1 }
+                return idle.port
+            }
+            queue.sync { stats.unhealthy += 1 }
+            SMPort.release(idle.port)
+        }
+        let start = Date()
+        let port = SMPort.getPort(portName, portSettings, timeout)
+        let elapsed = Date().timeIntervalSince(start)
+        queue.sync {
+            stats.misses += 1
+            stats.openTime += elapsed
+            if port == nil {
+                stats.openFailures += 1
+            }
+        }
+        if port == nil {
+            w("[StarPortPool] Could not open \(portName) after \(Int(elapsed * 1000))ms")
+        }
+        return port
+    }
+
+    /// Return a healthy port to the pool after use.
+    ///
+    /// - Parameter port: The port to return.
+    func checkin(_ port: SMPort) {
+        guard idleTimeout > 0, let portName = port.portName() else {
+            return SMPort.release(port)
+        }
+        let settings = port.portSettings() ?? ""
+        let replaced: IdlePort? = queue.sync {
+            let replaced = idlePorts[portName]
+            idlePorts[portName] = IdlePort(port: port, settings: settings, lastUsed: Date())
+            return replaced
+        }
+        // Should not happen with one job per printer at a time, but do not leak the port
+        if let replaced = replaced, replaced.port !== port {
+            SMPort.release(replaced.port)
+        }
+        queue.asyncAfter(deadline: .now() + idleTimeout) { [weak self] in
+            self?.expire(portName)
+        }
+    }
+
+    /// Close a port which had error or is not needed for a while, it is never returned to the pool.
+    ///
+    /// - Parameter port: The port to close.
+    func invalidate(_ port: SMPort) {
+        SMPort.release(port)
+    }
+
+    /// Close all idle ports, for example when app goes to background.
+    func drain() {
+        let ports: [IdlePort] = queue.sync {
+            let ports = Array(idlePorts.values)
+            idlePorts.removeAll()
+            return ports
+        }
+        for idle in ports {
+            SMPort.release(idle.port)
+        }
+    }
+
+    /// Must be called on `queue`.
+    fileprivate func expire(_ portName: String) {
+        guard let idle = idlePorts[portName], Date().timeIntervalSince(idle.lastUsed) >= idleTimeout else {
+            return
+        }
+        idlePorts.removeValue(forKey: portName)
+        stats.expired += 1
+        DispatchQueue.global(qos: .background).async {
+            SMPort.release(idle.port)
+        }
+    }
+
+    /// Check if an idle port is still usable.
+    fileprivate func isHealthy(_ port: SMPort) -> Bool {
+        guard port.connected() else { return false }
+        var error: NSError?
+        var status = StarPrinterStatus_2()
+        port.getParsedStatus(&status, 2, &error)
+        return error == nil && status.offline == sm_false
+    }
+}
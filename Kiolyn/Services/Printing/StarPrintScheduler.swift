@@ -0,0 +1,239 @@
+//
+//  StarPrintScheduler.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 8/21/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+import RxSwift
+
+/// Serialize print jobs per printer while different printers still print in parallel.
+/// Jobs queued back to back for the same printer are concatenated and sent in a single
+/// checked block, so a burst of tickets costs one status round-trip instead of one per ticket.
+/// With a spool, jobs are kept on disk until the printer confirms them and can be replayed
+/// after the app restarts or the printer comes back. Streamed jobs report the bytes written and
+/// can be cancelled between chunks, they are sent alone.
+class StarPrintScheduler {
+
+    fileprivate class Job {
+        let id: String
+        let data: NSData
+        let portName: String
+        let portSettings: String
+        let done = DispatchSemaphore(value: 0)
+        var result = false
+        /// Checked between chunks, `nil` for jobs which can be batched.
+        let isCancelled: (() -> Bool)?
+        let progress: (Int) -> Void
+        let completed: (Error?) -> Void
+
+        init(id: String, data: NSData, portName: String, portSettings: String, isCancelled: (() -> Bool)? = nil, progress: @escaping (Int) -> Void = { _ in }, completed: @escaping (Error?) -> Void = { _ in }) {
+            self.id = id
+            self.data = data
+            self.portName = portName
+            self.portSettings = portSettings
+            self.isCancelled = isCancelled
+            self.progress = progress
+            self.completed = completed
+        }
+
+        var isStreamed: Bool { return isCancelled != nil }
+    }
+
+    fileprivate class Lane {
+        let queue: DispatchQueue
+        var pending: [Job] = []
+        var draining = false
+
+        init(key: String) {
+            queue = DispatchQueue(label: "com.kiolyn.printing.lane.\(key)")
+        }
+    }
+
+    /// Maximum number of jobs to be sent in a single checked block.
+    var maxBatchSize = 8
+    /// Timeout for opening port (ms).
+    var timeout: UInt32 = 10000
+
+    fileprivate let lock = NSLock()
+    fileprivate var lanes: [String: Lane] = [:]
+    /// Ids of the jobs waiting or being sent.
+    fileprivate var inflight: Set<String> = []
+    fileprivate let spool: PrintSpool?
+
+    /// Create a scheduler.
+    ///
+    /// - Parameter spool: The spool to keep jobs in, `nil` for memory only.
+    init(spool: PrintSpool? = nil) {
+        self.spool = spool
+    }
+
+    /// Check if a printer has jobs being sent or waiting.
+    ///
+    /// - Parameter key: The printer key.
+    /// - Returns: `true` if the printer is busy.
+    func isBusy(_ key: String) -> Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        return lanes[key]?.draining ?? false
+    }
+
+    /// Send data to a printer, blocking the caller until the batch containing it was sent.
+    ///
+    /// - Parameters:
+    ///   - data: The printing commands.
+    ///   - key: The printer key, jobs with the same key are sent in order.
+    ///   - portName: The port name to send to.
+    ///   - portSettings: The port settings.
+    ///   - id: The job id, sending again the same job (i.e. to a new IP) does not duplicate it in spool.
+    /// - Returns: `true` if sending OK, false otherwise.
+    func send(data: NSData, key: String, portName: String, portSettings: String, id: String = UUID().uuidString) -> Bool {
+        spool?.enqueue(SpooledPrintJob(id: id, key: key, portName: portName, portSettings: portSettings, data: data as Data, createdAt: Date(), state: .queued))
+        let job = Job(id: id, data: data, portName: portName, portSettings: portSettings)
+        enqueue(job, key: key)
+        job.done.wait()
+        return job.result
+    }
+
+    /// Send data to a printer after the previous jobs of the printer, with progress and cancellation.
+    /// Nothing is sent until subscribed, disposing stops the writing at the next chunk, the job is
+    /// then dropped from spool.
+    ///
+    /// - Parameters:
+    ///   - data: The printing commands.
+    ///   - key: The printer key, jobs with the same key are sent in order.
+    ///   - portName: The port name to send to.
+    ///   - portSettings: The port settings.
+    ///   - id: The job id, sending again the same job (i.e. to a new IP) does not duplicate it in spool.
+    /// - Returns: `Observable` of the number of bytes written so far.
+    func stream(data: NSData, key: String, portName: String, portSettings: String, id: String = UUID().uuidString) -> Observable<Int> {
+        return Observable.create { observer in
+            let disposable = BooleanDisposable()
+            self.spool?.enqueue(SpooledPrintJob(id: id, key: key, portName: portName, portSettings: portSettings, data: data as Data, createdAt: Date(), state: .queued))
+            let job = Job(id: id, data: data, portName: portName, portSettings: portSettings, isCancelled: { disposable.isDisposed }, progress: { written in
+                observer.onNext(written)
+            }, completed: { error in
+                if let error = error {
+                    observer.onError(error)
+                } else {
+                    observer.onCompleted()
+                }
+            })
+            self.enqueue(job, key: key)
+            return disposable
+        }
+    }
+
+    /// Keep a job in spool without sending it, it is sent by the next `replay`.
+    ///
+    /// - Parameters:
+    ///   - data: The printing commands.
+    ///   - key: The printer key.
+    ///   - portName: The port name to send to.
+    ///   - portSettings: The port settings.
+    ///   - id: The job id.
+    /// - Returns: `true` if the job was spooled.
+    func hold(data: NSData, key: String, portName: String, portSettings: String, id: String) -> Bool {
+        guard let spool = spool else { return false }
+        spool.enqueue(SpooledPrintJob(id: id, key: key, portName: portName, portSettings: portSettings, data: data as Data, createdAt: Date(), state: .queued))
+        spool.flush()
+        return true
+    }
+
+    /// Send again the spooled jobs which have not been confirmed by printer, without waiting.
+    ///
+    /// - Parameter key: The printer key, `nil` for all printers.
+    func replay(key: String? = nil) {
+        guard let spool = spool else { return }
+        for spooled in spool.pending where key == nil || spooled.key == key {
+            lock.lock()
+            let waiting = inflight.contains(spooled.id)
+            lock.unlock()
+            guard !waiting else { continue }
+            i("[StarPrintScheduler] Replaying job \(spooled.id) to \(spooled.portName)")
+            enqueue(Job(id: spooled.id, data: spooled.data as NSData, portName: spooled.portName, portSettings: spooled.portSettings), key: spooled.key)
+        }
+    }
+
+    fileprivate func enqueue(_ job: Job, key: String) {
+        lock.lock()
+        let lane = lanes[key] ?? Lane(key: key)
+        lanes[key] = lane
+        lane.pending.append(job)
+        inflight.insert(job.id)
+        let shouldDrain = !lane.draining
+        lane.draining = true
+        lock.unlock()
+
+        if shouldDrain {
+            lane.queue.async { self.drain(lane) }
+        }
+    }
+
+    /// Send pending jobs of a lane until there is nothing left.
+    fileprivate func drain(_ lane: Lane) {
+        while true {
+            lock.lock()
+            guard let first = lane.pending.first else {
+                lane.draining = false
+                lock.unlock()
+                return
+            }
+            // Only jobs for the same port can go together, streamed jobs go alone
+            var batch: [Job] = [first]
+            for job in lane.pending.dropFirst() {
+                guard !first.isStreamed, !job.isStreamed, batch.count < maxBatchSize, job.portName == first.portName, job.portSettings == first.portSettings else { break }
+                batch.append(job)
+            }
+            lane.pending.removeFirst(batch.count)
+            lock.unlock()
+
+            let data: NSData
+            if batch.count == 1 {
+                data = first.data
+            } else {
+                let merged = NSMutableData(capacity: batch.reduce(0) { $0 + $1.data.length }) ?? NSMutableData()
+                for job in batch {
+                    merged.append(job.data as Data)
+                }
+                data = merged
+                d("[StarPrintScheduler] Sending \(batch.count) jobs to \(first.portName) in one block")
+            }
+            // One sync for the whole batch, including the jobs queued meanwhile
+            if let spool = spool {
+                for job in batch {
+                    spool.mark(job.id, .sent)
+                }
+                spool.flush()
+            }
+            var failure: Error? = nil
+            do {
+                try StarCommunication.sendInCheckedBlock(commands: data, portName: first.portName, portSettings: first.portSettings, timeout: timeout, isCancelled: first.isCancelled ?? { false }, progress: first.progress)
+            } catch {
+                w("[StarPrintScheduler] Could not send to \(first.portName) - \(error.localizedDescription)")
+                failure = error
+            }
+            let result = failure == nil
+            // A cancelled job is not printed again either
+            let cancelled = first.isCancelled?() ?? false
+            if let spool = spool, result || cancelled {
+                for job in batch {
+                    spool.mark(job.id, .acked)
+                }
+                spool.flush()
+            }
+            lock.lock()
+            for job in batch {
+                inflight.remove(job.id)
+            }
+            lock.unlock()
+            for job in batch {
+                job.result = result
+                job.completed(failure)
+                job.done.signal()
+            }
+        }
+    }
+}
@@ -0,0 +1,132 @@
+//
+//  OrderReplica.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 9/6/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+/// The not voided orders of a shift as Main had them at a database sequence. Subs catch up with
+/// Main by asking only for the orders changed since then, as patches of the held revisions.
+class OrderReplica {
+    fileprivate let lock = NSLock()
+    /// The shift of the held orders.
+    fileprivate var shiftID = ""
+    /// The Main database sequence caught up with, 0 for nothing held.
+    fileprivate var checkpoint: UInt64 = 0
+    /// Properties of the held orders by document id.
+    fileprivate var documents: [String: [String: Any]] = [:]
+
+    /// The last Main database sequence known from events.
+    fileprivate var latestSequence: UInt64 = 0
+
+    /// `true` if an event told about changes not caught up with yet.
+    var isBehind: Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        return latestSequence > checkpoint
+    }
+
+    /// Keep the sequence of a change raised by Main.
+    ///
+    /// - Parameter sequence: The change sequence.
+    func raised(_ sequence: UInt64) {
+        lock.lock()
+        latestSequence = max(latestSequence, sequence)
+        lock.unlock()
+    }
+
+    /// The content of the catching up request.
+    ///
+    /// - Parameter shiftID: The shift to catch up with.
+    /// - Returns: `shiftid`, `since` and the held revisions `revs`.
+    func request(_ shiftID: String) -> [String: Any] {
+        lock.lock()
+        defer { lock.unlock() }
+        guard shiftID == self.shiftID else {
+            return ["shiftid": shiftID, "since": 0, "revs": [:]]
+        }
+        var revisions: [String: String] = [:]
+        for (docID, properties) in documents {
+            revisions[docID] = properties["_rev"] as? String
+        }
+        return ["shiftid": shiftID, "since": NSNumber(value: checkpoint), "revs": revisions]
+    }
+
+    /// Apply the changes returned by Main.
+    ///
+    /// - Parameters:
+    ///   - response: The changes.
+    ///   - request: The request the changes are for.
+    /// - Returns: The ids of the changed orders, `nil` if the changes do not apply to the held orders.
+    func apply(_ response: [String: Any], for request: [String: Any]) -> [String]? {
+        guard let shiftID = request["shiftid"] as? String,
+            let since = (request["since"] as? NSNumber)?.uint64Value,
+            let last = (response["last_seq"] as? NSNumber)?.uint64Value,
+            let changes = response["changes"] as? [[String: Any]] else {
+                return nil
+        }
+        let reset = (response["reset"] as? Bool) ?? true
+        lock.lock()
+        defer { lock.unlock() }
+        // Caught up by another request in between
+        guard reset || (shiftID == self.shiftID && since == checkpoint) else {
+            return nil
+        }
+        var documents = reset ? [:] : self.documents
+        var changed: [String] = reset ? self.documents.keys.map { $0 } : []
+        for change in changes {
+            guard let docID = change["id"] as? String else { continue }
+            if let properties = change["doc"] as? [String: Any] {
+                documents[docID] = properties
+            } else if let patch = change["patch"] as? [[String: Any]] {
+                guard let original = documents[docID], (original["_rev"] as? String) == (change["base"] as? String),
+                    let properties = JSONPatch.apply(patch, to: original) else {
+                        // Start over next time
+                        w("[OrderReplica] Could not patch \(docID)")
+                        self.checkpoint = 0
+                        return nil
+                }
+                documents[docID] = properties
+            } else {
+                documents[docID] = nil
+            }
+            changed.append(docID)
+        }
+        self.shiftID = shiftID
+        self.checkpoint = last
+        self.documents = documents
+        self.latestSequence = max(latestSequence, last)
+        let prefix = "\(Order.documentIDPrefix)_"
+        return Array(Set(changed)).map { String($0.dropFirst(prefix.count)) }
+    }
+
+    /// The opening orders of the held shift, selected as Main does.
+    ///
+    /// - Parameters:
+    ///   - shiftID: The shift.
+    ///   - area: The area, `nil` for all areas.
+    ///   - filter: The delivered filter for delivery area (ALL, DELIVERED or PENDING).
+    /// - Returns: The orders, `nil` if the shift is not held.
+    func load(openingOrders shiftID: String, inArea area: Area?, withFilter filter: String) -> [Order]? {
+        lock.lock()
+        let documents = shiftID == self.shiftID && checkpoint > 0 ? self.documents.map { ($0.key, $0.value) } : nil
+        lock.unlock()
+        return documents.map { documents in
+            OpenOrdersIndex.properties(openingOrders: documents, inArea: area, withFilter: filter)
+                .map { properties in Order.decoded(properties) }
+        }
+    }
+
+    /// Forget the held orders.
+    func reset() {
+        lock.lock()
+        shiftID = ""
+        checkpoint = 0
+        latestSequence = 0
+        documents = [:]
+        lock.unlock()
+    }
+}
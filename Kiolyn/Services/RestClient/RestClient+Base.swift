@@ -24,14 +24,14 @@ extension RestClient {
         }
         return Single.create { single in
             let endpoint = "\(mainURL)/\(path)"
-            Alamofire.request(endpoint)
+            self.session.request(endpoint)
                 .log()
-                .responseObject(queue: self.queue) { (res: DataResponse<T>) in
+                .responseWire(queue: self.queue) { (res: DataResponse<Any>) in
                     //v("RES - \(String(data: res.data!, encoding: .utf8))")
                     if let error = res.error {
                         e(error)
                     }
-                    single(.success(res.value))
+                    single(.success(res.value.flatMap { Mapper<T>().map(JSONObject: $0) }))
             }
             return Disposables.create()
         }
@@ -47,14 +47,14 @@ extension RestClient {
         }
         return Single.create { single in
             let endpoint = "\(mainURL)/\(path)"
-            Alamofire.request(endpoint, method: .get, parameters: params)
+            self.session.request(endpoint, method: .get, parameters: params)
                 .log()
-                .responseArray(queue: self.queue) { (res: DataResponse<[T]>) in
+                .responseWire(queue: self.queue) { (res: DataResponse<Any>) in
                     //v("RES - \(String(data: res.data!, encoding: .utf8))")
                     if let error = res.error {
                         e(error)
                     }
-                    single(.success(res.value ?? []))
+                    single(.success(res.value.flatMap { Mapper<T>().mapArray(JSONObject: $0) } ?? []))
             }
             return Disposables.create()
         }
@@ -72,9 +72,9 @@ extension RestClient {
         }
         return Single.create { single in
             let endpoint = "\(mainURL)/\(path)"
-            Alamofire.request(endpoint, method: .post, parameters: data, encoding: JSONEncoding.default)
+            self.session.request(endpoint, method: .post, parameters: data, encoding: JSONEncoding.default)
                 .log()
-                .responseJSON(queue: self.queue) { (res: DataResponse<Any>) in
+                .responseWire(queue: self.queue) { (res: DataResponse<Any>) in
                     //v("RES - \(String(data: res.data!, encoding: .utf8))")
                     if let error = res.error {
                         e(error)
@@ -106,14 +106,14 @@ extension RestClient {
         }
         return Single.create { single in
             let endpoint = "\(mainURL)/\(path)"
-            Alamofire.request(endpoint, method: .post, parameters: data, encoding: JSONEncoding.default)
+            self.session.request(endpoint, method: .post, parameters: data, encoding: JSONEncoding.default)
                 .log()
-                .responseObject(queue: self.queue) { (res: DataResponse<T>) in
+                .responseWire(queue: self.queue) { (res: DataResponse<Any>) in
                     //v("RES - \(String(data: res.data!, encoding: .utf8))")
                     if let error = res.error {
                         e(error)
                     }
-                    single(.success(res.value))
+                    single(.success(res.value.flatMap { Mapper<T>().map(JSONObject: $0) }))
             }
             return Disposables.create()
         }
@@ -129,7 +129,7 @@ extension RestClient {
         }
         return Single.create { single in
             let endpoint = "\(mainURL)/\(path)"
-            Alamofire.request(endpoint, method: .delete)
+            self.session.request(endpoint, method: .delete)
                 .log()
                 .responseJSON { res in
                     //v("RES - \(String(data: res.data!, encoding: .utf8))")
@@ -152,20 +152,78 @@ extension RestClient {
         }
         return Single.create { single in
             let endpoint = "\(mainURL)/\(path)"
-            Alamofire.request(endpoint, method: .get, parameters: params)
+            self.session.request(endpoint, method: .get, parameters: params)
                 .log()
-                .responseObject(queue: self.queue) { (res: DataResponse<QueryResult<T>>) in
+                .responseWire(queue: self.queue) { (res: DataResponse<Any>) in
                     //v("RES - \(String(data: res.data!, encoding: .utf8))")
                     if let error = res.error {
                         e(error)
                     }
-                    single(.success(res.value ?? QueryResult()))
+                    single(.success(res.value.flatMap { Mapper<QueryResult<T>>().map(JSONObject: $0) } ?? QueryResult()))
             }
             return Disposables.create()
         }
     }
 }
 
+// MARK: - Session
+extension RestClient {
+    /// The session talking to Main over the LAN: few persistent keep-alive connections with
+    /// pipelined requests, no caching, short timeouts and asking for the most compact response
+    /// Main can give (see `WireFormat`).
+    ///
+    /// - Returns: the session manager.
+    static func lanSession() -> SessionManager {
+        let configuration = URLSessionConfiguration.default
+        var headers = SessionManager.defaultHTTPHeaders
+        headers["Accept"] = WireFormat.accept
+        headers["Connection"] = "keep-alive"
+        configuration.httpAdditionalHeaders = headers
+        configuration.httpMaximumConnectionsPerHost = 2
+        configuration.httpShouldUsePipelining = true
+        configuration.requestCachePolicy = .reloadIgnoringLocalCacheData
+        configuration.urlCache = nil
+        configuration.timeoutIntervalForRequest = 10
+        return SessionManager(configuration: configuration)
+    }
+}
+
+extension DataRequest {
+    /// Serializer decoding the response by its `WireFormat` marker byte, JSON without, as sent by
+    /// Mains not knowing about it.
+    ///
+    /// - Returns: the serializer.
+    static func wireResponseSerializer() -> DataResponseSerializer<Any> {
+        return DataResponseSerializer { _, response, data, error in
+            if let error = error {
+                return .failure(error)
+            }
+            if let response = response, [204, 205].contains(response.statusCode) {
+                return .success(NSNull())
+            }
+            guard let data = data, data.count > 0 else {
+                return .failure(AFError.responseSerializationFailed(reason: .inputDataNilOrZeroLength))
+            }
+            do {
+                return .success(try WireFormat.decode(data))
+            } catch {
+                return .failure(error)
+            }
+        }
+    }
+    
+    /// Add a handler called with the response decoded by its marker byte.
+    ///
+    /// - Parameters:
+    ///   - queue: the queue to call the handler on.
+    ///   - completionHandler: the handler.
+    /// - Returns: the request.
+    @discardableResult
+    func responseWire(queue: DispatchQueue? = nil, completionHandler: @escaping (DataResponse<Any>) -> Void) -> Self {
+        return response(queue: queue, responseSerializer: DataRequest.wireResponseSerializer(), completionHandler: completionHandler)
+    }
+}
+
 // MARK: - For logging request
 extension Request {
     func log() -> Self {
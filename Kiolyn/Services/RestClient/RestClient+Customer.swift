@@ -38,12 +38,14 @@ extension RestClient {
     /// - Parameters:
     ///   - page: the page to load for.
     ///   - pageSize: the page limit to load for
+    ///   - next: the continuation key of the previous page, to load the page without skipping rows.
     /// - Returns: Single of the loading result.
-    func loadCustomers(page: UInt, pageSize: UInt) -> Single<QueryResult<Customer>> {
+    func loadCustomers(page: UInt, pageSize: UInt, after next: String? = nil) -> Single<QueryResult<Customer>> {
         guard let storeID = store?.id else {
             return Single.just(QueryResult())
         }
-        let params: [String: Any] = [ "page": page, "pagecount": pageSize ]
+        var params: [String: Any] = [ "page": page, "pageCount": pageSize ]
+        params["next"] = next
         return query(model: "store/\(storeID)/customer", params: params)
     }
 }
@@ -51,7 +51,7 @@ extension RestClient {
         return Single.create { single in
             let endpoint = "\(mainURL)/docs"
             let data = models.map { m in m.toJSON() }            
-            Alamofire.request(endpoint, method: .post, parameters: data.asParameters, encoding: ArrayEncoding())
+            self.session.request(endpoint, method: .post, parameters: data.asParameters, encoding: ArrayEncoding())
                 .log()
                 .responseJSON(queue: self.queue) { (res: DataResponse<Any>) in
                     if let error = res.error {
@@ -12,30 +12,20 @@ import Alamofire
 
 extension RestClient {
     
-    /// Ask Main to lock the given Order' id(s).
+    /// Ask Main to lock the given Order' id(s), keeping the fencing tokens of their leases.
     ///
     /// - Parameter orders: the Order' id(s) to be locked.
     /// - Returns: Single of the Order(s) that were locked.
     func lock(orders: [String]) -> Single<[Order]> {
-        guard let mainURL = self.mainURL?.absoluteString, let storeID = store?.id, let stationID = station?.id else {
+        guard mainURL != nil, store != nil, station != nil else {
             return Single.just([])
         }
-        return Single.create { single in
-            let endpoint = "\(mainURL)/store/\(storeID)/order/lock"
-            let data: [String: Any] = ["station_id": stationID, "orders": orders]
-            Alamofire.request(endpoint, method: .post, parameters: data, encoding: JSONEncoding.default)
-                .log()
-                .responseArray(queue: self.queue) { (res: DataResponse<[Order]>) in
-                    if let error = res.error {
-                        e(error)
-                        if let data = res.data, let strRes = String(data: data, encoding: .utf8) {
-                            d("RES - \(strRes)")
-                        }
-                        return single(.error(LockingOrderError.alreadyLocked))
-                    }
-                    single(.success(res.value ?? []))
-            }
-            return Disposables.create()
+        return commit(orderTransaction: orders, save: [], unlock: false)
+            .map { result in
+                guard let result = result else {
+                    throw LockingOrderError.alreadyLocked
+                }
+                return result.orders
         }
     }
     
@@ -49,12 +39,15 @@ extension RestClient {
         return Single.create { single in
             let endpoint = "\(mainURL)/store/\(storeID)/order/unlock-all"
             let data: [String: Any] = ["station_id": stationID]
-            Alamofire.request(endpoint, method: .post, parameters: data, encoding: JSONEncoding.default)
+            self.session.request(endpoint, method: .post, parameters: data, encoding: JSONEncoding.default)
                 .log()
-                .responseJSON(queue: self.queue) { (res: DataResponse<Any>) in
+                .responseWire(queue: self.queue) { (res: DataResponse<Any>) in
                     if let error = res.error {
                         e(error)
                     }
+                    self.lockTokensLock.lock()
+                    self.lockTokens = [:]
+                    self.lockTokensLock.unlock()
                     single(.success((res.value as? Bool) ?? false))
             }
             return Disposables.create()
@@ -70,9 +63,9 @@ extension RestClient {
         }
         return Single.create { single in
             let endpoint = "\(mainURL)/store/\(storeID)/order/locked"
-            Alamofire.request(endpoint)
+            self.session.request(endpoint)
                 .log()
-                .responseJSON(queue: self.queue) { (res: DataResponse<Any>) in
+                .responseWire(queue: self.queue) { (res: DataResponse<Any>) in
                     if let error = res.error {
                         e(error)
                     }
@@ -30,7 +30,7 @@ extension RestClient {
         guard let storeID = store?.id else {
             return Single.just([])
         }
-        return load(multiModel: "store/\(storeID)/category/\(categoryID)/items")
+        return load(menu: "store/\(storeID)/category/\(categoryID)/items")
     }
     
     /// Load all the modifiers belong to a given item.
@@ -41,7 +41,7 @@ extension RestClient {
         guard let storeID = store?.id else {
             return Single.just([])
         }
-        return load(multiModel: "store/\(storeID)/item/\(itemID)/modifiers")
+        return load(menu: "store/\(storeID)/item/\(itemID)/modifiers")
     }
     
     /// Load all the global modifiers belong to current store.
@@ -51,6 +51,40 @@ extension RestClient {
         guard let storeID = store?.id else {
             return Single.just([])
         }
-        return load(multiModel: "store/\(storeID)/modifier/global")
+        return load(menu: "store/\(storeID)/modifier/global")
+    }
+    
+    /// Drop the menu models loaded from Main.
+    func clearMenu() {
+        menuLock.lock()
+        menuModels = [:]
+        menuGeneration += 1
+        menuLock.unlock()
+    }
+    
+    /// Load menu models from memory, from Main if not yet loaded. Copies are returned, the kept
+    /// models are never handed out.
+    ///
+    /// - Parameter path: the GET path.
+    /// - Returns: Single of the loading result.
+    fileprivate func load<T: BaseModel>(menu path: String) -> Single<[T]> {
+        menuLock.lock()
+        let cached = menuModels[path] as? [T]
+        let generation = menuGeneration
+        menuLock.unlock()
+        if let cached = cached {
+            return Single.just(cached.map { $0.duplicate() })
+        }
+        return load(multiModel: path).map { (models: [T]) -> [T] in
+            // Empty result could be a failure, do not keep it
+            if models.isNotEmpty {
+                self.menuLock.lock()
+                if generation == self.menuGeneration {
+                    self.menuModels[path] = models
+                }
+                self.menuLock.unlock()
+            }
+            return models.map { $0.duplicate() }
+        }
     }
 }
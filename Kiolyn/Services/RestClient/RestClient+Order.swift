@@ -8,6 +8,7 @@
 
 import Foundation
 import RxSwift
+import Alamofire
 
 extension RestClient {
     
@@ -22,8 +23,34 @@ extension RestClient {
         guard let storeID = store?.id else {
             return Single.just([])
         }
-        let params = ["shiftid": shiftID, "areaid": area?.id ?? "", "filter": filter]
-        return load(multiModel: "store/\(storeID)/order/opening", params: params)
+        return catchUp(orders: shiftID).flatMap { changed -> Single<[Order]> in
+            if changed != nil, let orders = self.orderReplica.load(openingOrders: shiftID, inArea: area, withFilter: filter) {
+                return Single.just(orders)
+            }
+            // Main without order changes
+            let params = ["shiftid": shiftID, "areaid": area?.id ?? "", "filter": filter]
+            return self.load(multiModel: "store/\(storeID)/order/opening", params: params)
+        }
+    }
+    
+    /// Catch up with the orders of a shift changed on Main since the last time.
+    ///
+    /// - Parameter shiftID: the shift to catch up with.
+    /// - Returns: Single of the changed order ids, `nil` if Main did not answer.
+    func catchUp(orders shiftID: String) -> Single<[String]?> {
+        guard let storeID = store?.id else {
+            return Single.just(nil)
+        }
+        let request = orderReplica.request(shiftID)
+        let response: Single<[String: Any]?> = post(path: "store/\(storeID)/order/changes", data: request)
+        return response.map { response in
+            guard let response = response else {
+                return nil
+            }
+            let changed = self.orderReplica.apply(response, for: request) ?? []
+            v("[RestClient] Caught up with \(changed.count) orders changed since \(request["since"] ?? 0)")
+            return changed
+        }
     }
     
     /// Delete Order from Main.
@@ -36,15 +63,131 @@ extension RestClient {
         return delete(model: "store/\(storeID)/order/\(order.id)")
     }
     
-    /// Save Order to Main.
+    /// Save Order to Main, with the fencing token of its lease for Main to renew it or to refuse the
+    /// save if the lease was lost.
     ///
-    /// - Parameter order: the Order to be saved.
+    /// - Parameters:
+    ///   - order: the Order to be saved.
+    ///   - unlockingAll: `true` to also unlock all the orders of this station in the same request.
     /// - Returns: Single of the new revision
-    func save(order: Order) -> Single<String?> {
-        guard let storeID = store?.id else {
+    func save(order: Order, unlockingAll: Bool = false) -> Single<String?> {
+        guard let storeID = store?.id, let stationID = station?.id else {
+            return Single.just(nil)
+        }
+        guard unlockingAll else {
+            lockTokensLock.lock()
+            let token = lockTokens[order.id]
+            lockTokensLock.unlock()
+            var path = "store/\(storeID)/order?station_id=\(stationID)"
+            if let token = token {
+                path += "&token=\(token)"
+            }
+            return post(path: path, data: order.toJSON())
+        }
+        return commit(orderTransaction: [], save: [order], unlock: true)
+            .map { result in result?.revisions.first }
+    }
+    
+    /// Lock, save then unlock orders on Main in one request. The saved orders are sent with the
+    /// fencing tokens of their leases, for Main to refuse them if the leases were lost. Main
+    /// predating the transactions is sent one request each instead.
+    ///
+    /// - Parameters:
+    ///   - lock: the ids of the orders to lock.
+    ///   - save: the orders to save, saved together or not at all.
+    ///   - unlock: `true` to unlock all the orders of this station at the end.
+    /// - Returns: Single of the locked orders and the new revisions of the saved ones, `nil` if an order is locked by another station or nothing could be saved.
+    func commit(orderTransaction lock: [String], save: [Order], unlock: Bool) -> Single<(orders: [Order], revisions: [String])?> {
+        guard let mainURL = mainURL, let storeID = store?.id, let stationID = station?.id else {
+            return Single.just(nil)
+        }
+        guard mainURL != transactionlessMain else {
+            return commit(withoutTransaction: lock, save: save, unlock: unlock)
+        }
+        lockTokensLock.lock()
+        var tokens: [String: NSNumber] = [:]
+        for order in save {
+            tokens[order.id] = lockTokens[order.id].map { token in NSNumber(value: token) }
+        }
+        lockTokensLock.unlock()
+        let data: [String: Any] = [
+            "station_id": stationID,
+            "lock": lock,
+            "save": save.map { order in order.toJSON() },
+            "tokens": tokens,
+            "unlock": unlock
+        ]
+        let response: Single<DataResponse<Any>> = Single.create { single in
+            let endpoint = "\(mainURL.absoluteString)/store/\(storeID)/order/transaction"
+            self.session.request(endpoint, method: .post, parameters: data, encoding: JSONEncoding.default)
+                .log()
+                .responseWire(queue: self.queue) { (res: DataResponse<Any>) in
+                    single(.success(res))
+            }
+            return Disposables.create()
+        }
+        return response.flatMap { res -> Single<(orders: [Order], revisions: [String])?> in
+            guard res.response?.statusCode != 404 else {
+                w("[RestClient] Main without order transactions, locking and saving in one request each")
+                self.transactionlessMain = mainURL
+                return self.commit(withoutTransaction: lock, save: save, unlock: unlock)
+            }
+            if let error = res.error {
+                e(error)
+            }
+            guard let response = res.value as? [String: Any], (response["locked"] as? Bool) == true,
+                let orders = response["orders"] as? [[String: Any]],
+                let revisions = response["revs"] as? [String] else {
+                    return Single.just(nil)
+            }
+            self.lockTokensLock.lock()
+            for (orderID, token) in (response["tokens"] as? [String: NSNumber]) ?? [:] {
+                self.lockTokens[orderID] = token.uint64Value
+            }
+            if unlock {
+                self.lockTokens = [:]
+            }
+            self.lockTokensLock.unlock()
+            return Single.just((orders.map { properties in Order.decoded(properties) }, revisions))
+        }
+    }
+    
+    /// Lock, save then unlock orders on Main predating the order transactions, in one request each.
+    ///
+    /// - Parameters:
+    ///   - lock: the ids of the orders to lock.
+    ///   - save: the orders to save, one after the other.
+    ///   - unlock: `true` to unlock all the orders of this station at the end, also if locking or saving failed.
+    /// - Returns: Single of the locked orders and the new revisions of the saved ones, `nil` if an order is locked by another station or could not be saved.
+    private func commit(withoutTransaction lock: [String], save: [Order], unlock: Bool) -> Single<(orders: [Order], revisions: [String])?> {
+        guard let storeID = store?.id, let stationID = station?.id else {
             return Single.just(nil)
         }
-        return post(path: "store/\(storeID)/order", data: order.toJSON())
+        let locking: Single<[[String: Any]]?> = lock.isEmpty
+            ? Single.just([])
+            : post(path: "store/\(storeID)/order/lock", data: ["station_id": stationID, "orders": lock])
+        let committing = locking.flatMap { locked -> Single<(orders: [Order], revisions: [String])?> in
+            guard let locked = locked, locked.count == lock.count else {
+                return Single.just(nil)
+            }
+            let saving: [Observable<String?>] = save.map { order in
+                let revision: Single<String?> = self.post(path: "store/\(storeID)/order", data: order.toJSON())
+                return revision.asObservable()
+            }
+            return Observable.concat(saving).toArray().asSingle().map { revisions in
+                let revisions = revisions.compactMap { revision in revision }
+                guard revisions.count == save.count else {
+                    return nil
+                }
+                return (locked.map { properties in Order.decoded(properties) }, revisions)
+            }
+        }
+        guard unlock else {
+            return committing
+        }
+        return committing.flatMap { result in
+            self.unlockAllOrders().map { _ in result }
+        }
     }
     
     /// Load Order(s) by status with support for pagination.
@@ -54,13 +197,15 @@ extension RestClient {
     ///   - status: the status of the Order to filter for.
     ///   - page: the current page to load for.
     ///   - pageSize: the number of order to load for.
+    ///   - next: the continuation key of the previous page, to load the page without skipping rows.
     /// - Returns: Single of the QueryResult.
-    func load(orders shiftID: String, statuses: [OrderStatus], page: UInt, pageSize: UInt) -> Single<QueryResult<Order>> {
+    func load(orders shiftID: String, statuses: [OrderStatus], page: UInt, pageSize: UInt, after next: String? = nil) -> Single<QueryResult<Order>> {
         guard let storeID = store?.id else {
             return Single.just(QueryResult())
         }
         let status = statuses.first?.rawValue ?? ""
-        let params: [String: Any] = ["shiftid": shiftID, "status": status, "page": page, "pagecount": pageSize]
+        var params: [String: Any] = ["shiftid": shiftID, "status": status, "page": page, "pageCount": pageSize]
+        params["next"] = next
         return query(model: "store/\(storeID)/order", params: params)
     }
     
@@ -28,7 +28,8 @@ extension RestClient {
             return
         }
         
-        let eventUrl = "ws://\(host):\(port)/event"
+        // Lock changes are applied as delta, see `raise(serverEvent:)`
+        let eventUrl = "ws://\(host):\(port)/event?delta=1"
         // Make sure we dont start 2 times
         guard eventWS?.url != eventUrl else {
             return
@@ -37,6 +38,9 @@ extension RestClient {
         let ws = WebSocket(eventUrl)
         ws.event.open = {
             d("[WS] Opened Event stream to Main")
+            // Menu and orders could have changed while not listening, Main could be another one
+            self.clearMenu()
+            self.orderReplica.reset()
         }
         ws.event.close = { code, reason, clean in
             d("[WS] Closed Event stream to Main")
@@ -61,29 +65,78 @@ extension RestClient {
     private func raise(serverEvent event: ServerEvent) {
         let ds = SP.dataService
         let auth = SP.authService
-        guard let type = event.type, !auth.isSignedOut else {
+        guard let type = event.type else {
             return
         }
-        switch type {
-        case .lockedOrdersChanged:
-            guard let lockedOrders = event.content as? [String: String] else {
+        // Menu is kept even when signed out
+        if type == .menuChanged || type == .resync {
+            clearMenu()
+        }
+        if type == .menuChanged {
+            v("[WS] menuChanged \(event.content ?? "")")
+            return
+        }
+        // Locks are kept even when signed out, the changes apply to the locked orders sent on connecting
+        if type == .lockedOrdersChanged {
+            // Sent along with each delta too, already applied then
+            guard let lockedOrders = event.content as? [String: String], lockedOrders != ds.lockedOrders.value else {
                 return
             }
             // Locked orders changed remotely, we need to update the locked orders
             ds.lockedOrders.accept(lockedOrders)
             v("[WS] lockedOrdersChanged \(lockedOrders)")
+            return
+        }
+        if type == .lockedOrdersDelta {
+            guard let content = event.content as? [String: Any] else {
+                return
+            }
+            let delta = OrderLockDelta(
+                locked: (content["locked"] as? LockedOrders) ?? [:],
+                unlocked: (content["unlocked"] as? [String]) ?? [])
+            ds.lockedOrders.accept(delta.apply(to: ds.lockedOrders.value))
+            v("[WS] lockedOrdersDelta \(delta)")
+            return
+        }
+        guard !auth.isSignedOut else {
+            return
+        }
+        switch type {
         case .orderChanged:
             guard let orderIDs = event.content as? String else {
                 return
             }
             let ids = orderIDs.components(separatedBy: ",")
-            // Order changed remotely, we need to inform listener to update UI accordingly
-            ds.remoteOrderChanged.onNext(ids)
+            if let sequence = event.sequence?.uint64Value {
+                orderReplica.raised(sequence)
+            }
             v("[WS] ordersChanged \(ids)")
+            // Behind Main, catch up first for the missed changes to be raised too
+            guard orderReplica.isBehind, let shiftID = ds.activeShift.value?.id else {
+                // Order changed remotely, we need to inform listener to update UI accordingly
+                ds.remoteOrderChanged.onNext(ids)
+                return
+            }
+            _ = catchUp(orders: shiftID).subscribe(onSuccess: { changed in
+                ds.remoteOrderChanged.onNext(Array(Set(ids + (changed ?? []))))
+            })
         case .activeShiftChanged:
             // Shift changed remotely, we need to reload it
             _ = ds.loadActiveShift().subscribe()
             v("[WS] activeShiftChanged")
+        case .resync:
+            // Too far behind Main, reload everything raised by events
+            v("[WS] resync")
+            _ = loadLockedOrders().subscribe(onSuccess: { lockedOrders in ds.lockedOrders.accept(lockedOrders) })
+            _ = ds.loadActiveShift().subscribe()
+            guard let shiftID = ds.activeShift.value?.id else {
+                return
+            }
+            _ = catchUp(orders: shiftID).subscribe(onSuccess: { changed in
+                ds.remoteOrderChanged.onNext(changed ?? [])
+            })
+        case .menuChanged, .lockedOrdersChanged, .lockedOrdersDelta:
+            break
         }
     }
     
@@ -96,18 +149,26 @@ extension RestClient {
 
 enum ServerEventType: String {
     case lockedOrdersChanged = "LockedOrdersChanged"
+    /// Orders locked and unlocked since the last locked orders.
+    case lockedOrdersDelta = "LockedOrdersDelta"
     case orderChanged = "OrderChanged"
     case activeShiftChanged = "ActiveShiftChanged"
+    case menuChanged = "MenuChanged"
+    /// Events were dropped, everything raised by events must be reloaded.
+    case resync = "Resync"
 }
 
 fileprivate class ServerEvent: Mappable {
     var type: ServerEventType?
     var content: Any?
+    /// Main database sequence of the change.
+    var sequence: NSNumber?
     
     required init?(map: Map) { }
     
     func mapping(map: Map) {
         type <- (map["type"], EnumTransform<ServerEventType>())
         content <- map["content"]
+        sequence <- map["seq"]
     }
 }
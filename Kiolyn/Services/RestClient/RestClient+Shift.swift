@@ -31,4 +31,22 @@ extension RestClient {
         }
         return post(model: "store/\(storeID)/shift/active/counter/\(counter.rawValue.lowercased())", data: [:])
     }
+    
+    /// Load the unsettled transactions of a shift from Main, with support for pagination.
+    ///
+    /// - Parameters:
+    ///   - shiftID: the Shift to load for.
+    ///   - paymentType: the payment type to filter for, empty for all.
+    ///   - page: the page to load for.
+    ///   - pageSize: the number of transactions to load for.
+    ///   - next: the continuation key of the previous page, to load the page without skipping rows.
+    /// - Returns: Single of the QueryResult.
+    func load(unsettledTransactions shiftID: String, for paymentType: String, page: UInt, pageSize: UInt, after next: String? = nil) -> Single<QueryResult<Transaction>> {
+        guard let storeID = store?.id else {
+            return Single.just(QueryResult())
+        }
+        var params: [String: Any] = ["shiftid": shiftID, "paymenttype": paymentType, "page": page, "pageCount": pageSize]
+        params["next"] = next
+        return query(model: "store/\(storeID)/transaction/unsettled", params: params)
+    }
 }
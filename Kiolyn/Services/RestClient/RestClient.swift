@@ -9,6 +9,7 @@
 import Foundation
 import RxSwift
 import SwiftWebSocket
+import Alamofire
 
 enum RestClientError: LocalizedError {
     case invalidResponse
@@ -48,11 +49,30 @@ class RestClient {
     }
     
     let queue = DispatchQueue(label: "com.willbe.kiolyn.rest-client", qos: .utility, attributes: [.concurrent])
+    
+    /// The session all requests to Main go through, keeping connections to Main alive.
+    let session = RestClient.lanSession()
+    
+    /// Orders of the active shift caught up with from Main.
+    let orderReplica = OrderReplica()
+    
+    /// Menu models loaded from Main by path, dropped when Main raises `menuChanged`.
+    var menuModels: [String: [BaseModel]] = [:]
+    /// Bumped each time the menu models are dropped, for not keeping responses of older menus.
+    var menuGeneration = 0
+    let menuLock = NSLock()
+    /// Fencing tokens of the orders leased to this station, sent back when saving them.
+    var lockTokens: [String: UInt64] = [:]
+    let lockTokensLock = NSLock()
+    /// Main found predating the order transactions, orders are locked, saved and unlocked in one request each then.
+    var transactionlessMain: URL? = nil
     let disposeBag = DisposeBag()
     
     init() {
         SP.stationManager.mainStation
             .subscribe(onNext: { main in
+                // Main may have been upgraded meanwhile
+                self.transactionlessMain = nil
                 self.start(eventClient: main?.0)
             })
             .disposed(by: disposeBag)
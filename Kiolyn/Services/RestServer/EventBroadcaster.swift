@@ -0,0 +1,343 @@
+//
+//  EventBroadcaster.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 9/8/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+import Swifter
+
+/// A Sub connection events are written to.
+protocol EventSession: class {
+    /// The Sub address.
+    var name: String { get }
+    /// Write an event frame, blocking until written.
+    func writeText(_ text: String)
+    /// Close the connection, the Sub reconnects.
+    func close()
+}
+
+extension WebSocketSession: EventSession {
+    var name: String {
+        return (try? socket.peername()) ?? "unknown"
+    }
+
+    func close() {
+        socket.close()
+    }
+}
+
+/// Send server events to the Subs websocket sessions. Each session has its own queue written in
+/// background, a slow Sub does not hold back the others nor the thread raising the event. Order
+/// and lock changes raised within a short window are sent as one event. The lock changes go as
+/// a delta to the Subs declaring it when opening `/event`, the others are sent all the locked
+/// orders instead. A session with too many events queued is told to resync instead, one not
+/// writing anything for too long is dropped.
+class EventBroadcaster {
+    /// Order and lock changes raised within this window are sent as one event.
+    static let coalescingWindow: DispatchTimeInterval = .milliseconds(50)
+    /// Sessions having more events queued are sent a single resync event instead.
+    static let maxQueued = 32
+    /// Sessions not done writing an event for this long are dropped.
+    static let maxLag: TimeInterval = 10
+
+    /// Lag metrics of a session.
+    struct Metrics {
+        /// The Sub address.
+        let session: String
+        /// The events waiting to be written.
+        let queued: Int
+        /// The written events.
+        let sent: Int
+        /// The times the session was told to resync.
+        let resyncs: Int
+        /// Time from raising to writing of the last written event.
+        let lag: TimeInterval
+        /// Longest time from raising to writing of an event.
+        let maxLag: TimeInterval
+
+        /// JSON properties of the metrics.
+        var properties: [String: Any] {
+            return [
+                "session": session,
+                "queued": queued,
+                "sent": sent,
+                "resyncs": resyncs,
+                "lag": Int(lag * 1000),
+                "maxlag": Int(maxLag * 1000)
+            ]
+        }
+    }
+
+    /// The sessions an event is for.
+    fileprivate enum Audience {
+        case all
+        /// Sessions applying the lock changes delta.
+        case delta
+        /// Sessions needing all the locked orders.
+        case full
+
+        func includes(_ outbound: Outbound) -> Bool {
+            switch self {
+            case .all: return true
+            case .delta: return outbound.acceptsDelta
+            case .full: return !outbound.acceptsDelta
+            }
+        }
+    }
+
+    /// The outbound queue of a session.
+    fileprivate class Outbound {
+        let session: EventSession
+        let name: String
+        /// The Sub applies `LockedOrdersDelta`.
+        let acceptsDelta: Bool
+        let queue: DispatchQueue
+        /// The messages waiting to be written with the time they were raised.
+        var messages: [(String, Date)] = []
+        var writing = false
+        /// Start time of the write in progress.
+        var writingSince: Date? = nil
+        /// Raise time of the message being written.
+        var writingRaisedAt: Date? = nil
+        var sent = 0
+        var resyncs = 0
+        var lag: TimeInterval = 0
+        var maxLag: TimeInterval = 0
+
+        init(_ session: EventSession, acceptsDelta: Bool) {
+            self.session = session
+            self.acceptsDelta = acceptsDelta
+            self.name = session.name
+            self.queue = DispatchQueue(label: "com.willbe.kiolyn.event-session", qos: .utility)
+        }
+    }
+
+    fileprivate let lock = NSLock()
+    fileprivate var outbounds: [Outbound] = []
+    /// The order changes waiting for the window to end, in raising order.
+    fileprivate var orderIDs: [String] = []
+    fileprivate var orderSequence: UInt64? = nil
+    /// The lock changes waiting for the window to end.
+    fileprivate var lockDelta: OrderLockDelta? = nil
+    fileprivate var flushing = false
+    fileprivate let queue = DispatchQueue(label: "com.willbe.kiolyn.event-broadcaster", qos: .utility)
+    /// The current locked orders.
+    fileprivate let lockedOrders: () -> LockedOrders
+    /// The current time.
+    fileprivate let now: () -> Date
+
+    /// Create a broadcaster.
+    ///
+    /// - Parameters:
+    ///   - now: the current time.
+    ///   - lockedOrders: the current locked orders.
+    init(now: @escaping () -> Date = Date.init, lockedOrders: @escaping () -> LockedOrders) {
+        self.now = now
+        self.lockedOrders = lockedOrders
+    }
+
+    /// Start sending events to a session, the locked orders first for the lock changes to apply to.
+    ///
+    /// - Parameters:
+    ///   - session: the Sub session.
+    ///   - acceptsDelta: `true` if the Sub applies the lock changes delta, it is sent all the
+    ///     locked orders on every lock change otherwise.
+    func add(_ session: EventSession, acceptsDelta: Bool = false) {
+        let outbound = Outbound(session, acceptsDelta: acceptsDelta)
+        lock.lock()
+        outbounds.append(outbound)
+        if let message = EventBroadcaster.message(.lockedOrdersChanged, content: lockedOrders()) {
+            outbound.messages.append((message, now()))
+            write(outbound)
+        }
+        lock.unlock()
+    }
+
+    /// Stop sending events to a session.
+    ///
+    /// - Parameter session: the Sub session.
+    func remove(_ session: EventSession) {
+        lock.lock()
+        if let outbound = outbounds.first(where: { $0.session === session }) {
+            outbounds = outbounds.filter { $0 !== outbound }
+            d("[Events] \(outbound.name) left after \(outbound.sent) events, max lag \(Int(outbound.maxLag * 1000))ms, \(outbound.resyncs) resyncs")
+        }
+        lock.unlock()
+    }
+
+    /// Send the changed orders, along with the ones changed within the window.
+    ///
+    /// - Parameters:
+    ///   - orderIDs: the changed orders.
+    ///   - sequence: the database sequence of the change.
+    func send(orderChanged orderIDs: [String], sequence: UInt64) {
+        lock.lock()
+        for id in orderIDs where !self.orderIDs.contains(id) {
+            self.orderIDs.append(id)
+        }
+        orderSequence = max(orderSequence ?? 0, sequence)
+        scheduleFlush()
+        lock.unlock()
+    }
+
+    /// Send the lock changes, along with the ones raised within the window.
+    ///
+    /// - Parameter lockDelta: the locked and unlocked orders.
+    func send(lockDelta: OrderLockDelta) {
+        lock.lock()
+        var delta = self.lockDelta ?? OrderLockDelta()
+        delta.merge(lockDelta)
+        self.lockDelta = delta
+        scheduleFlush()
+        lock.unlock()
+    }
+
+    /// Send an event right away, after the coalesced ones waiting.
+    ///
+    /// - Parameters:
+    ///   - type: the event type.
+    ///   - content: the event content.
+    ///   - sequence: the database sequence of the change.
+    func send(_ type: ServerEventType, content: Any?, sequence: UInt64? = nil) {
+        lock.lock()
+        var messages = takeCoalesced()
+        if let message = EventBroadcaster.message(type, content: content, sequence: sequence) {
+            messages.append((message, .all))
+        }
+        enqueue(messages)
+        lock.unlock()
+    }
+
+    /// The lag metrics of the sessions.
+    var metrics: [Metrics] {
+        lock.lock()
+        defer { lock.unlock() }
+        let now = self.now()
+        return outbounds.map { outbound in
+            // The event being written is lagging already
+            let lag = outbound.writingRaisedAt.map { max(outbound.lag, now.timeIntervalSince($0)) } ?? outbound.lag
+            return Metrics(
+                session: outbound.name,
+                queued: outbound.messages.count,
+                sent: outbound.sent,
+                resyncs: outbound.resyncs,
+                lag: lag,
+                maxLag: max(outbound.maxLag, lag))
+        }
+    }
+
+    // MARK: - Coalescing
+
+    /// Flush the coalesced events at the end of the window. Must be called with the lock held.
+    fileprivate func scheduleFlush() {
+        guard !flushing else { return }
+        flushing = true
+        queue.asyncAfter(deadline: .now() + EventBroadcaster.coalescingWindow) {
+            self.lock.lock()
+            self.enqueue(self.takeCoalesced())
+            self.lock.unlock()
+        }
+    }
+
+    /// The coalesced events waiting, lock changes first. Must be called with the lock held.
+    fileprivate func takeCoalesced() -> [(String, Audience)] {
+        var messages: [(String, Audience)] = []
+        if let lockDelta = lockDelta, !lockDelta.isEmpty {
+            if let message = EventBroadcaster.message(.lockedOrdersDelta, content: lockDelta.properties) {
+                messages.append((message, .delta))
+            }
+            // Only built when some Sub did not declare the delta
+            if outbounds.contains(where: { !$0.acceptsDelta }),
+                let message = EventBroadcaster.message(.lockedOrdersChanged, content: lockedOrders()) {
+                messages.append((message, .full))
+            }
+        }
+        if orderIDs.isNotEmpty,
+            let message = EventBroadcaster.message(.orderChanged, content: orderIDs.joined(separator: ","), sequence: orderSequence) {
+            messages.append((message, .all))
+        }
+        lockDelta = nil
+        orderIDs = []
+        orderSequence = nil
+        flushing = false
+        return messages
+    }
+
+    // MARK: - Sending
+
+    /// Queue messages to all sessions. Must be called with the lock held.
+    fileprivate func enqueue(_ messages: [(String, Audience)]) {
+        guard messages.isNotEmpty else { return }
+        let now = self.now()
+        for outbound in outbounds {
+            // Wedged, the Sub reconnects and reloads
+            if let since = outbound.writingSince, now.timeIntervalSince(since) > EventBroadcaster.maxLag {
+                w("[Events] Dropping \(outbound.name), not written for \(Int(now.timeIntervalSince(since)))s")
+                outbound.messages = []
+                outbound.session.close()
+                continue
+            }
+            outbound.messages.append(contentsOf: messages.filter { $0.1.includes(outbound) }.map { ($0.0, now) })
+            // Behind, replace what is queued by a resync
+            if outbound.messages.count > EventBroadcaster.maxQueued,
+                let resync = EventBroadcaster.message(.resync, content: NSNull()) {
+                w("[Events] Resyncing \(outbound.name), \(outbound.messages.count) events queued")
+                outbound.messages = [(resync, outbound.messages.first?.1 ?? now)]
+                outbound.resyncs += 1
+            }
+            write(outbound)
+        }
+    }
+
+    /// Write the queued messages of a session in background. Must be called with the lock held.
+    fileprivate func write(_ outbound: Outbound) {
+        guard !outbound.writing, outbound.messages.isNotEmpty else { return }
+        outbound.writing = true
+        outbound.queue.async {
+            while true {
+                self.lock.lock()
+                guard outbound.messages.isNotEmpty else {
+                    outbound.writing = false
+                    outbound.writingSince = nil
+                    outbound.writingRaisedAt = nil
+                    self.lock.unlock()
+                    return
+                }
+                let (message, raisedAt) = outbound.messages.removeFirst()
+                // Stuck is about this write, not how long the message waited in queue
+                outbound.writingSince = self.now()
+                outbound.writingRaisedAt = raisedAt
+                self.lock.unlock()
+
+                outbound.session.writeText(message)
+
+                self.lock.lock()
+                outbound.sent += 1
+                outbound.lag = self.now().timeIntervalSince(raisedAt)
+                outbound.maxLag = max(outbound.maxLag, outbound.lag)
+                self.lock.unlock()
+            }
+        }
+    }
+
+    /// The text frame of an event.
+    fileprivate static func message(_ type: ServerEventType, content: Any?, sequence: UInt64? = nil) -> String? {
+        var event: [String: Any] = ["type": type.rawValue]
+        if let content = content {
+            event["content"] = content
+        }
+        if let sequence = sequence {
+            event["seq"] = NSNumber(value: sequence)
+        }
+        do {
+            let data = try JSONSerialization.data(withJSONObject: event)
+            return String(data: data, encoding: .utf8)
+        } catch {
+            e("[Events] Failed encoding \(type) \(error)")
+            return nil
+        }
+    }
+}
@@ -16,8 +16,8 @@ class RestServer {
     private let disposeBag = DisposeBag()
     /// The internal web server
     private var httpServer: HttpServer? = nil
-    /// Hold the list of websocket session (Sub's connections)
-    private var sessions: [WebSocketSession] = []
+    /// Send events to the websocket sessions (Sub's connections)
+    private let events = EventBroadcaster { SP.dataService.orderLocks.lockedOrders }
     
     /// Start the RestServer on given port.
     ///
@@ -63,13 +63,48 @@ class RestServer {
                 default:
                     d("[RestServer] \(request.method) \(request.path) ERROR \(response)")
                 }
-                return response
+                return self.encoded(response, for: request)
             } catch {
                 return .internalServerError
             }
         }
     }
     
+    /// Middleware to answer from the store menu in memory right away, inside db async otherwise.
+    /// Menu requests of Subs then do not wait behind other database work.
+    ///
+    /// - Parameters:
+    ///   - cached: the handler using the menu in memory, returning `nil` if it can not answer.
+    ///   - handler: the real handler
+    /// - Returns: the wrapped handler
+    private func menuAsync(_ cached: @escaping ((HttpRequest, MenuSnapshot) -> HttpResponse?), _ handler: @escaping ((HttpRequest) -> HttpResponse)) -> ((HttpRequest) -> HttpResponse) {
+        let queued = dbAsync(handler)
+        return { request -> HttpResponse in
+            guard let storeID = request.params[":storeID"],
+                let menu = SP.database.cached(menu: storeID),
+                let response = cached(request, menu) else {
+                    return queued(request)
+            }
+            return self.encoded(response, for: request)
+        }
+    }
+    
+    /// Encode a JSON response in the most compact format the Sub accepts, as is for Subs only reading JSON.
+    /// Binary bodies are sent as plain data starting with their `WireFormat` marker byte.
+    ///
+    /// - Parameters:
+    ///   - response: the JSON response.
+    ///   - request: the request being answered.
+    /// - Returns: the encoded response.
+    private func encoded(_ response: HttpResponse, for request: HttpRequest) -> HttpResponse {
+        guard case let .ok(.json(object)) = response,
+            case let (format, data)? = WireFormat.encode(object, as: WireFormat.negotiate(request.headers["accept"])) else {
+                return response
+        }
+        v("[RestServer] \(request.method) \(request.path) as \(format) \(data.count) bytes")
+        return .ok(.data(data))
+    }
+    
     /// Generic method without bounding to Store.
     ///
     /// - Parameter httpServer: the http server to register with.
@@ -82,7 +117,7 @@ class RestServer {
             guard let properties = try? await(db.async { db.load(properties: docID) }) else {
                 return .notFound
             }
-            return .ok(.json(properties as AnyObject))
+            return self.encoded(.ok(.json(properties as AnyObject)), for: request)
         }
         
         httpServer.GET["/docs"] = { request -> HttpResponse in
@@ -91,7 +126,7 @@ class RestServer {
             }
             let ids = idsValue.split(separator: ",")
                 .map { id in id.trimmingCharacters(in: .whitespaces)}
-            return .ok(.json(db.loadProperties(multi: ids) as AnyObject))
+            return self.encoded(.ok(.json(db.loadProperties(multi: ids) as AnyObject)), for: request)
         }
         
         httpServer.POST["/docs"] = { request -> HttpResponse in
@@ -208,6 +243,17 @@ class RestServer {
             }
         }
         
+        httpServer.GET["/store/:storeID/transaction/unsettled"] = dbAsync { request -> HttpResponse in
+            guard let storeID = request.params[":storeID"], storeID.isNotEmpty,
+                let shiftID = request.query(for: "shiftid"), shiftID.isNotEmpty,
+                let page = UInt(request.query(for: "page") ?? "1"),
+                let pageCount = UInt(request.query(for: "pageCount") ?? "10") else {
+                    return .badRequest(nil)
+            }
+            let paymentType = request.query(for: "paymenttype") ?? ""
+            return .ok(.json(db.load(unsettledTransactions: storeID, shift: shiftID, for: paymentType, page: page, pageSize: pageCount, after: request.query(for: "next")).toJSON() as AnyObject))
+        }
+        
         httpServer.GET["/store/:storeID/all/:type"] = dbAsync { request -> HttpResponse in
             guard let storeID = request.params[":storeID"], storeID.isNotEmpty,
                 let type = request.params[":type"],
@@ -230,8 +276,19 @@ class RestServer {
             return .ok(.json(db.loadProperties(openingOrders: storeID, forShift: shiftID, inArea: area, withFilter: filter) as AnyObject))
         }
         
+        httpServer.POST["/store/:storeID/order/changes"] = dbAsync { request -> HttpResponse in
+            guard let storeID = request.params[":storeID"], storeID.isNotEmpty,
+                let content = request.json(),
+                let shiftID = content["shiftid"] as? String else {
+                    return .badRequest(nil)
+            }
+            let since = (content["since"] as? NSNumber)?.uint64Value ?? 0
+            let revisions = (content["revs"] as? [String: String]) ?? [:]
+            return .ok(.json(db.loadProperties(orderChanges: storeID, forShift: shiftID, since: since, revisions: revisions) as AnyObject))
+        }
+        
         httpServer.GET["/store/:storeID/order/locked"] = dbAsync { request -> HttpResponse in
-            return .ok(.json(ds.lockedOrders.value as AnyObject))
+            return .ok(.json(ds.orderLocks.lockedOrders as AnyObject))
         }
         
         httpServer.POST["/store/:storeID/order/lock"] = dbAsync { request -> HttpResponse in
@@ -256,6 +313,34 @@ class RestServer {
             return .ok(.json(true as AnyObject))
         }
         
+        httpServer.POST["/store/:storeID/order/transaction"] = dbAsync { request -> HttpResponse in
+            guard let storeID = request.params[":storeID"], storeID.isNotEmpty,
+                let content = request.json(),
+                let stationID = content["station_id"] as? String, stationID.isNotEmpty else {
+                    return .badRequest(nil)
+            }
+            let lock = (content["lock"] as? [String]) ?? []
+            let save = (content["save"] as? [[String: Any]]) ?? []
+            let unlock = (content["unlock"] as? Bool) ?? false
+            var tokens: [String: UInt64] = [:]
+            for (orderID, token) in (content["tokens"] as? [String: NSNumber]) ?? [:] {
+                tokens[orderID] = token.uint64Value
+            }
+            do {
+                guard let result = try ds.commit(orderTransaction: lock, save: save, tokens: tokens, unlock: unlock, forStation: stationID) else {
+                    return .ok(.json(["locked": false] as AnyObject))
+                }
+                return .ok(.json([
+                    "locked": true,
+                    "orders": result.orders,
+                    "tokens": result.tokens.mapValues { token in NSNumber(value: token) },
+                    "revs": result.revisions
+                    ] as AnyObject))
+            } catch {
+                return .internalServerError
+            }
+        }
+        
         httpServer.DELETE["/store/:storeID/order/:orderID"] = dbAsync { request -> HttpResponse in
             guard let storeID = request.params[":storeID"], storeID.isNotEmpty,
                 let orderID = request.params[":orderID"] else {
@@ -276,6 +361,14 @@ class RestServer {
                 let orderID = properties["id"] as? String, orderID.isNotEmpty else {
                     return .badRequest(nil)
             }
+            // Subs name themselves for their lease to be checked and renewed, older Subs do not
+            if let stationID = request.query(for: "station_id"), stationID.isNotEmpty {
+                let tokens = request.query(for: "token").flatMap { UInt64($0) }.map { [orderID: $0] } ?? [:]
+                guard ds.orderLocks.renew([orderID], tokens: tokens, for: stationID) else {
+                    w("[RestServer] Refused saving order \(orderID) of \(stationID), its lease was lost")
+                    return .ok(.json(["result": "", "locked": false] as AnyObject))
+                }
+            }
             do {
                 let rev = try db.save(properties: properties)
                 ds.remoteOrderChanged.on(.next([orderID]))
@@ -293,7 +386,7 @@ class RestServer {
                     return .badRequest(nil)
             }
             let status = OrderStatus(rawValue: request.query(for: "status") ?? "") ?? .new
-            let queryResult = db.loadProperties(orders: storeID, forShift: shiftID, matchingStatuses: [status], page: page, pageSize: pageCount)
+            let queryResult = db.loadProperties(orders: storeID, forShift: shiftID, matchingStatuses: [status], page: page, pageSize: pageCount, after: request.query(for: "next"))
             return .ok(.json(queryResult as AnyObject))
         }
         
@@ -312,19 +405,21 @@ class RestServer {
             let fromOrders = Array(orders[1..<orders.count])
             _ = mergedOrder.merge(orders: fromOrders)
             do {
-                var rev: String!
-                try db.runBatch {
-                    rev = try db.save(properties: mergedOrder.toJSON())
-                    try db.delete(multi: fromOrders)
-                }
+                let batch = WriteBatch()
+                batch.save(properties: mergedOrder.toJSON())
+                batch.delete(multi: fromOrders)
+                let results = try db.commit(batch)
                 ds.remoteOrderChanged.on(.next(content.orders))
-                return .ok(.json(["result": rev] as AnyObject))
+                return .ok(.json(["result": results.first?.revision ?? ""] as AnyObject))
             } catch {
                 return .internalServerError
             }
         }
         
-        httpServer.GET["/store/:storeID/category/:categoryID/items"] = dbAsync { request -> HttpResponse in
+        httpServer.GET["/store/:storeID/category/:categoryID/items"] = menuAsync({ request, menu -> HttpResponse? in
+            guard let categoryID = request.params[":categoryID"] else { return nil }
+            return .ok(.json(menu.properties(items: categoryID) as AnyObject))
+        }) { request -> HttpResponse in
             guard let storeID = request.params[":storeID"], storeID.isNotEmpty,
                 let categoryID = request.params[":categoryID"] else {
                     return .badRequest(nil)
@@ -336,7 +431,10 @@ class RestServer {
             return .notFound
         }
         
-        httpServer.GET["/store/:storeID/item/:itemID/modifiers"] = dbAsync { request -> HttpResponse in
+        httpServer.GET["/store/:storeID/item/:itemID/modifiers"] = menuAsync({ request, menu -> HttpResponse? in
+            guard let itemID = request.params[":itemID"], let modifiers = menu.load(modifiers: itemID) else { return nil }
+            return .ok(.json(modifiers.map { modifier in modifier.toJSON() } as AnyObject))
+        }) { request -> HttpResponse in
             guard let storeID = request.params[":storeID"], storeID.isNotEmpty,
                 let itemID = request.params[":itemID"] else {
                     return .badRequest(nil)
@@ -344,7 +442,9 @@ class RestServer {
             return .ok(.json(db.loadProperties(modifiers: itemID) as AnyObject))
         }
         
-        httpServer.GET["/store/:storeID/modifier/global"] = dbAsync { request -> HttpResponse in
+        httpServer.GET["/store/:storeID/modifier/global"] = menuAsync({ _, menu -> HttpResponse? in
+            return .ok(.json(menu.globalModifiers as AnyObject))
+        }) { request -> HttpResponse in
             guard let storeID = request.params[":storeID"], storeID.isNotEmpty else {
                 return .badRequest(nil)
             }
@@ -357,7 +457,7 @@ class RestServer {
                 let pageCount = UInt(request.query(for: "pageCount") ?? "10") else {
                     return .badRequest(nil)
             }
-            return .ok(.json(db.load(customers: storeID, page: page, pageSize: pageCount).toJSON() as AnyObject))
+            return .ok(.json(db.load(customers: storeID, page: page, pageSize: pageCount, after: request.query(for: "next")).toJSON() as AnyObject))
         }
         
         httpServer.GET["/store/:storeID/customer/find"] = dbAsync { request -> HttpResponse in
@@ -392,29 +492,21 @@ class RestServer {
     /// - Parameters:
     ///   - type: the message type.
     ///   - content: the message content.
-    func send(message type: ServerEventType, content: Any?) {
-        do
-        {
-            var message = ""
-            if let content = content {
-                let data = try JSONSerialization.data(withJSONObject:[
-                    "type": type.rawValue,
-                    "content": content])
-                message = String(data: data, encoding: .utf8) ?? ""
-            }
-            for client in sessions {
-                client.writeText(message)
-            }
-        } catch {
-            e("[RestServer] Failed sending message \(error)")
-        }
+    ///   - sequence: the database sequence of the change, for Subs to tell whether they are behind.
+    func send(message type: ServerEventType, content: Any?, sequence: UInt64? = nil) {
+        events.send(type, content: content, sequence: sequence)
     }
     
     /// Event specific endpoints.
     ///
     /// - Parameter httpServer: the http server to register with.
     private func register(eventApi httpServer: HttpServer) {
-        SP.dataService.lockedOrders
+        SP.dataService.orderLocks.changed
+            .subscribe(onNext: { delta in
+                self.events.send(lockDelta: delta)
+            })
+            .disposed(by: disposeBag)
+        SP.dataService.orderLocks.snapshot
             .subscribe(onNext: { lockedOrders in
                 self.send(message: .lockedOrdersChanged, content: lockedOrders)
             })
@@ -427,10 +519,22 @@ class RestServer {
         SP.dataService.localOrderChanged
             .subscribe(onNext: { orderIDs in
                 guard orderIDs.isNotEmpty else { return }
-                self.send(message: .orderChanged, content: orderIDs.joined(separator: ","))
+                let db = SP.database
+                db.async {
+                    self.events.send(orderChanged: orderIDs, sequence: db.lastSequence)
+                }
+            })
+            .disposed(by: disposeBag)
+        SP.database.menuChanged
+            .subscribe(onNext: { checkpoint in
+                self.send(message: .menuChanged, content: checkpoint)
             })
             .disposed(by: disposeBag)
         
+        httpServer.GET["/event/metrics"] = { _ -> HttpResponse in
+            return .ok(.json(self.events.metrics.map { $0.properties } as AnyObject))
+        }
+        
         httpServer.GET["/event"] = { r -> HttpResponse in
             guard r.hasTokenForHeader("upgrade", token: "websocket") else {
                 return .badRequest(.text("Invalid value of 'Upgrade' header: \(r.headers["upgrade"] ?? "unknown")"))
@@ -442,6 +546,9 @@ class RestServer {
                 return .badRequest(.text("Invalid value of 'Sec-Websocket-Key' header: \(r.headers["sec-websocket-key"] ?? "unknown")"))
             }
             
+            // Subs applying the lock changes delta say so, the others get all the locked orders
+            let acceptsDelta = r.query(for: "delta") == "1" || r.headers["x-kiolyn-lock-delta"] == "1"
+            
             let protocolSessionClosure: ((Socket) -> Void) = { socket in
                 let session = WebSocketSession(socket)
                 var fragmentedOpCode = WebSocketSession.OpCode.close
@@ -476,13 +583,11 @@ class RestServer {
                     }
                 }
                 
-                // Append the session to the list of session
-                self.sessions.append(session)
+                // Start sending events to the session, from the current locks
+                self.events.add(session, acceptsDelta: acceptsDelta)
                 defer {
-                    // When ever come to an end, remove the session from the list of sessions
-                    if let index = self.sessions.index(of: session) {
-                        self.sessions.remove(at: index)
-                    }
+                    // When ever come to an end, stop sending events to the session
+                    self.events.remove(session)
                 }
                 
                 do {
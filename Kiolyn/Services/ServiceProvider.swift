@@ -31,6 +31,7 @@ class ServiceProvider {
         container.register(.singleton) { OrderManager() as OrderManager }
         container.register(.singleton) { StationManager() as StationManager }
         container.register(.singleton) { DatabaseTimeCardService() as TimeCardService }
+        container.register(.singleton) { DeviceAddressResolver() as DeviceAddressResolver }
         container.register(.singleton) { StarIOPrintingService() as PrintingService }
         container.register(.singleton) { BrotherLabelPrintingService() as LabelPrintingService }
         container.register(.singleton) { PaxCCService() as CCService }
@@ -49,6 +50,8 @@ class ServiceProvider {
     static var dataService: DataService { return try! container.resolve() as DataService }
     /// The rest client to fetch data from Main.
     static var restClient: RestClient { return try! container.resolve() as RestClient }
+    /// The MAC to IP address resolver of LAN devices.
+    static var addressResolver: DeviceAddressResolver { return try! container.resolve() as DeviceAddressResolver }
     ///  The printing service instance.
     static var printingService: PrintingService { return try! container.resolve() as PrintingService }
     ///  The label printing service instance.
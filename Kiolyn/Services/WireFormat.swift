@@ -0,0 +1,95 @@
+//
+//  WireFormat.swift
+//  Kiolyn
+//
+//  Created by Chinh Nguyen on 9/7/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+/// The encodings of Main responses to Subs. Subs list the ones they read in `Accept`, Main picks
+/// the most compact one. The response does not tell its format in `Content-Type`: binary bodies
+/// start with a marker byte JSON text never starts with, 0x01 for MessagePack and 0x02 for
+/// deflated MessagePack. They are sent as plain data with a length for the connection to be kept
+/// alive (Swifter does not keep it for `raw` responses having headers). Main and Subs not knowing
+/// about it keep talking JSON.
+enum WireFormat: String {
+    /// Plain JSON.
+    case json = "application/json"
+    /// MessagePack.
+    case msgpack = "application/x-msgpack"
+    /// Deflated MessagePack, the inflated size (4 bytes, big endian) following the format byte.
+    case deflatedMsgpack = "application/x-msgpack+deflate"
+    
+    /// The marker byte starting bodies in this format, `nil` for JSON.
+    var marker: UInt8? {
+        switch self {
+        case .json: return nil
+        case .msgpack: return 0x01
+        case .deflatedMsgpack: return 0x02
+        }
+    }
+    
+    /// Smaller bodies are not worth deflating.
+    static let deflateThreshold = 1024
+    
+    /// The `Accept` header of Subs requests.
+    static let accept = [WireFormat.deflatedMsgpack, .msgpack, .json].map { $0.rawValue }.joined(separator: ", ")
+    
+    /// The most compact format accepted.
+    ///
+    /// - Parameter accept: The `Accept` header, `nil` for JSON.
+    /// - Returns: The format.
+    static func negotiate(_ accept: String?) -> WireFormat {
+        let accepted = (accept ?? "").split(separator: ",").map { type in
+            type.split(separator: ";").first.map { $0.trimmingCharacters(in: .whitespaces) } ?? ""
+        }
+        return [.deflatedMsgpack, .msgpack].first { accepted.contains($0.rawValue) } ?? .json
+    }
+    
+    /// Encode a JSON object in a binary format.
+    ///
+    /// - Parameters:
+    ///   - object: The object.
+    ///   - format: The negotiated format, deflated MessagePack falls back to MessagePack for small bodies.
+    /// - Returns: The format and encoded data, `nil` for JSON or if the object can not be encoded.
+    static func encode(_ object: Any, as format: WireFormat) -> (WireFormat, Data)? {
+        guard format != .json, let packed = try? MessagePack.encode(object) else {
+            return nil
+        }
+        guard format == .deflatedMsgpack, packed.count > deflateThreshold, let deflated = packed.deflated() else {
+            var data = Data(capacity: packed.count + 1)
+            data.append(0x01)
+            data.append(packed)
+            return (.msgpack, data)
+        }
+        var data = Data(capacity: deflated.count + 5)
+        data.append(0x02)
+        var count = UInt32(packed.count).bigEndian
+        withUnsafeBytes(of: &count) { bytes in data.append(contentsOf: bytes) }
+        data.append(deflated)
+        return (.deflatedMsgpack, data)
+    }
+    
+    /// Decode a response body by its marker byte, JSON without.
+    ///
+    /// - Parameter data: The body.
+    /// - Returns: The JSON object.
+    /// - Throws: decoding errors.
+    static func decode(_ data: Data) throws -> Any {
+        switch data.first {
+        case WireFormat.msgpack.marker?:
+            return try MessagePack.decode(Data(data.dropFirst()))
+        case WireFormat.deflatedMsgpack.marker?:
+            guard data.count > 5 else { throw MessagePackError.invalidData }
+            let count = data.dropFirst().prefix(4).reduce(0) { $0 << 8 | Int($1) }
+            guard let inflated = Data(data.dropFirst(5)).inflated(count: count) else {
+                throw MessagePackError.invalidData
+            }
+            return try MessagePack.decode(inflated)
+        default:
+            return try JSONSerialization.jsonObject(with: data, options: .allowFragments)
+        }
+    }
+}
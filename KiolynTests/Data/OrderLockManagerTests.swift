@@ -0,0 +1,108 @@
+//
+//  OrderLockManagerTests.swift
+//  KiolynTests
+//
+//  Created by Chinh Nguyen on 9/9/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+import Quick
+import Nimble
+import RxSwift
+import SwiftyUserDefaults
+@testable import Kiolyn
+
+class OrderLockManagerTests: BaseTests {
+    override func spec() {
+        describe("order leases") {
+            beforeEach {
+                // Not from the checkpoint of another manager
+                Defaults[.orderLocks] = nil
+            }
+
+            it("should lease orders to one station at a time") {
+                let locks = OrderLockManager()
+                let tokens = locks.acquire(["a", "b"], for: "station-1")
+                expect(tokens?.count) == 2
+                expect(locks.acquire(["b", "c"], for: "station-2")).to(beNil())
+                expect(locks.lockedOrders) == ["a": "station-1", "b": "station-1"]
+                // Renewing keeps the tokens
+                expect(locks.acquire(["a"], for: "station-1")?["a"]) == tokens?["a"]
+                locks.release(allOf: "station-1")
+                expect(locks.lockedOrders).to(beEmpty())
+                expect(locks.acquire(["b", "c"], for: "station-2")).toNot(beNil())
+            }
+
+            it("should fence saves of lost leases") {
+                let locks = OrderLockManager()
+                guard let lost = locks.acquire(["a"], for: "station-1", ttl: 0)?["a"] else {
+                    fail("Order not leased")
+                    return
+                }
+                guard let taken = locks.acquire(["a"], for: "station-2")?["a"] else {
+                    fail("Expired lease not given again")
+                    return
+                }
+                expect(taken) > lost
+                expect(locks.renew(["a"], tokens: ["a": lost], for: "station-1")) == false
+                expect(locks.renew(["a"], tokens: ["a": taken], for: "station-2")) == true
+                locks.release(allOf: "station-2")
+                expect(locks.renew(["a"], tokens: ["a": taken], for: "station-2")) == false
+                // Not without token either
+                expect(locks.renew(["a"], tokens: [:], for: "station-1")) == false
+                expect(locks.renew(["a"], tokens: [:], for: "station-2")) == false
+                // Only the orders never leased
+                expect(locks.renew(["b"], tokens: [:], for: "station-1")) == true
+                _ = locks.acquire(["b"], for: "station-2")
+                expect(locks.renew(["b"], tokens: [:], for: "station-2")) == false
+            }
+
+            it("should renew the leases of a station saving its orders") {
+                let locks = OrderLockManager()
+                _ = locks.acquire(["a"], for: "station-1", ttl: 0.2)
+                expect(locks.extend(["a"], for: "station-2")) == false
+                expect(locks.extend(["a", "b"], for: "station-1")) == true
+                Thread.sleep(forTimeInterval: 0.3)
+                expect(locks.lockedOrders) == ["a": "station-1"]
+                expect(locks.acquire(["a"], for: "station-2")).to(beNil())
+            }
+
+            it("should publish lock changes") {
+                let locks = OrderLockManager()
+                var delta = OrderLockDelta()
+                var published = 0
+                let subscription = locks.changed.subscribe(onNext: {
+                    delta.merge($0)
+                    published += 1
+                })
+                _ = locks.acquire(["a", "b"], for: "station-1")
+                locks.release(allOf: "station-1")
+                _ = locks.acquire(["b"], for: "station-2")
+                expect(published).toEventually(equal(3))
+                subscription.dispose()
+                expect(delta.locked) == ["b": "station-2"]
+                expect(delta.unlocked) == ["a"]
+                expect(delta.apply(to: ["a": "station-1", "c": "station-3"])) == ["b": "station-2", "c": "station-3"]
+            }
+
+            it("should publish lock changes in order from many threads") {
+                let locks = OrderLockManager()
+                var lockedOrders: LockedOrders = [:]
+                let subscription = locks.changed.subscribe(onNext: { delta in
+                    lockedOrders = delta.apply(to: lockedOrders)
+                })
+                DispatchQueue.concurrentPerform(iterations: 100) { i in
+                    let stationID = "station-\(i)"
+                    _ = locks.acquire(["order-\(i % 5)"], for: stationID)
+                    locks.release(allOf: stationID)
+                }
+                _ = locks.acquire(["a"], for: "station-1")
+                expect(lockedOrders).toEventually(equal(locks.lockedOrders))
+                subscription.dispose()
+                expect(lockedOrders) == ["a": "station-1"]
+            }
+        }
+    }
+}
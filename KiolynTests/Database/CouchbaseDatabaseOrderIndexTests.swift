@@ -0,0 +1,154 @@
+//
+//  CouchbaseDatabaseOrderIndexTests.swift
+//  KiolynTests
+//
+//  Created by Chinh Nguyen on 8/27/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+import Quick
+import Nimble
+@testable import Kiolyn
+
+class CouchbaseDatabaseOrderIndexTests: BaseTests {
+    override func spec() {
+        let db = newCouchbaseTestDatabase()
+        let shiftID = "benchmark-shift"
+        let areaIDs = ["area-1", "area-2", "area-3", "delivery"]
+        let statuses: [OrderStatus] = [.new, .submitted, .printed, .checked, .voided]
+
+        // 2,000 orders spread over the areas and statuses
+        beforeSuite {
+            let orders = (0..<2000).map { i -> [String: Any] in
+                [
+                    "id": "180827\(String(format: "%08d", i))",
+                    "type": Order.documentType,
+                    "merchantid": testStoreID,
+                    "storeid": testStoreID,
+                    "channels": [testStoreID],
+                    "shift_id": shiftID,
+                    "order_no": i + 1,
+                    "area": areaIDs[i % areaIDs.count],
+                    "status": statuses[(i / areaIDs.count) % statuses.count].rawValue,
+                    "delivered": i % 3 == 0
+                ]
+            }
+            _ = try? db.save(properties: orders)
+        }
+
+        /// The previous way: scan the whole shift and filter documents in memory.
+        let scan = { (area: Area, filter: String) -> [[String: Any]] in
+            let query = db.orderByOrderStatusView.createQuery()
+            query.mapOnly = true
+            query.prefetch = true
+            query.startKey = [testStoreID, shiftID]
+            query.endKey = [testStoreID, shiftID, [:]]
+            query.postFilter = NSPredicate { (row, _) -> Bool in
+                guard let row = row as? CBLQueryRow,
+                    let status = row.key2 as? String,
+                    status != OrderStatus.voided.rawValue,
+                    area.isDelivery || status != OrderStatus.checked.rawValue,
+                    let properties = row.documentProperties,
+                    properties["area"] as? String == area.id
+                    else { return false }
+                guard area.isDelivery, filter != "ALL" else { return true }
+                let delivered = properties["delivered"] as? Bool ?? false
+                return filter == "DELIVERED" ? delivered : !delivered
+            }
+            return query.loadPropertiesList()
+        }
+
+        let ids = { (list: [[String: Any]]) -> Set<String> in
+            Set(list.compactMap { $0["id"] as? String })
+        }
+
+        describe("opening orders by area") {
+            let area = Area()
+            area.id = "area-1"
+            let delivery = Area()
+            delivery.id = "delivery"
+            delivery.isDelivery = true
+
+            it("should return the same orders as scanning the shift") {
+                expect(ids(db.loadProperties(openingOrders: testStoreID, forShift: shiftID, inArea: area, withFilter: "PENDING"))) == ids(scan(area, "PENDING"))
+                for filter in ["ALL", "DELIVERED", "PENDING"] {
+                    expect(ids(db.loadProperties(openingOrders: testStoreID, forShift: shiftID, inArea: delivery, withFilter: filter))) == ids(scan(delivery, filter))
+                }
+                expect(db.loadProperties(openingOrders: testStoreID, forShift: shiftID, inArea: nil, withFilter: "PENDING").count) == 1200
+            }
+
+            it("should follow order changes without reloading the shift") {
+                let opening = { db.loadProperties(openingOrders: testStoreID, forShift: shiftID, inArea: area, withFilter: "PENDING").count }
+                let count = opening()
+                var order: [String: Any] = [
+                    "id": "18082899999999",
+                    "type": Order.documentType,
+                    "merchantid": testStoreID,
+                    "storeid": testStoreID,
+                    "channels": [testStoreID],
+                    "shift_id": shiftID,
+                    "area": "area-1",
+                    "status": OrderStatus.new.rawValue
+                ]
+                _ = try? db.save(properties: order)
+                expect(opening()).toEventually(equal(count + 1))
+                expect(ids(db.queryProperties(openingOrders: testStoreID, forShift: shiftID, inArea: area, withFilter: "PENDING"))) == ids(db.loadProperties(openingOrders: testStoreID, forShift: shiftID, inArea: area, withFilter: "PENDING"))
+                order["status"] = OrderStatus.voided.rawValue
+                _ = try? db.save(properties: order)
+                expect(opening()).toEventually(equal(count))
+            }
+
+            it("should read the rows of the area only") {
+                // The scan goes through every order of the shift ...
+                var scanned = 0
+                let query = db.orderByOrderStatusView.createQuery()
+                query.mapOnly = true
+                query.startKey = [testStoreID, shiftID]
+                query.endKey = [testStoreID, shiftID, [:]]
+                query.postFilter = NSPredicate { _, _ in
+                    scanned += 1
+                    return false
+                }
+                _ = try? query.run()
+                expect(scanned) >= 2000
+                // ... the area index holds the orders of the area under their own keys
+                let areaRows = db.orderByAreaStatusView.createQuery()
+                areaRows.mapOnly = true
+                areaRows.startKey = [testStoreID, shiftID, area.id]
+                areaRows.endKey = [testStoreID, shiftID, area.id, [:]]
+                let rows = (try? areaRows.run())?.allObjects.count ?? 0
+                expect(rows) >= 2000 / areaIDs.count
+                expect(rows) < scanned
+                let opening = db.queryProperties(openingOrders: testStoreID, forShift: shiftID, inArea: area, withFilter: "PENDING")
+                expect(opening.count) <= rows
+                expect(opening.filter { $0["area"] as? String != area.id }).to(beEmpty())
+            }
+        }
+
+        describe("benchmark") {
+            it("should measure a 2,000 orders shift against scanning") {
+                let area = Area()
+                area.id = "area-1"
+                // Build both indexes first
+                let scanned = scan(area, "PENDING")
+                let indexed = db.loadProperties(openingOrders: testStoreID, forShift: shiftID, inArea: area, withFilter: "PENDING")
+                let runs = 10
+                var start = Date()
+                for _ in 0..<runs {
+                    _ = scan(area, "PENDING")
+                }
+                let scanning = Date().timeIntervalSince(start) / Double(runs)
+                start = Date()
+                for _ in 0..<runs {
+                    _ = db.loadProperties(openingOrders: testStoreID, forShift: shiftID, inArea: area, withFilter: "PENDING")
+                }
+                let indexing = Date().timeIntervalSince(start) / Double(runs)
+                // Reported only, the times depend on the machine
+                print("[OrderIndex] shift scan \(Int(scanning * 1000))ms, area index \(Int(indexing * 1000))ms for \(indexed.count) orders")
+                expect(ids(indexed)) == ids(scanned)
+            }
+        }
+    }
+}
@@ -0,0 +1,88 @@
+//
+//  CustomerSearchIndexTests.swift
+//  KiolynTests
+//
+//  Created by Chinh Nguyen on 8/29/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+import Quick
+import Nimble
+@testable import Kiolyn
+
+class CustomerSearchIndexTests: BaseTests {
+    override func spec() {
+        let db = newCouchbaseTestDatabase()
+        let streets = ["Main St", "Bolsa Ave", "Brookhurst St", "Magnolia Ave"]
+        let customer = { (i: Int) -> [String: Any] in
+            [
+                "id": "cus\(String(format: "%08d", i))",
+                "type": Customer.documentType,
+                "merchantid": testStoreID,
+                "storeid": testStoreID,
+                "channels": [testStoreID],
+                "name": "Customer\(i) Nguyen",
+                "mobilephone": String(format: "(714) %03d-%04d", i / 10000, i % 10000),
+                "email": "customer\(i)@kiolyn.com",
+                "address": "\(i) \(streets[i % streets.count]), Westminster"
+            ]
+        }
+
+        // 40,000 customers
+        beforeSuite {
+            _ = try? db.save(properties: (0..<40000).map(customer))
+        }
+
+        let names = { (list: [[String: Any]]) -> [String] in
+            list.compactMap { $0["name"] as? String }
+        }
+
+        describe("customers search") {
+            it("should find by phone digits") {
+                let found = db.loadProperties(customers: testStoreID, query: ("", "714-001-2345", "", ""), limit: 10)
+                expect(names(found)) == ["Customer12345 Nguyen"]
+                expect(db.loadProperties(customers: testStoreID, query: ("", "(714) 003", "", ""), limit: 100).count) == 100
+            }
+
+            it("should find by any word of the name") {
+                expect(names(db.loadProperties(customers: testStoreID, query: ("nguyen customer3999", "", "", ""), limit: 10)))
+                    == ["Customer3999 Nguyen", "Customer39990 Nguyen", "Customer39991 Nguyen", "Customer39992 Nguyen", "Customer39993 Nguyen",
+                        "Customer39994 Nguyen", "Customer39995 Nguyen", "Customer39996 Nguyen", "Customer39997 Nguyen", "Customer39998 Nguyen"]
+            }
+
+            it("should find by email and address") {
+                expect(names(db.loadProperties(customers: testStoreID, query: ("", "", "Customer777@", ""), limit: 10))) == ["Customer777 Nguyen"]
+                let found = db.loadProperties(customers: testStoreID, query: ("", "", "", "1234 brookhurst"), limit: 10)
+                expect(names(found)) == ["Customer11234 Nguyen", "Customer1234 Nguyen", "Customer21234 Nguyen", "Customer31234 Nguyen"]
+            }
+
+            it("should follow customer changes") {
+                var changed = customer(99999)
+                changed["mobilephone"] = "657-555-0000"
+                _ = try? db.save(properties: changed)
+                expect(names(db.loadProperties(customers: testStoreID, query: ("", "6575550", "", ""), limit: 10))).toEventually(equal(["Customer99999 Nguyen"]))
+                changed["deleted"] = true
+                _ = try? db.save(properties: changed)
+                expect(db.loadProperties(customers: testStoreID, query: ("", "6575550", "", ""), limit: 10)).toEventually(beEmpty())
+            }
+
+            it("should measure typeahead") {
+                // Build the index first
+                _ = db.loadProperties(customers: testStoreID, query: ("", "7", "", ""), limit: 10)
+                let runs = 100
+                var counts: [Int] = []
+                let start = Date()
+                for i in 0..<runs {
+                    counts.append(db.loadProperties(customers: testStoreID, query: ("", "71400\(i % 4)", "", ""), limit: 10).count)
+                }
+                let elapsed = Date().timeIntervalSince(start) / Double(runs)
+                // Reported only, the time depends on the machine
+                print("[CustomerSearch] phone typeahead \(String(format: "%.2f", elapsed * 1000))ms")
+                // 10,000 customers for each prefix, one page of them
+                expect(counts) == [Int](repeating: 10, count: runs)
+            }
+        }
+    }
+}
@@ -0,0 +1,93 @@
+//
+//  MenuCacheTests.swift
+//  KiolynTests
+//
+//  Created by Chinh Nguyen on 9/5/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+import Quick
+import Nimble
+import RxSwift
+@testable import Kiolyn
+
+class MenuCacheTests: BaseTests {
+    override func spec() {
+        let db = newCouchbaseTestDatabase()
+        let ids = { (list: [[String: Any]]) -> [String] in list.compactMap { $0["id"] as? String } }
+        let categories = { () -> [String] in
+            let query = db.itemByCategoryView.createQuery()
+            query.startKey = [testStoreID]
+            query.endKey = [testStoreID, [:]]
+            query.mapOnly = true
+            let keys = ((try? query.run().compactMap { ($0 as? CBLQueryRow)?.key as? [Any] }) ?? []).compactMap { $0.last as? String }
+            return Array(Set(keys))
+        }
+        let queried = { (category: String) -> [[String: Any]] in
+            let query = db.itemByCategoryView.createQuery()
+            query.keys = [[testStoreID, category]]
+            query.mapOnly = true
+            query.prefetch = true
+            return query.loadPropertiesList()
+        }
+
+        describe("menu cache") {
+            it("should load the same items as the view") {
+                db.menu.reset()
+                expect(db.cached(menu: testStoreID)).to(beNil())
+                expect(categories()).toNot(beEmpty())
+                for category in categories() {
+                    expect(ids(db.loadProperties(items: testStoreID, forCategory: category))) == ids(queried(category))
+                }
+                expect(db.cached(menu: testStoreID)?.checkpoint) == db.database.lastSequenceNumber
+            }
+
+            it("should load the same modifiers as from documents") {
+                let snapshot = db.load(menu: testStoreID)
+                guard let category = categories().first(where: { category in
+                    queried(category).contains { (($0["modifiers"] as? [Any]) ?? []).isNotEmpty }
+                }), let item = queried(category).first(where: { (($0["modifiers"] as? [Any]) ?? []).isNotEmpty }),
+                    let itemID = item["id"] as? String else {
+                    fail("No item with modifiers")
+                    return
+                }
+                let refs = Item.decoded(item).modifiers
+                let cached = snapshot.load(modifiers: itemID)
+                expect(cached?.count) == refs.count
+                for modifier in cached ?? [] {
+                    let stored: Modifier? = db.load(modifier.id)
+                    expect(modifier.name) == stored?.name
+                    expect(modifier.required) == refs.first { $0.id == modifier.id }?.required
+                }
+            }
+
+            it("should only be dropped by menu changes") {
+                _ = db.load(menu: testStoreID)
+                var changes: [UInt64] = []
+                let subscription = db.menuChanged.subscribe(onNext: { changes.append($0) })
+                let order = Order(id: "menu-cache-order")
+                order.type = Order.documentType
+                order.storeID = testStoreID
+                order.merchantID = testStoreID
+                try? db.save(order)
+                expect(db.cached(menu: testStoreID)).toEventuallyNot(beNil())
+                expect(changes).to(beEmpty())
+
+                guard let category = categories().first, let properties = queried(category).first,
+                    let itemID = properties["id"] as? String, let item: Item = db.load(itemID) else {
+                    fail("No item")
+                    return
+                }
+                item.name = "\(item.name) (renamed)"
+                try? db.save(item)
+                expect(db.cached(menu: testStoreID)).toEventually(beNil())
+                expect(changes.count).toEventually(equal(1))
+                let reloaded = db.load(menu: testStoreID).properties(items: category)
+                expect(reloaded.first { ($0["id"] as? String) == itemID }?["name"] as? String) == item.name
+                subscription.dispose()
+            }
+        }
+    }
+}
@@ -123,11 +123,11 @@ class MockDatabase: Database {
         fatalError()
     }
     
-    func load(orders storeID: String, forShift shiftID: String, matchingStatuses statuses: [OrderStatus], page: UInt, pageSize: UInt) -> QueryResult<Order> {
+    func load(orders storeID: String, forShift shiftID: String, matchingStatuses statuses: [OrderStatus], page: UInt, pageSize: UInt, after next: String?) -> QueryResult<Order> {
         fatalError()
     }
     
-    func load(customers storeID: String, page: UInt, pageSize: UInt) -> QueryResult<Customer> {
+    func load(customers storeID: String, page: UInt, pageSize: UInt, after next: String?) -> QueryResult<Customer> {
         fatalError()
     }
     
@@ -135,7 +135,7 @@ class MockDatabase: Database {
         fatalError()
     }
     
-    func load(unsettledTransactions storeID: String, shift shiftID: String, for paymentType: String, page: UInt, pageSize: UInt) -> QueryResult<Transaction> {
+    func load(unsettledTransactions storeID: String, shift shiftID: String, for paymentType: String, page: UInt, pageSize: UInt, after next: String?) -> QueryResult<Transaction> {
         fatalError()
     }
     
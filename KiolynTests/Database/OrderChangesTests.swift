@@ -0,0 +1,103 @@
+//
+//  OrderChangesTests.swift
+//  KiolynTests
+//
+//  Created by Chinh Nguyen on 9/6/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+import Quick
+import Nimble
+@testable import Kiolyn
+
+class OrderChangesTests: BaseTests {
+    override func spec() {
+        let db = newCouchbaseTestDatabase()
+        let shiftID = "changes-shift"
+        let order = { (i: Int) -> Order in
+            let order = Order(id: "180906\(String(format: "%08d", i))")
+            order.type = Order.documentType
+            order.storeID = testStoreID
+            order.merchantID = testStoreID
+            order.shiftID = shiftID
+            order.area = "changes-area"
+            order.orderStatus = .submitted
+            order.orderNo = UInt(i)
+            return order
+        }
+        let replica = OrderReplica()
+        /// Catch up the replica with the database, as a Sub does with Main.
+        let catchUp = { () -> [String]? in
+            let request = replica.request(shiftID)
+            let response = db.loadProperties(
+                orderChanges: testStoreID,
+                forShift: shiftID,
+                since: (request["since"] as? NSNumber)?.uint64Value ?? 0,
+                revisions: (request["revs"] as? [String: String]) ?? [:])
+            return replica.apply(response, for: request)
+        }
+        let opening = { () -> [String] in
+            (replica.load(openingOrders: shiftID, inArea: nil, withFilter: "ALL") ?? []).map { $0.id }.sorted()
+        }
+
+        describe("json patch") {
+            it("should turn a document into another") {
+                let from: [String: Any] = ["a": 1, "b": ["x", "y", "z"], "c": ["d": true, "e/f": "g"], "h": "i"]
+                let to: [String: Any] = ["a": 2, "b": ["x", "w"], "c": ["d": true, "e/f": "k", "l": [1, 2]], "m": NSNull()]
+                let patch = JSONPatch.diff(from, to)
+                expect(patch.count) == 7
+                expect(JSONPatch.apply(patch, to: from).map { NSDictionary(dictionary: $0).isEqual(to: to) }) == true
+                expect(JSONPatch.diff(to, to)).to(beEmpty())
+            }
+
+            it("should not apply to another document") {
+                let patch = JSONPatch.diff(["a": [1, 2, 3]], ["a": [1]])
+                expect(JSONPatch.apply(patch, to: ["a": [1]])).to(beNil())
+            }
+        }
+
+        describe("order changes") {
+            it("should start with all the orders of the shift") {
+                try? db.save(all: (0..<3).map(order))
+                expect(catchUp()?.sorted()) == (0..<3).map { order($0).id }
+                expect(opening()) == (0..<3).map { order($0).id }
+            }
+
+            it("should patch the changed orders") {
+                guard let changed: Order = db.load(order(1).id) else {
+                    fail("Order not saved")
+                    return
+                }
+                changed.customerName = "changed"
+                try? db.save(changed)
+                let request = replica.request(shiftID)
+                let response = db.loadProperties(
+                    orderChanges: testStoreID,
+                    forShift: shiftID,
+                    since: (request["since"] as? NSNumber)?.uint64Value ?? 0,
+                    revisions: (request["revs"] as? [String: String]) ?? [:])
+                let changes = response["changes"] as? [[String: Any]]
+                expect(changes?.count) == 1
+                expect(changes?.first?["patch"]).toNot(beNil())
+                expect(replica.apply(response, for: request)) == [changed.id]
+                expect(replica.load(openingOrders: shiftID, inArea: nil, withFilter: "ALL")?.first { $0.id == changed.id }?.customerName) == "changed"
+                expect(catchUp()) == []
+            }
+
+            it("should remove the voided and deleted orders") {
+                guard let voided: Order = db.load(order(0).id), let deleted: Order = db.load(order(2).id) else {
+                    fail("Orders not saved")
+                    return
+                }
+                voided.orderStatus = .voided
+                try? db.save(voided)
+                try? db.delete(deleted)
+                var removed: [String] = []
+                expect { removed += catchUp() ?? []; return Set(removed) }.toEventually(equal(Set([voided.id, deleted.id])))
+                expect(opening()) == [order(1).id]
+            }
+        }
+    }
+}
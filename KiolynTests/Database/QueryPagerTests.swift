@@ -0,0 +1,82 @@
+//
+//  QueryPagerTests.swift
+//  KiolynTests
+//
+//  Created by Chinh Nguyen on 8/30/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+import Quick
+import Nimble
+@testable import Kiolyn
+
+class QueryPagerTests: BaseTests {
+    override func spec() {
+        let db = newCouchbaseTestDatabase()
+        let storeID = "pager-store"
+        let customer = { (i: Int) -> [String: Any] in
+            [
+                "id": "pager\(String(format: "%06d", i))",
+                "type": Customer.documentType,
+                "merchantid": storeID,
+                "storeid": storeID,
+                "channels": [storeID],
+                "name": "Customer \(i)"
+            ]
+        }
+
+        beforeSuite {
+            _ = try? db.save(properties: (0..<95).map(customer))
+        }
+
+        /// The previous way, skipping the rows of the previous pages.
+        let skipped = { (page: UInt, pageSize: UInt) -> [String] in
+            let query = db.allCustomersView.createQuery()
+            query.keys = [storeID]
+            query.mapOnly = true
+            query.prefetch = true
+            query.limit = pageSize
+            query.skip = (page - 1) * pageSize
+            return query.loadPropertiesList().compactMap { $0["id"] as? String }
+        }
+        let ids = { (result: QueryResult<Customer>) -> [String] in result.rows.map { $0.id } }
+
+        describe("keyset pagination") {
+            it("should return the same pages as skipping") {
+                for page: UInt in [1, 2, 3, 7, 10, 5] {
+                    expect(ids(db.load(customers: storeID, page: page, pageSize: 10))) == skipped(page, 10)
+                }
+                expect(db.load(customers: storeID, page: 10, pageSize: 10).next).to(beNil())
+            }
+
+            it("should continue from the continuation key") {
+                var next: String? = nil
+                var all: [String] = []
+                for page: UInt in 1...10 {
+                    let result = db.load(customers: storeID, page: page, pageSize: 10, after: next)
+                    all += ids(result)
+                    next = result.next
+                }
+                expect(next).to(beNil())
+                expect(all) == (1...10).flatMap { skipped(UInt($0), 10) }
+            }
+
+            it("should keep the pages of each page size apart") {
+                for pageSize: UInt in [10, 20, 50, 20, 10] {
+                    for page: UInt in [1, 2, 3, 2] {
+                        expect(ids(db.load(customers: storeID, page: page, pageSize: pageSize))) == skipped(page, pageSize)
+                    }
+                }
+            }
+
+            it("should refresh the summary on changes") {
+                expect(db.load(customers: storeID, page: 1, pageSize: 10).summary.count) == 95
+                _ = try? db.save(properties: customer(95))
+                expect(db.load(customers: storeID, page: 1, pageSize: 10).summary.count).toEventually(equal(96))
+                expect(ids(db.load(customers: storeID, page: 10, pageSize: 10))).toEventually(equal(skipped(10, 10)))
+            }
+        }
+    }
+}
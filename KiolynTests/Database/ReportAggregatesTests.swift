@@ -0,0 +1,155 @@
+//
+//  ReportAggregatesTests.swift
+//  KiolynTests
+//
+//  Created by Chinh Nguyen on 8/31/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+import Quick
+import Nimble
+@testable import Kiolyn
+
+class ReportAggregatesTests: BaseTests {
+    override func spec() {
+        let db = newCouchbaseTestDatabase()
+        let storeID = "aggregates-store"
+        let days = ["180801", "180802", "180803"]
+        let date = { (day: String) -> Date in
+            let formatter = DateFormatter()
+            formatter.dateFormat = "yyMMdd"
+            return formatter.date(from: day)!
+        }
+        let fromDate = date("180801")
+        let toDate = date("180803")
+        let order = { (i: Int) -> [String: Any] in
+            [
+                "id": "\(days[i % days.count])\(String(format: "%08d", i))",
+                "type": Order.documentType,
+                "merchantid": storeID,
+                "storeid": storeID,
+                "channels": [storeID],
+                "status": OrderStatus.checked.rawValue,
+                "shift": i % 2 + 1,
+                "persons": 2,
+                "area": "area-\(i % 3)",
+                "area_name": "Area \(i % 3)",
+                "created_by": "server-\(i % 4)",
+                "closed_by": "server-\(i % 4)",
+                "bills": [
+                    ["total": 10.5, "tip": 1.0, "tax_amount": 0.5],
+                    ["total": 20.0, "tip": 2.0, "tax_amount": 1.0, "voided": i % 5 == 0]
+                ]
+            ]
+        }
+        let transaction = { (i: Int) -> [String: Any] in
+            [
+                "id": "\(days[i % days.count])\(String(format: "%08d", i))",
+                "type": Transaction.documentType,
+                "merchantid": storeID,
+                "storeid": storeID,
+                "channels": [storeID],
+                "status": TransactionStatus.new.rawValue,
+                "shift_index": i % 2 + 1,
+                "trans_type": i % 3 == 0 ? TransactionType.cash.rawValue : TransactionType.creditSale.rawValue,
+                "trans_num": i + 1,
+                "card_type": i % 3 == 0 ? "" : "visa",
+                "approved_amount": 30.5,
+                "tip_amount": 3.0
+            ]
+        }
+
+        beforeSuite {
+            _ = try? db.save(properties: (0..<600).map(order))
+            _ = try? db.save(properties: (0..<600).map(transaction))
+        }
+
+        /// Total of the not voided bills of the fixture orders of some days.
+        let ordersTotal = { (orderDays: [String]) -> Double in
+            (0..<600)
+                .filter { orderDays.contains(days[$0 % days.count]) }
+                .map { $0 % 5 == 0 ? 10.5 : 30.5 }
+                .reduce(0, +)
+        }
+        /// Revision of the local aggregates document of a day.
+        let revision = { (day: String) -> String? in
+            db.database.existingLocalDocument(withID: "report_aggregates_\(day)")?["_rev"] as? String
+        }
+
+        describe("report aggregates") {
+            it("should sum the orders and transactions") {
+                let employee = db.load(byEmployeeReport: storeID, fromDate: fromDate, toDate: fromDate, shift: 0)
+                expect(employee.summary.total).to(beCloseTo(ordersTotal(["180801"])))
+                expect(employee.rows.count) == 4
+
+                let area = db.load(byAreaReport: storeID, fromDate: fromDate, toDate: toDate, shift: 0)
+                expect(area.summary.total).to(beCloseTo(ordersTotal(days)))
+                expect(area.summary.guests) == 1200
+
+                let paymentType = db.load(byPaymentTypeReport: storeID, fromDate: fromDate, toDate: toDate, shift: 0, includeCardType: true)
+                expect(paymentType.summary.total).to(beCloseTo(600 * 30.5))
+                expect(paymentType.summary.count) == 600
+
+                let summary = db.load(shiftSummary: storeID, fromDate: fromDate, toDate: toDate, shift: 0)
+                expect(summary.total).to(beCloseTo(ordersTotal(days)))
+                expect(summary.count) == 600
+            }
+
+            it("should follow order and transaction changes") {
+                let before = db.load(shiftSummary: storeID, fromDate: fromDate, toDate: toDate, shift: 0).total
+                var changed = order(1)
+                changed["status"] = OrderStatus.voided.rawValue
+                _ = try? db.save(properties: changed)
+                expect(db.load(shiftSummary: storeID, fromDate: fromDate, toDate: toDate, shift: 0).total).toEventually(beCloseTo(before - 30.5))
+
+                var voided = transaction(1)
+                voided["status"] = TransactionStatus.voided.rawValue
+                _ = try? db.save(properties: voided)
+                expect(db.load(byPaymentTypeReport: storeID, fromDate: fromDate, toDate: toDate, shift: 0, includeCardType: false).summary.total)
+                    .toEventually(beCloseTo(600 * 30.5 - 30.5))
+            }
+
+            it("should not rewrite a day for changes not altering the reports") {
+                _ = db.load(shiftSummary: storeID, fromDate: fromDate, toDate: toDate, shift: 0)
+                let before = revision("180803")
+                expect(before).toNot(beNil())
+                var printed = order(2)
+                printed["printed"] = true
+                _ = try? db.save(properties: printed)
+                _ = db.load(shiftSummary: storeID, fromDate: fromDate, toDate: toDate, shift: 0)
+                expect(revision("180803")) == before
+
+                var tipped = order(2)
+                tipped["bills"] = [["total": 12.5, "tip": 3.0, "tax_amount": 0.5]]
+                _ = try? db.save(properties: tipped)
+                _ = db.load(shiftSummary: storeID, fromDate: fromDate, toDate: toDate, shift: 0)
+                expect(revision("180803")) != before
+            }
+
+            it("should subtract the deletions not applied before a restart") {
+                let count = { (aggregates: ReportAggregates) -> Int in
+                    let rows = aggregates.rows(.area, of: storeID, fromDate: fromDate, toDate: fromDate, shift: 0)
+                    return (ReportAggregates.reduce(rows, level: 0).first?.value["count"] as? Int) ?? 0
+                }
+                let before = count(db.reportAggregates)
+                // Aggregates as they were when the app stopped
+                let localIDs = ["report_aggregates", "report_aggregates_180801", "report_sources_180801"]
+                let stopped = localIDs.map { id in (id, db.database.existingLocalDocument(withID: id)?.filter { !$0.key.hasPrefix("_") }) }
+                // ... then the order is deleted (i.e. by sync) before the app starts again
+                let docID = "\(Order.documentIDPrefix)_\(order(3)["id"] as! String)"
+                expect { try db.database.existingDocument(withID: docID)?.delete() }.toNot(throwError())
+                _ = count(db.reportAggregates)
+                for (id, properties) in stopped {
+                    _ = try? db.database.putLocalDocument(properties, withID: id)
+                }
+                let restarted = ReportAggregates(
+                    database: db.database,
+                    maps: [.employee: db.orderShiftServerMap(), .area: db.orderShiftAreaDriverMap(), .paymentType: db.transactionTypeMap()],
+                    types: [Order.self, Transaction.self])
+                expect(count(restarted)) == before - 1
+            }
+        }
+    }
+}
@@ -0,0 +1,182 @@
+//
+//  ShiftArchiveTests.swift
+//  KiolynTests
+//
+//  Created by Chinh Nguyen on 9/1/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+import Quick
+import Nimble
+@testable import Kiolyn
+
+class ShiftArchiveTests: BaseTests {
+    override func spec() {
+        let directory = "\(NSTemporaryDirectory())archive-\(UUID().uuidString)"
+        let archive = ShiftArchive(directory: directory)
+        let storeID = "archive-store"
+        let date = { (day: String) -> Date in
+            let formatter = DateFormatter()
+            formatter.dateFormat = "yyMMdd"
+            return formatter.date(from: day)!
+        }
+        let order = { (i: Int) -> (String, [String: Any]) in
+            let id = "180801\(String(format: "%08d", i))"
+            return ("\(Order.documentIDPrefix)_\(id)", [
+                "id": id,
+                "type": Order.documentType,
+                "storeid": storeID,
+                "status": OrderStatus.checked.rawValue,
+                "shift_id": "shift-1",
+                "shift": 1,
+                "order_no": i + 1,
+                "area": "area-\(i % 3)",
+                "created_by": "server-\(i % 4)",
+                "bills": [
+                    ["total": 10.5, "tip": 1.0],
+                    ["total": 20.0, "tip": 2.0, "voided": true]
+                ]
+            ])
+        }
+
+        afterSuite {
+            try? FileManager.default.removeItem(atPath: directory)
+        }
+
+        describe("shift archive") {
+            it("should scan back what was archived") {
+                try? archive.append((0..<500).map(order), of: storeID, day: "180801")
+                var batches: [ArchiveBatch] = []
+                archive.scan(storeID, fromDate: date("180801"), toDate: date("180801"), columns: ["doc_id", "number", "total", "area", "document"]) {
+                    batches.append($0)
+                }
+                expect(batches.count) == 1
+                expect(batches.first?.count) == 500
+                expect(batches.first?.strings("doc_id").first) == order(0).0
+                expect(batches.first?.ints("number").last) == 500
+                expect(batches.first?.doubles("total").reduce(0, +)).to(beCloseTo(500 * 10.5))
+                expect(batches.first?.strings("area")[4]) == "area-1"
+                expect(batches.first?.documents[7]["created_by"] as? String) == "server-3"
+            }
+
+            it("should only read the asked columns") {
+                var batch: ArchiveBatch? = nil
+                archive.scan(storeID, fromDate: date("180801"), toDate: date("180801"), columns: ["tip"]) { batch = $0 }
+                expect(batch?.doubles("tip").count) == 500
+                expect(batch?.strings("document")).to(beEmpty())
+                expect(batch?.strings("doc_id")).to(beEmpty())
+            }
+
+            it("should replace documents archived again") {
+                let (docID, original) = order(3)
+                var properties = original
+                properties["status"] = OrderStatus.voided.rawValue
+                try? archive.append([(docID, properties)], of: storeID, day: "180801")
+                var batch: ArchiveBatch? = nil
+                archive.scan(storeID, fromDate: date("180801"), toDate: date("180801"), columns: ["doc_id", "status"]) { batch = $0 }
+                expect(batch?.count) == 500
+                expect(batch?.strings("status").filter { $0 == OrderStatus.voided.rawValue }.count) == 1
+            }
+
+            it("should skip days out of range") {
+                var count = 0
+                archive.scan(storeID, fromDate: date("180802"), toDate: date("180831"), columns: ["doc_id"]) { _ in count += 1 }
+                expect(count) == 0
+            }
+
+            it("should be smaller than the documents") {
+                let json = (0..<500).map(order).compactMap { try? JSONSerialization.data(withJSONObject: $0.1).count }.reduce(0, +)
+                let attributes = try? FileManager.default.attributesOfItem(atPath: "\(directory)/\(storeID)/180801.kseg")
+                let size = attributes?[.size] as? Int
+                expect(size).to(beLessThan(json / 2))
+            }
+        }
+
+        describe("archiving closed shifts") {
+            let db = newCouchbaseTestDatabase()
+            db.shiftArchive = ShiftArchive(directory: "\(directory)-db")
+            let closedStoreID = "closed-store"
+            let fromDate = date("180801")
+            let closed = { (i: Int) -> [String: Any] in
+                [
+                    "id": "180801\(String(format: "%08d", i))",
+                    "type": Order.documentType,
+                    "merchantid": closedStoreID,
+                    "storeid": closedStoreID,
+                    "channels": [closedStoreID],
+                    "status": i < 40 ? OrderStatus.checked.rawValue : OrderStatus.submitted.rawValue,
+                    "shift": i % 2 + 1,
+                    "persons": 2,
+                    "area": "area-1",
+                    "created_by": "server-\(i % 2)",
+                    "closed_by": "server-\(i % 2)",
+                    "bills": [["total": 10.0, "tip": 1.0]]
+                ]
+            }
+            let transaction = { (i: Int) -> [String: Any] in
+                [
+                    "id": "180801\(String(format: "%08d", 1000 + i))",
+                    "type": Transaction.documentType,
+                    "merchantid": closedStoreID,
+                    "storeid": closedStoreID,
+                    "channels": [closedStoreID],
+                    "status": TransactionStatus.settled.rawValue,
+                    "shift_index": i % 2 + 1,
+                    "trans_type": TransactionType.cash.rawValue,
+                    "trans_num": i + 1,
+                    "area": "area-1",
+                    "approved_amount": 10.0,
+                    "tip_amount": 1.0
+                ]
+            }
+
+            afterSuite {
+                try? FileManager.default.removeItem(atPath: "\(directory)-db")
+            }
+
+            it("should keep the reports of archived days") {
+                _ = try? db.save(properties: (0..<50).map(closed))
+                _ = try? db.save(properties: (0..<20).map(transaction))
+                let summary = db.load(shiftSummary: closedStoreID, fromDate: fromDate, toDate: fromDate, shift: 0)
+                let employee = db.load(orders: closedStoreID, ofEmployee: "server-0", fromDate: fromDate, toDate: fromDate, shift: 0, page: 1, pageSize: 10)
+                let grouped = db.load(orders: closedStoreID, ofEmployee: "server-0", fromDate: fromDate, toDate: fromDate, groupedBy: 0)
+                let transactions = db.load(transactions: closedStoreID, fromDate: fromDate, toDate: fromDate, shift: 0, area: "", page: 2, pageSize: 5)
+
+                db.markPushed(upTo: db.database.lastSequenceNumber)
+                expect(try? db.archive(closedShifts: closedStoreID)) == 60
+                // The open orders stay
+                expect(db.database.existingDocument(withID: "\(Order.documentIDPrefix)_\(closed(0)["id"]!)")).to(beNil())
+                expect(db.database.existingDocument(withID: "\(Order.documentIDPrefix)_\(closed(45)["id"]!)")).toNot(beNil())
+
+                let archivedSummary = db.load(shiftSummary: closedStoreID, fromDate: fromDate, toDate: fromDate, shift: 0)
+                expect(archivedSummary.count) == summary.count
+                expect(archivedSummary.total).to(beCloseTo(summary.total))
+
+                let archivedEmployee = db.load(orders: closedStoreID, ofEmployee: "server-0", fromDate: fromDate, toDate: fromDate, shift: 0, page: 1, pageSize: 10)
+                expect(archivedEmployee.rows.map { $0.id }) == employee.rows.map { $0.id }
+                expect(archivedEmployee.summary.total).to(beCloseTo(employee.summary.total))
+
+                let archivedGrouped = db.load(orders: closedStoreID, ofEmployee: "server-0", fromDate: fromDate, toDate: fromDate, groupedBy: 0)
+                expect(archivedGrouped.map { $0.shift }) == grouped.map { $0.shift }
+                expect(archivedGrouped.map { $0.rows.count }) == grouped.map { $0.rows.count }
+
+                let archivedTransactions = db.load(transactions: closedStoreID, fromDate: fromDate, toDate: fromDate, shift: 0, area: "", page: 2, pageSize: 5)
+                expect(archivedTransactions.rows.map { $0.transaction?.id ?? "" }) == transactions.rows.map { $0.transaction?.id ?? "" }
+                expect(archivedTransactions.summary.count) == 20
+            }
+
+            it("should keep following the documents not purged") {
+                let before = db.load(shiftSummary: closedStoreID, fromDate: fromDate, toDate: fromDate, shift: 0)
+                let docIDs = (40..<50).map { i in "\(Order.documentIDPrefix)_\(closed(i)["id"]!)" }
+                // Not purged after all
+                db.reportAggregates.attach(try! db.reportAggregates.detach(docIDs))
+                var checked = closed(45)
+                checked["status"] = OrderStatus.checked.rawValue
+                _ = try? db.save(properties: checked)
+                expect(db.load(shiftSummary: closedStoreID, fromDate: fromDate, toDate: fromDate, shift: 0).count).toEventually(equal(before.count + 1))
+            }
+        }
+    }
+}
@@ -0,0 +1,110 @@
+//
+//  TypedModelTests.swift
+//  KiolynTests
+//
+//  Created by Chinh Nguyen on 9/2/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+import Quick
+import Nimble
+import ObjectMapper
+@testable import Kiolyn
+
+class TypedModelTests: BaseTests {
+    override func spec() {
+        let db = newCouchbaseTestDatabase()
+        let documents = { (type: BaseModel.Type) -> [[String: Any]] in
+            let query = db.database.createAllDocumentsQuery()
+            query.startKey = "\(type.documentIDPrefix)_"
+            query.endKey = "\(type.documentIDPrefix)_\u{FFFF}"
+            query.prefetch = true
+            let rows = (try? query.run().compactMap { $0 as? CBLQueryRow }) ?? []
+            return rows.compactMap { $0.documentProperties }
+        }
+        /// Drop the ids generated for objects stored without id, they differ from one decoding to another.
+        func generated(_ json: Any, _ source: Any?) -> Any {
+            if var dict = json as? [String: Any] {
+                let stored = source as? [String: Any]
+                if stored?["id"] == nil {
+                    dict["id"] = nil
+                }
+                for (key, value) in dict {
+                    dict[key] = generated(value, stored?[key])
+                }
+                return dict
+            }
+            if let list = json as? [Any] {
+                let stored = source as? [Any]
+                return list.enumerated().map { index, value in
+                    generated(value, stored.flatMap { index < $0.count ? $0[index] : nil })
+                }
+            }
+            return json
+        }
+        let same = { (lhs: BaseModel, rhs: BaseModel, source: [String: Any]) -> Bool in
+            let left = generated(lhs.toJSON(), source) as? [String: Any] ?? [:]
+            let right = generated(rhs.toJSON(), source) as? [String: Any] ?? [:]
+            return NSDictionary(dictionary: left).isEqual(to: right)
+        }
+
+        describe("typed models") {
+            it("should decode as ObjectMapper does") {
+                let types: [BaseModel.Type] = [Order.self, Transaction.self, Item.self, Modifier.self]
+                for type in types {
+                    let stored = documents(type)
+                    expect(stored).toNot(beEmpty())
+                    for properties in stored {
+                        expect(same(type.decoded(properties), type.init(JSON: properties)!, properties)) == true
+                    }
+                }
+            }
+
+            it("should deep copy") {
+                guard let properties = documents(Order.self).first(where: { (($0["bills"] as? [Any]) ?? []).isNotEmpty }) else {
+                    fail("No order with bills")
+                    return
+                }
+                let order = Order.decoded(properties)
+                let copy = order.duplicate()
+                expect(same(copy, order, properties)) == true
+                expect(copy.bills.first === order.bills.first) == false
+                copy.bills.first?.items.first?.count += 1
+                copy.tax.percent += 1
+                expect(order.bills.first?.items.first?.count) == Order.decoded(properties).bills.first?.items.first?.count
+                expect(order.tax.percent) == Order.decoded(properties).tax.percent
+            }
+
+            it("should measure decoding and allocations against ObjectMapper") {
+                let stored = documents(Order.self) + documents(Transaction.self)
+                let rounds = max(1, 2000 / max(stored.count, 1))
+                /// Decode all the stored documents `rounds` times, returning the time and the live blocks.
+                let measure = { (decode: ([String: Any]) -> BaseModel) -> (TimeInterval, Int) in
+                    var models: [BaseModel] = []
+                    var before = malloc_statistics_t()
+                    malloc_zone_statistics(nil, &before)
+                    let start = Date()
+                    for _ in 0..<rounds {
+                        models += stored.map(decode)
+                    }
+                    let elapsed = Date().timeIntervalSince(start)
+                    var after = malloc_statistics_t()
+                    malloc_zone_statistics(nil, &after)
+                    expect(models.count) == rounds * stored.count
+                    return (elapsed, Int(after.blocks_in_use) - Int(before.blocks_in_use))
+                }
+                let mapper = measure { properties in
+                    (properties["type"] as? String) == Order.documentType ? Order(JSON: properties)! as BaseModel : Transaction(JSON: properties)!
+                }
+                let typed = measure { properties in
+                    (properties["type"] as? String) == Order.documentType ? Order.decoded(properties) as BaseModel : Transaction.decoded(properties)
+                }
+                let count = rounds * stored.count
+                // Reported only, timing and malloc counts depend on the machine and the run
+                print("[TypedModel] \(count) documents: ObjectMapper \(Int(mapper.0 * 1000))ms \(mapper.1) blocks, typed \(Int(typed.0 * 1000))ms \(typed.1) blocks")
+            }
+        }
+    }
+}
@@ -0,0 +1,43 @@
+//
+//  ViewWarmupTests.swift
+//  KiolynTests
+//
+//  Created by Chinh Nguyen on 9/4/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+import Quick
+import Nimble
+import RxSwift
+@testable import Kiolyn
+
+class ViewWarmupTests: BaseTests {
+    override func spec() {
+        let db = newCouchbaseTestDatabase()
+
+        describe("view warm-up") {
+            it("should index all views, login views first") {
+                _ = try? db.save(properties: ["id": "warmup000001", "type": Customer.documentType, "merchantid": "warmup-store", "name": "Warmup"])
+                var progress: [Double] = []
+                var completed = false
+                _ = db.warmUpViews().subscribe(
+                    onNext: { progress.append($0) },
+                    onCompleted: { completed = true })
+                expect(completed).toEventually(beTrue(), timeout: 60)
+                expect(progress.first) == 0
+                expect(progress.last) == 1
+                expect(progress) == progress.sorted()
+                expect(db.stationByMacView.isStale) == false
+                expect(db.employeeByPasskeyView.isStale) == false
+                expect(db.itemByCategoryView.isStale) == false
+                expect(db.orderByOrderStatusView.isStale) == false
+                expect(db.transactionByAreaShiftView.isStale) == false
+                // Report aggregates caught up too
+                let checkpoint = db.database.existingLocalDocument(withID: "report_aggregates")
+                expect((checkpoint?["sequence"] as? NSNumber)?.uint64Value) == db.database.lastSequenceNumber
+            }
+        }
+    }
+}
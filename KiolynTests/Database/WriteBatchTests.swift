@@ -0,0 +1,85 @@
+//
+//  WriteBatchTests.swift
+//  KiolynTests
+//
+//  Created by Chinh Nguyen on 9/3/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+import Quick
+import Nimble
+import RxSwift
+@testable import Kiolyn
+
+class WriteBatchTests: BaseTests {
+    override func spec() {
+        let db = newCouchbaseTestDatabase()
+        let storeID = "batch-store"
+        let order = { (i: Int) -> Order in
+            let order = Order(id: "180901\(String(format: "%08d", i))")
+            order.type = Order.documentType
+            order.storeID = storeID
+            order.merchantID = storeID
+            order.channels = [storeID]
+            order.orderNo = UInt(i)
+            return order
+        }
+        let disposeBag = DisposeBag()
+        var notifications: [[String]] = []
+        NotificationCenter.default.rx
+            .notification(.cblDatabaseChange, object: db.database)
+            .subscribe(onNext: { notification in
+                let changes = (notification.userInfo?["changes"] as? [CBLDatabaseChange]) ?? []
+                notifications.append(changes.map { $0.documentID })
+            })
+            .disposed(by: disposeBag)
+
+        describe("write batch") {
+            it("should commit all writes at once") {
+                let orders = (0..<3).map(order)
+                let batch = WriteBatch()
+                batch.save(all: orders)
+                notifications = []
+                let results = try? db.commit(batch)
+                expect(results?.map { $0.docID }) == orders.map { "ord_\($0.id)" }
+                expect(results?.filter { $0.revision.hasPrefix("1-") }.count) == 3
+                expect(notifications.count).toEventually(equal(1))
+                expect(Set(notifications.first ?? [])) == Set(orders.map { "ord_\($0.id)" })
+                expect(batch.ids(of: Order.self)) == orders.map { $0.id }
+            }
+
+            it("should write nothing when an operation fails") {
+                guard let first: Order = db.load(order(0).id), let second: Order = db.load(order(1).id) else {
+                    fail("Orders not saved")
+                    return
+                }
+                first.orderNo = 100
+                let batch = WriteBatch()
+                batch.save(first)
+                batch.delete(second)
+                batch.save(properties: ["type": Order.documentType])
+                expect { try db.commit(batch) }.to(throwError())
+                let reloaded: Order? = db.load(first.id)
+                expect(reloaded?.orderNo) == 0
+                let kept: Order? = db.load(second.id)
+                expect(kept).toNot(beNil())
+            }
+
+            it("should report the revisions of deletions") {
+                guard let third: Order = db.load(order(2).id) else {
+                    fail("Order not saved")
+                    return
+                }
+                let batch = WriteBatch()
+                batch.delete(third)
+                let results = try? db.commit(batch)
+                expect(results?.first?.docID) == third.documentID
+                expect(results?.first?.revision.hasPrefix("2-")) == true
+                let deleted: Order? = db.load(third.id)
+                expect(deleted).to(beNil())
+            }
+        }
+    }
+}
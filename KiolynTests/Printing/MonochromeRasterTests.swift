@@ -0,0 +1,121 @@
+//
+//  MonochromeRasterTests.swift
+//  KiolynTests
+//
+//  Created by Chinh Nguyen on 8/24/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+import UIKit
+
+import Quick
+import Nimble
+@testable import Kiolyn
+
+class MonochromeRasterTests: BaseTests {
+    override func spec() {
+        describe("packing") {
+            it("should pack threshold MSB first with partial last byte") {
+                let raster = MonochromeRaster()
+                raster.load(gray: [0, 255, 0, 255, 0, 255, 0, 255, 0, 0], width: 10)
+                raster.pack(.threshold(128))
+                expect(raster.bytesPerRow) == 2
+                expect(Array(raster.packed[0..<2])) == [0xAA, 0xC0]
+            }
+            it("should dither mid gray to about half black") {
+                let raster = MonochromeRaster()
+                raster.load(gray: [UInt8](repeating: 127, count: 64 * 64), width: 64)
+                raster.pack(.floydSteinberg)
+                let black = raster.packed[0..<(raster.bytesPerRow * raster.height)].reduce(0) { $0 + $1.nonzeroBitCount }
+                expect(black).to(beCloseTo(64 * 64 / 2, within: 64))
+            }
+            it("should keep white white and black black when dithering") {
+                let raster = MonochromeRaster()
+                raster.load(gray: [UInt8](repeating: 255, count: 16) + [UInt8](repeating: 0, count: 16), width: 16)
+                raster.pack(.floydSteinberg)
+                expect(Array(raster.packed[0..<4])) == [0x00, 0x00, 0xFF, 0xFF]
+            }
+        }
+
+        describe("rendering") {
+            let ticket = NSMutableAttributedString(string: "")
+            ticket.appendCenterX2("Nam Hoa Restaurant\n")
+            for i in 0..<60 {
+                ticket.append("\(i.description.padLeft(3)) x Pho Tai Nam Gau Gan Sach      \(Double(i).asPrintingMoney)\n")
+            }
+            ticket.appendBoldX2("Total               $123.45\n")
+            let width = PrintPaperSize.fourInches.rawValue
+
+            it("should render an 832 dots ticket as a 1bpp image") {
+                let image = MonochromeRaster.image(of: ticket, width: width)
+                expect(image?.cgImage?.width) == width
+                expect(image?.cgImage?.bitsPerPixel) == 1
+                expect(image?.cgImage?.height ?? 0) > 0
+            }
+
+            it("should print some ink but mostly white paper") {
+                let (black, dots) = MonochromeRaster.with { raster -> (Int, Int) in
+                    raster.render(ticket, width: width)
+                    raster.pack()
+                    let rows = raster.packed[0..<(raster.bytesPerRow * raster.height)]
+                    return (rows.reduce(0) { $0 + $1.nonzeroBitCount }, raster.width * raster.height)
+                }
+                expect(black) > 0
+                expect(black) < dots / 4
+            }
+
+            it("should render the same ticket the same way with reused buffers") {
+                let first = MonochromeRaster.with { raster -> [UInt8] in
+                    raster.render(ticket, width: width)
+                    raster.pack()
+                    return Array(raster.packed[0..<(raster.bytesPerRow * raster.height)])
+                }
+                let second = MonochromeRaster.with { raster -> [UInt8] in
+                    // Dirty the buffers with another content first
+                    raster.render(NSAttributedString(string: "Another ticket\n"), width: PrintPaperSize.twoInches.rawValue)
+                    raster.pack(.floydSteinberg)
+                    raster.render(ticket, width: width)
+                    raster.pack()
+                    return Array(raster.packed[0..<(raster.bytesPerRow * raster.height)])
+                }
+                expect(second) == first
+            }
+        }
+
+        describe("benchmark") {
+            let ticket = NSMutableAttributedString(string: "")
+            ticket.appendCenterX2("Nam Hoa Restaurant\n")
+            for i in 0..<60 {
+                ticket.append("\(i.description.padLeft(3)) x Pho Tai Nam Gau Gan Sach      \(Double(i).asPrintingMoney)\n")
+            }
+            ticket.appendBoldX2("Total               $123.45\n")
+            let width = PrintPaperSize.threeInches.rawValue
+            let tickets = 20
+
+            /// Build `tickets` bitmap commands from the given image, returning the time per ticket and the bytes.
+            let run = { (image: () -> UIImage?) -> (TimeInterval, Int) in
+                let start = Date()
+                var bytes = 0
+                for _ in 0..<tickets {
+                    let builder: ISCBBuilder = StarIoExt.createCommandBuilder(.starGraphic)
+                    builder.beginDocument()
+                    if let image = image() {
+                        builder.appendBitmap(image, diffusion: false)
+                    }
+                    builder.endDocument()
+                    bytes += builder.commands.length
+                }
+                return (Date().timeIntervalSince(start) / Double(tickets), bytes / tickets)
+            }
+
+            it("should measure RGBA against 1bpp rasterizing") {
+                let (rgba, rgbaBytes) = run { ticket.rasterize(width: CGFloat(width)) }
+                let (mono, monoBytes) = run { MonochromeRaster.image(of: ticket, width: width) }
+                print("[RasterBenchmark] RGBA \(Int(rgba * 1000))ms \(rgbaBytes) bytes, 1bpp \(Int(mono * 1000))ms \(monoBytes) bytes per ticket")
+                expect(rgbaBytes) > 0
+                expect(monoBytes) > 0
+            }
+        }
+    }
+}
@@ -0,0 +1,87 @@
+//
+//  PrintSpoolTests.swift
+//  KiolynTests
+//
+//  Created by Chinh Nguyen on 8/27/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+import Quick
+import Nimble
+@testable import Kiolyn
+
+class PrintSpoolTests: BaseTests {
+    override func spec() {
+        var path = ""
+        let job = { (id: String) -> SpooledPrintJob in
+            SpooledPrintJob(id: id, key: "printer", portName: "TCP:192.168.1.100", portSettings: "", data: Data(repeating: 0x1B, count: 1000), createdAt: Date(), state: .queued)
+        }
+        beforeEach {
+            path = "\(NSTemporaryDirectory())/\(UUID().uuidString).spool"
+        }
+        afterEach {
+            try? FileManager.default.removeItem(atPath: path)
+        }
+
+        describe("replay") {
+            it("should keep unacked jobs after reopening") {
+                let spool = PrintSpool(path: path)
+                spool.enqueue(job("1"))
+                spool.enqueue(job("2"))
+                spool.mark("1", .sent)
+                spool.mark("1", .acked)
+                spool.mark("2", .sent)
+                spool.flush()
+
+                let reopened = PrintSpool(path: path)
+                expect(reopened.pending.map { $0.id }) == ["2"]
+                expect(reopened.pending.first?.state) == .sent
+                expect(reopened.pending.first?.data.count) == 1000
+            }
+            it("should deduplicate jobs by id") {
+                let spool = PrintSpool(path: path)
+                spool.enqueue(job("1"))
+                spool.enqueue(job("1"))
+                spool.flush()
+                expect(PrintSpool(path: path).pending.count) == 1
+            }
+            it("should ignore unflushed and truncated records") {
+                let spool = PrintSpool(path: path)
+                spool.enqueue(job("1"))
+                spool.flush()
+                spool.enqueue(job("2"))
+                // Half written record
+                let handle = FileHandle(forWritingAtPath: path)
+                handle?.seekToEndOfFile()
+                handle?.write(Data([0xFF, 0x00, 0x00, 0x00, 0x01]))
+                handle?.closeFile()
+                expect(PrintSpool(path: path).pending.map { $0.id }) == ["1"]
+            }
+            it("should drop expired jobs") {
+                let spool = PrintSpool(path: path)
+                spool.enqueue(SpooledPrintJob(id: "1", key: "printer", portName: "", portSettings: "", data: Data(), createdAt: Date(timeIntervalSinceNow: -3600), state: .queued))
+                spool.flush()
+                expect(spool.pending).to(beEmpty())
+            }
+        }
+
+        describe("compaction") {
+            it("should only keep live jobs") {
+                let spool = PrintSpool(path: path)
+                spool.compactThreshold = 10
+                for i in 0..<20 {
+                    spool.enqueue(job("\(i)"))
+                    spool.mark("\(i)", .acked)
+                    spool.flush()
+                }
+                spool.enqueue(job("live"))
+                spool.flush()
+                let size = (try? FileManager.default.attributesOfItem(atPath: path))?[.size] as? Int ?? 0
+                expect(size) < 5 * 1100
+                expect(PrintSpool(path: path).pending.map { $0.id }) == ["live"]
+            }
+        }
+    }
+}
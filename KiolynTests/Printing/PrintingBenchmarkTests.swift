@@ -0,0 +1,166 @@
+//
+//  PrintingBenchmarkTests.swift
+//  KiolynTests
+//
+//  Created by Chinh Nguyen on 8/27/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+import Quick
+import Nimble
+@testable import Kiolyn
+
+class PrintingBenchmarkTests: BaseTests {
+    override func spec() {
+        let service = StarIOPrintingService()
+        let emulation = Printer().emulation
+        let portName = "TCP:127.0.0.1"
+        var printer: SimulatedStarPrinter!
+
+        // Documents
+        let store = Store()
+        store.name = "Nam Hoa Restaurant"
+        let server = Employee()
+        server.name = "Benchmark"
+        let order = Order()
+        order.orderNo = 42
+        order.tableName = "Table 5"
+        order.persons = 4
+        let items = (0..<12).map { i -> OrderItem in
+            let item = OrderItem()
+            item.name = "Pho Tai Nam Gau Gan Sach \(i)"
+            item.count = 1
+            item.price = 9.95
+            return item
+        }
+        let bill = Bill(order: order)
+        bill.items = items
+        order.bills = [bill]
+        let transaction = Transaction()
+        transaction.approvedAmount = 123.45
+        let rows = (0..<30).map { i in NameValueReportRow(name: "Row \(i)", value: Double(i).asMoney) }
+        let kitchenSettings = KitchenPrintingSettings()
+        kitchenSettings.printGrouping = false
+
+        let templates: [(String, () throws -> NSAttributedString)] = [
+            ("check", {
+                let settings = CheckReceiptPrintingSettings()
+                let data = NSMutableAttributedString(attributedString: service.build(checkHeaderTemplate: store, settings: settings))
+                data.append(try service.build(checkBodyTemplate: bill, ofOrder: order, byServer: server, settings: settings, using: SP.dataService))
+                return data
+            }),
+            ("receipt", {
+                let settings = CCReceiptPrintingSettings()
+                let data = NSMutableAttributedString(attributedString: service.build(receiptHeaderTemplate: store, settings: settings))
+                data.append(try service.build(receiptBodyTemplate: transaction, for: .customer, store: store, order: order, server: server, settings: settings))
+                return data
+            }),
+            ("items", {
+                try service.build(itemsTemplate: items, ofOrder: order, byServer: server, withType: .send, settings: kitchenSettings, using: SP.dataService)
+            }),
+            ("report", {
+                try service.build(shiftAndDayReportTemplate: rows, byEmployee: server, fromDate: Date(), toDate: Date(), shift: 1)
+            })
+        ]
+
+        /// Build and send `tickets` tickets concurrently, returning the end-to-end latencies and the bytes sent.
+        let run = { (tickets: Int, generate: () throws -> NSAttributedString) -> ([TimeInterval], Int) in
+            let scheduler = StarPrintScheduler()
+            let lock = NSLock()
+            var latencies: [TimeInterval] = []
+            var bytes = 0
+            DispatchQueue.concurrentPerform(iterations: tickets) { _ in
+                let start = Date()
+                let builder: ISCBBuilder = StarIoExt.createCommandBuilder(emulation)
+                builder.beginDocument()
+                if let content = try? generate() {
+                    builder.append(content: content, emulation: emulation)
+                }
+                builder.appendPaperCut()
+                builder.endDocument()
+                let data = builder.commands.copy() as! NSData
+                let sent = scheduler.send(data: data, key: "simulated", portName: portName, portSettings: "")
+                lock.lock()
+                if sent {
+                    latencies.append(Date().timeIntervalSince(start))
+                }
+                bytes += data.length
+                lock.unlock()
+            }
+            return (latencies.sorted(), bytes)
+        }
+
+        describe("printer emulation") {
+            let printer = { (model: String) -> Printer in
+                let printer = Printer()
+                printer.printerModel = .star(model: model)
+                return printer
+            }
+
+            it("should print raster only models as bitmap") {
+                expect(printer("TSP100").emulation) == StarIoExtEmulation.starGraphic
+                expect(printer("TSP100").emulation.supportsText) == false
+            }
+
+            it("should print line mode models as text") {
+                expect(printer("TSP650II").emulation) == StarIoExtEmulation.starLine
+                expect(printer("TSP654II (STR_T-001)").emulation) == StarIoExtEmulation.starLine
+                expect(printer("mPOP").emulation) == StarIoExtEmulation.starPRNT
+                expect(printer("TSP650II").emulation.supportsText) == true
+            }
+
+            it("should fall back to bitmap for unknown models") {
+                expect(printer("Unknown").emulation) == StarIoExtEmulation.starGraphic
+            }
+        }
+
+        describe("benchmark") {
+            beforeEach {
+                printer = SimulatedStarPrinter()
+                // About 80Mbps (10MB/s) LAN with a slow printer status
+                printer.bandwidth = 10_000_000
+                printer.latency = 0.02
+                expect(printer.start()) == true
+            }
+            afterEach {
+                StarPortPool.shared.drain()
+                printer.stop()
+            }
+
+            for (name, generate) in templates {
+                it("should measure \(name) throughput") {
+                    let tickets = 40
+                    let start = Date()
+                    let (latencies, bytes) = run(tickets, generate)
+                    let elapsed = Date().timeIntervalSince(start)
+                    expect(latencies.count) == tickets
+                    guard latencies.isNotEmpty else { return }
+                    let p50 = latencies[latencies.count / 2]
+                    let p99 = latencies[min(latencies.count - 1, latencies.count * 99 / 100)]
+                    print("[PrintingBenchmark] \(name): \(String(format: "%.1f", Double(tickets) / elapsed)) tickets/s, p50 \(Int(p50 * 1000))ms, p99 \(Int(p99 * 1000))ms, \(bytes / tickets) bytes/ticket")
+                    expect(printer.received) >= bytes
+                }
+            }
+
+            it("should fail fast on offline printer") {
+                printer.state = .offline
+                let data = NSData(data: Data(repeating: 0x20, count: 100))
+                let start = Date()
+                expect { try StarCommunication.sendInCheckedBlock(commands: data, portName: portName, portSettings: "", timeout: 3000) }.to(throwError())
+                // From the printer status, not after the port or write timeouts
+                expect(Date().timeIntervalSince(start)) < 3
+            }
+
+            it("should fail fast on paper out printer") {
+                printer.state = .paperEmpty
+                let data = NSData(data: Data(repeating: 0x20, count: 100))
+                let start = Date()
+                expect { try StarCommunication.sendInCheckedBlock(commands: data, portName: portName, portSettings: "", timeout: 3000) }.to(throwError())
+                // From the printer status, not after the port or write timeouts
+                expect(Date().timeIntervalSince(start)) < 3
+            }
+        }
+    }
+}
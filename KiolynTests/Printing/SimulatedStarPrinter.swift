@@ -0,0 +1,146 @@
+//
+//  SimulatedStarPrinter.swift
+//  KiolynTests
+//
+//  Created by Chinh Nguyen on 8/27/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+/// A local stand-in for an ethernet Star printer. It accepts printing data on port 9100 and
+/// answers status requests (on the data port and on the 9101 status port) with the automatic
+/// status back of the simulated state. Latency and bandwidth can be set to mimic a real printer.
+class SimulatedStarPrinter {
+
+    /// Printer state reported in status.
+    enum State {
+        case online
+        case offline
+        case paperEmpty
+        case coverOpen
+    }
+
+    /// Delay before answering a status request.
+    var latency: TimeInterval = 0
+    /// Bytes per second the printer accepts, 0 for unlimited.
+    var bandwidth = 0
+    /// The state reported in status.
+    var state = State.online
+
+    /// Total printing bytes received.
+    var received: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return _received
+    }
+
+    fileprivate let ports: [UInt16]
+    fileprivate let lock = NSLock()
+    fileprivate var _received = 0
+    fileprivate var listeners: [Int32] = []
+
+    /// Create a printer.
+    ///
+    /// - Parameter ports: The data port then the status port.
+    init(ports: [UInt16] = [9100, 9101]) {
+        self.ports = ports
+    }
+
+    deinit {
+        stop()
+    }
+
+    /// The automatic status back (9 bytes) of the current state.
+    var status: [UInt8] {
+        var asb: [UInt8] = [0x23, 0x86, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00]
+        switch state {
+        case .online: break
+        case .offline: asb[2] |= 0x08
+        case .coverOpen: asb[2] |= 0x08 | 0x20
+        case .paperEmpty:
+            asb[2] |= 0x08
+            asb[4] |= 0x08
+        }
+        return asb
+    }
+
+    /// Start listening on localhost.
+    ///
+    /// - Returns: `false` if a port could not be bound.
+    @discardableResult
+    func start() -> Bool {
+        for (index, port) in ports.enumerated() {
+            let fd = socket(AF_INET, SOCK_STREAM, 0)
+            guard fd >= 0 else { return false }
+            var yes: Int32 = 1
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, socklen_t(MemoryLayout<Int32>.size))
+            var addr = sockaddr_in()
+            addr.sin_len = UInt8(MemoryLayout<sockaddr_in>.size)
+            addr.sin_family = sa_family_t(AF_INET)
+            addr.sin_port = port.bigEndian
+            addr.sin_addr.s_addr = inet_addr("127.0.0.1")
+            let bound = withUnsafePointer(to: &addr) { pointer in
+                pointer.withMemoryRebound(to: sockaddr.self, capacity: 1) { bind(fd, $0, socklen_t(MemoryLayout<sockaddr_in>.size)) }
+            }
+            guard bound == 0, listen(fd, 8) == 0 else {
+                close(fd)
+                return false
+            }
+            listeners.append(fd)
+            let isStatusPort = index > 0
+            Thread.detachNewThread { self.accept(on: fd, isStatusPort: isStatusPort) }
+        }
+        return true
+    }
+
+    /// Stop listening.
+    func stop() {
+        for fd in listeners {
+            shutdown(fd, SHUT_RDWR)
+            close(fd)
+        }
+        listeners = []
+    }
+
+    fileprivate func accept(on listener: Int32, isStatusPort: Bool) {
+        while true {
+            let fd = Darwin.accept(listener, nil, nil)
+            guard fd >= 0 else { return }
+            Thread.detachNewThread { self.serve(fd, isStatusPort: isStatusPort) }
+        }
+    }
+
+    fileprivate func serve(_ fd: Int32, isStatusPort: Bool) {
+        defer { close(fd) }
+        var buffer = [UInt8](repeating: 0, count: 4096)
+        // Status request: ESC ACK SOH
+        let request: [UInt8] = [0x1B, 0x06, 0x01]
+        var tail: [UInt8] = []
+        while true {
+            let count = read(fd, &buffer, buffer.count)
+            guard count > 0 else { return }
+            let chunk = Array(buffer[0..<count])
+            let scan = tail + chunk
+            let asked = isStatusPort || (0...max(0, scan.count - request.count)).contains { i in
+                i + request.count <= scan.count && Array(scan[i..<(i + request.count)]) == request
+            }
+            tail = Array(scan.suffix(request.count - 1))
+            if !isStatusPort {
+                lock.lock()
+                _received += count
+                lock.unlock()
+                if bandwidth > 0 {
+                    Thread.sleep(forTimeInterval: Double(count) / Double(bandwidth))
+                }
+            }
+            if asked {
+                if latency > 0 {
+                    Thread.sleep(forTimeInterval: latency)
+                }
+                let asb = status
+                _ = asb.withUnsafeBufferPointer { write(fd, $0.baseAddress, asb.count) }
+            }
+        }
+    }
+}
@@ -0,0 +1,225 @@
+//
+//  EventBroadcasterTests.swift
+//  KiolynTests
+//
+//  Created by Chinh Nguyen on 9/10/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+import Quick
+import Nimble
+@testable import Kiolyn
+
+/// A Sub session keeping the written frames, which can be held in the middle of a write.
+fileprivate class FakeSession: EventSession {
+    let name: String
+    fileprivate let lock = NSLock()
+    fileprivate var frames: [String] = []
+    fileprivate var started = 0
+    fileprivate var closed = false
+    /// Writes wait for the gate when holding.
+    let holding: Bool
+    let gate = DispatchSemaphore(value: 0)
+
+    init(_ name: String, holding: Bool = false) {
+        self.name = name
+        self.holding = holding
+    }
+
+    func writeText(_ text: String) {
+        lock.lock()
+        started += 1
+        lock.unlock()
+        if holding {
+            gate.wait()
+        }
+        lock.lock()
+        frames.append(text)
+        lock.unlock()
+    }
+
+    func close() {
+        lock.lock()
+        closed = true
+        lock.unlock()
+    }
+
+    /// The written events, as (type, content, sequence).
+    var events: [(String, Any?, UInt64?)] {
+        lock.lock()
+        defer { lock.unlock() }
+        return frames.compactMap { frame in
+            guard let data = frame.data(using: .utf8),
+                let event = (try? JSONSerialization.jsonObject(with: data)) as? [String: Any],
+                let type = event["type"] as? String else {
+                return nil
+            }
+            return (type, event["content"], (event["seq"] as? NSNumber)?.uint64Value)
+        }
+    }
+
+    var types: [String] {
+        return events.map { $0.0 }
+    }
+
+    var writesStarted: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return started
+    }
+
+    var isClosed: Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        return closed
+    }
+
+    /// Let all the writes through.
+    func release() {
+        for _ in 0..<64 {
+            gate.signal()
+        }
+    }
+}
+
+/// A clock moved by the tests.
+fileprivate class FakeClock {
+    fileprivate let lock = NSLock()
+    fileprivate var current = Date()
+
+    var now: Date {
+        lock.lock()
+        defer { lock.unlock() }
+        return current
+    }
+
+    func advance(_ interval: TimeInterval) {
+        lock.lock()
+        current = current.addingTimeInterval(interval)
+        lock.unlock()
+    }
+}
+
+class EventBroadcasterTests: BaseTests {
+    override func spec() {
+        describe("coalescing") {
+            it("should send the changes raised within the window as one event") {
+                let events = EventBroadcaster { ["x": "station-1"] }
+                let session = FakeSession("sub")
+                events.add(session, acceptsDelta: true)
+                events.send(orderChanged: ["a"], sequence: 1)
+                events.send(orderChanged: ["b", "a"], sequence: 2)
+                events.send(lockDelta: OrderLockDelta(locked: ["a": "station-2"], unlocked: []))
+                events.send(lockDelta: OrderLockDelta(locked: ["b": "station-2"], unlocked: ["x"]))
+                expect(session.types).toEventually(equal(["LockedOrdersChanged", "LockedOrdersDelta", "OrderChanged"]))
+                let delta = session.events[1].1 as? [String: Any]
+                expect(delta?["locked"] as? [String: String]) == ["a": "station-2", "b": "station-2"]
+                expect(delta?["unlocked"] as? [String]) == ["x"]
+                expect(session.events[2].1 as? String) == "a,b"
+                expect(session.events[2].2) == 2
+                // Nothing left for a next window
+                Thread.sleep(forTimeInterval: 0.1)
+                expect(session.events.count) == 3
+            }
+
+            it("should send all the locked orders only to the Subs not applying the delta") {
+                let events = EventBroadcaster { ["a": "station-2"] }
+                let delta = FakeSession("delta")
+                let full = FakeSession("full")
+                events.add(delta, acceptsDelta: true)
+                events.add(full)
+                events.send(lockDelta: OrderLockDelta(locked: ["a": "station-2"], unlocked: []))
+                expect(delta.types).toEventually(equal(["LockedOrdersChanged", "LockedOrdersDelta"]))
+                expect(full.types).toEventually(equal(["LockedOrdersChanged", "LockedOrdersChanged"]))
+                expect(full.events[1].1 as? [String: String]) == ["a": "station-2"]
+            }
+
+            it("should send the coalesced changes before an event sent right away") {
+                let events = EventBroadcaster { [:] }
+                let session = FakeSession("sub")
+                events.add(session, acceptsDelta: true)
+                events.send(orderChanged: ["a"], sequence: 1)
+                events.send(.menuChanged, content: nil)
+                expect(session.types).toEventually(equal(["LockedOrdersChanged", "OrderChanged", "MenuChanged"]))
+            }
+        }
+
+        describe("slow sessions") {
+            it("should replace more than the queued limit by one resync") {
+                let events = EventBroadcaster { [:] }
+                let session = FakeSession("slow", holding: true)
+                events.add(session, acceptsDelta: true)
+                // Held writing the locked orders, the rest is queued
+                expect(session.writesStarted).toEventually(equal(1))
+                for _ in 0...EventBroadcaster.maxQueued {
+                    events.send(.menuChanged, content: nil)
+                }
+                expect(events.metrics.first?.queued) == 1
+                expect(events.metrics.first?.resyncs) == 1
+                session.release()
+                expect(session.types).toEventually(equal(["LockedOrdersChanged", "Resync"]))
+            }
+
+            it("should not slow down the other sessions") {
+                let events = EventBroadcaster { [:] }
+                let slow = FakeSession("slow", holding: true)
+                let fast = FakeSession("fast")
+                events.add(slow, acceptsDelta: true)
+                events.add(fast, acceptsDelta: true)
+                events.send(.menuChanged, content: nil)
+                expect(fast.types).toEventually(equal(["LockedOrdersChanged", "MenuChanged"]))
+                expect(slow.events).to(beEmpty())
+                slow.release()
+            }
+
+            it("should drop a session stuck in a write for too long") {
+                let clock = FakeClock()
+                let events = EventBroadcaster(now: { clock.now }) { [:] }
+                let session = FakeSession("stuck", holding: true)
+                events.add(session, acceptsDelta: true)
+                expect(session.writesStarted).toEventually(equal(1))
+                events.send(.menuChanged, content: nil)
+                // The queued event waited long, but its write just started
+                clock.advance(EventBroadcaster.maxLag - 1)
+                session.gate.signal()
+                expect(session.writesStarted).toEventually(equal(2))
+                clock.advance(3)
+                events.send(.menuChanged, content: nil)
+                expect(session.isClosed) == false
+                // Stuck in the same write
+                clock.advance(EventBroadcaster.maxLag)
+                events.send(.menuChanged, content: nil)
+                expect(session.isClosed) == true
+                session.release()
+            }
+        }
+
+        describe("metrics") {
+            it("should report the sent events and the lag of each session") {
+                let clock = FakeClock()
+                let events = EventBroadcaster(now: { clock.now }) { [:] }
+                let session = FakeSession("sub", holding: true)
+                events.add(session, acceptsDelta: true)
+                expect(session.writesStarted).toEventually(equal(1))
+                events.send(.menuChanged, content: nil)
+                clock.advance(2)
+                // The event being written counts as lagging
+                let lagging = events.metrics.first
+                expect(lagging?.session) == "sub"
+                expect(lagging?.queued) == 1
+                expect(lagging?.sent) == 0
+                expect(lagging?.lag).to(beCloseTo(2, within: 0.01))
+                session.release()
+                expect(events.metrics.first?.sent).toEventually(equal(2))
+                let written = events.metrics.first
+                expect(written?.queued) == 0
+                expect(written?.resyncs) == 0
+                expect(written?.maxLag).to(beCloseTo(2, within: 0.01))
+                events.remove(session)
+                expect(events.metrics).to(beEmpty())
+            }
+        }
+    }
+}
@@ -0,0 +1,114 @@
+//
+//  WireFormatTests.swift
+//  KiolynTests
+//
+//  Created by Chinh Nguyen on 9/7/18.
+//  Copyright © 2018 Willbe Technology. All rights reserved.
+//
+
+import Foundation
+
+import Quick
+import Nimble
+@testable import Kiolyn
+
+class WireFormatTests: BaseTests {
+    override func spec() {
+        let order = { (i: Int) -> [String: Any] in
+            let order = Order(id: "180907\(String(format: "%08d", i))")
+            order.type = Order.documentType
+            order.storeID = testStoreID
+            order.merchantID = testStoreID
+            order.shiftID = "wire-shift"
+            order.area = "wire-area"
+            order.orderStatus = .submitted
+            order.orderNo = UInt(i)
+            order.customerName = "Customer \(i) – Nguyễn"
+            order.items = (0..<5).map { j in
+                let item = OrderItem(id: "\(order.id)-\(j)")
+                item.name = "Item \(j)"
+                item.itemID = "item-\(j)"
+                item.categoryID = "category-\(j % 2)"
+                item.price = Double(j) * 1.25
+                item.count = Double(j + 1)
+                return item
+            }
+            return order.toJSON()
+        }
+        /// The orders as read from JSON, with numbers as `NSNumber`.
+        let orders = (0..<200).map(order).compactMap { properties in
+            (try? JSONSerialization.data(withJSONObject: properties)).flatMap { try? JSONSerialization.jsonObject(with: $0) } as? [String: Any]
+        }
+
+        describe("message pack") {
+            it("should round trip JSON objects") {
+                let object: [String: Any] = ["a": 1, "b": -200, "c": 1.5, "d": true, "e": NSNull(), "f": ["x", 70000, -5_000_000_000], "g": ["h": "ễ", "i": String(repeating: "j", count: 300)]]
+                let decoded = (try? MessagePack.encode(object)).flatMap { try? MessagePack.decode($0) } as? [String: Any]
+                expect(decoded.map { NSDictionary(dictionary: $0).isEqual(to: object) }) == true
+                expect((decoded?["d"] as? NSNumber).map { CFGetTypeID($0) == CFBooleanGetTypeID() }) == true
+            }
+
+            it("should not decode truncated data") {
+                let data = (try? MessagePack.encode(orders[0])) ?? Data()
+                expect { try MessagePack.decode(data.dropLast()) }.to(throwError())
+            }
+        }
+
+        describe("wire format") {
+            it("should fall back to JSON") {
+                expect(WireFormat.negotiate(nil)) == .json
+                expect(WireFormat.negotiate("application/json, */*")) == .json
+                expect(WireFormat.encode(orders, as: .json)).to(beNil())
+                let data = (try? JSONSerialization.data(withJSONObject: orders)) ?? Data()
+                expect((try? WireFormat.decode(data)) as? [[String: Any]]).to(haveCount(orders.count))
+            }
+
+            it("should pick the most compact format accepted") {
+                expect(WireFormat.negotiate(WireFormat.accept)) == .deflatedMsgpack
+                expect(WireFormat.negotiate("application/x-msgpack;q=0.9, application/json")) == .msgpack
+                expect(WireFormat.encode(["a": 1], as: .deflatedMsgpack)?.0) == .msgpack
+                guard case let (format, data)? = WireFormat.encode(orders, as: .deflatedMsgpack) else {
+                    fail("Orders not encoded")
+                    return
+                }
+                expect(format) == .deflatedMsgpack
+                let decoded = try? WireFormat.decode(data)
+                expect(decoded.map { NSArray(array: $0 as? [Any] ?? []).isEqual(to: orders) }) == true
+            }
+
+            it("should make order lists smaller") {
+                let runs = 10
+                var start = Date()
+                var json = Data()
+                for _ in 0..<runs {
+                    json = (try? JSONSerialization.data(withJSONObject: orders)) ?? Data()
+                }
+                let jsonEncoding = Date().timeIntervalSince(start) / Double(runs)
+                start = Date()
+                for _ in 0..<runs {
+                    _ = try? JSONSerialization.jsonObject(with: json)
+                }
+                let jsonDecoding = Date().timeIntervalSince(start) / Double(runs)
+                var sizes: [WireFormat: Int] = [.json: json.count]
+                for format in [WireFormat.msgpack, .deflatedMsgpack] {
+                    start = Date()
+                    var data = Data()
+                    for _ in 0..<runs {
+                        data = WireFormat.encode(orders, as: format)?.1 ?? Data()
+                    }
+                    let encoding = Date().timeIntervalSince(start) / Double(runs)
+                    start = Date()
+                    for _ in 0..<runs {
+                        _ = try? WireFormat.decode(data)
+                    }
+                    let decoding = Date().timeIntervalSince(start) / Double(runs)
+                    sizes[format] = data.count
+                    print("[Wire] \(orders.count) orders \(format): \(data.count) bytes, encode \(Int(encoding * 1000))ms, decode \(Int(decoding * 1000))ms")
+                }
+                print("[Wire] \(orders.count) orders json: \(json.count) bytes, encode \(Int(jsonEncoding * 1000))ms, decode \(Int(jsonDecoding * 1000))ms")
+                expect(sizes[.msgpack]) < json.count
+                expect(sizes[.deflatedMsgpack]) < (sizes[.msgpack] ?? 0)
+            }
+        }
+    }
+}